@@ -0,0 +1,138 @@
+/**
+ * @file      
+ * @brief     Main loop driver with frame pacing.
+ * @details   ...
+ * @author    ArthurTheDigital (arthurthedigital@gmail.com)
+ * @copyright GPL v3.
+ * @since     $Id: $ */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <vector>
+
+
+namespace ATD {
+
+/**
+ * @brief Fixed-timestep updates, variable-rate rendering.
+ * @class ...
+ *
+ * The model is updated with a constant step, as many times per frame, as 
+ * the elapsed time requires. The frame is rendered once per loop 
+ * iteration, either as fast as display() lets it (vsync pacing), or with 
+ * the given render rate. Frame deadlines are waited for by sleeping most of 
+ * the time and spinning the rest, since sleep is too coarse for them. */
+class FrameLoop
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	/**
+	 * @brief Update the model by one step.
+	 * @param step - in seconds
+	 * @return false to stop the loop */
+	typedef std::function<bool(double step)> UpdateFunc;
+
+	/**
+	 * @brief Render the frame.
+	 * @param alpha - part of the update step, elapsed since the last 
+	 * update, for interpolation: [0., 1.) */
+	typedef std::function<void(double alpha)> RenderFunc;
+
+	/**
+	 * @brief Frame timing statistics.
+	 * @class ...
+	 *
+	 * Frame times are taken over the last STATS_FRAMES_NUM frames, counters 
+	 * are taken over the whole run. All the times are in seconds. 
+	 *
+	 * With vsync pacing the deadline is the swap: a frame, longer than 
+	 * MISSED_FRAME_TIME_FRC of the median frame time, is counted as 
+	 * missed. */
+	class Stats
+	{
+	public:
+		size_t framesNum = 0;
+		size_t missedDeadlinesNum = 0;
+		size_t droppedUpdatesNum = 0;
+		double minFrameTime = 0.;
+		double avgFrameTime = 0.;
+		double p99FrameTime = 0.;
+		double maxFrameTime = 0.;
+	};
+
+	/* Number of the latest frames, collected for frame time statistics. */
+	static const size_t STATS_FRAMES_NUM;
+
+	/* With vsync pacing, a frame is missed, when it is that many times 
+	 * longer than the swap period (taken as the median frame time). */
+	static const double MISSED_FRAME_TIME_FRC;
+
+	/* The last part of a wait, spent spinning instead of sleeping. */
+	static const Clock::duration SPIN_DURATION;
+
+
+	/**
+	 * @brief ...
+	 * @param updateRate         - updates per second
+	 * @param renderRate         - frames per second, 0. to let display() 
+	 * pace the frames (see Window::setSwapInterval())
+	 * @param maxUpdatesPerFrame - the updates above are dropped, so that 
+	 * a slow frame does not make the next one even slower */
+	FrameLoop(double updateRate = 60., 
+			double renderRate = 0., 
+			size_t maxUpdatesPerFrame = 5);
+
+	/**
+	 * @brief Run until update returns false or stop() is called.
+	 * @param update - ...
+	 * @param render - ...
+	 *
+	 * Poll the window events in update, so that input is taken as late 
+	 * as possible before the frame. */
+	void run(const UpdateFunc &update, const RenderFunc &render);
+
+	/**
+	 * @brief Stop the loop after the current update or render. */
+	void stop();
+
+	/**
+	 * @brief ...
+	 * @return ... */
+	Stats stats() const;
+
+	/**
+	 * @brief Sleep, then spin until the deadline.
+	 * @param deadline - ... */
+	static void waitUntil(const Clock::time_point &deadline);
+
+private:
+	/**
+	 * @brief ...
+	 * @param frameTime - in seconds */
+	void recordFrameTime(double frameTime);
+
+	/**
+	 * @brief Whether a vsync paced frame has missed its swap.
+	 * @param frameTime - in seconds
+	 * @return false, until enough frame times are recorded */
+	bool isSwapMissed(double frameTime);
+
+
+	double m_updateStep;
+	Clock::duration m_renderPeriod;
+	size_t m_maxUpdatesPerFrame;
+	bool m_isRunning;
+
+	std::vector<double> m_frameTimes; /* Ring buffer. */
+	std::vector<double> m_medianFrameTimes; /* For the median search. */
+	size_t m_framesNum;
+	size_t m_missedDeadlinesNum;
+	size_t m_droppedUpdatesNum;
+};
+
+} /* namespace ATD */
+
+
@@ -0,0 +1,84 @@
+/**
+ * @file      
+ * @brief     Text and binary encodings of JSON-described assets.
+ * @details   ...
+ * @author    ArthurTheDigital (arthurthedigital@gmail.com)
+ * @copyright GPL v3.
+ * @since     $Id: $ */
+
+#pragma once
+
+#include <ATD/Core/Fs.hpp>
+
+#include <string>
+#include <vector>
+
+
+namespace ATD {
+
+/**
+ * @brief Encodings of Loadable data, described with JSON schema.
+ * @class ...
+ *
+ * JSON is the authoring format, CBOR and MessagePack are the compact
+ * binary ones, with the same document structure. Format is detected by the
+ * first bytes of the data or by the file extension. */
+class JsonData
+{
+public:
+	/**
+	 * @brief ... */
+	enum Format {
+		JSON, 
+		CBOR, 
+		MSGPACK, 
+		UNKNOWN
+	};
+
+	static const std::vector<std::string> EXTENSIONS;
+	static const size_t EXT_JSON;
+	static const size_t EXT_CBOR;
+	static const size_t EXT_MSGPACK;
+
+	/* CBOR self-describe tag, written before CBOR data. */
+	static const std::string CBOR_MAGIC;
+
+
+	/**
+	 * @brief ...
+	 * @param filename - ...
+	 * @return UNKNOWN for unknown extension */
+	static Format formatFromPath(const Fs::Path &filename);
+
+	/**
+	 * @brief Detect the format by the first bytes.
+	 * @param data - ...
+	 * @return UNKNOWN if does not look like a JSON object or CBOR or
+	 *         MessagePack map */
+	static Format formatFromData(const std::string &data);
+
+	/**
+	 * @brief Read the whole file.
+	 * @param filename - ...
+	 * @return ...
+	 * @throws ... */
+	static std::string readFile(const Fs::Path &filename);
+
+	/**
+	 * @brief Write the whole file.
+	 * @param filename - ...
+	 * @param data     - ...
+	 * @throws ... */
+	static void writeFile(const Fs::Path &filename, const std::string &data);
+
+	/**
+	 * @brief Convert between the formats.
+	 * @param source      - ...
+	 * @param destination - format is taken from the extension
+	 * @throws ... */
+	static void convert(const Fs::Path &source, const Fs::Path &destination);
+};
+
+} /* namespace ATD */
+
+
@@ -182,6 +182,18 @@ public:
 	 * @param shader3DPtr - ... */
 	void setShader3D(Shader3D::Ptr shader3DPtr);
 
+	/**
+	 * @brief Shader2D, used by draw() (the set one or the default one).
+	 * @return ... */
+	inline Shader2D::Ptr currentShader2D() const
+	{ return m_shader2DPtr ? m_shader2DPtr : m_dftShader2DPtr; }
+
+	/**
+	 * @brief Shader3D, used by draw() (the set one or the default one).
+	 * @return ... */
+	inline Shader3D::Ptr currentShader3D() const
+	{ return m_shader3DPtr ? m_shader3DPtr : m_dftShader3DPtr; }
+
 	/**
 	 * @brief ...
 	 * @param projection2D - ... */
@@ -192,6 +204,12 @@ public:
 	 * @param projection3D - ... */
 	void setProjection3D(const Projection3D &projection3D);
 
+	/**
+	 * @brief ...
+	 * @return ... */
+	inline const Projection3D &projection3D() const
+	{ return m_projection3D; }
+
 	/**
 	 * @brief ... */
 	void clear();
@@ -215,6 +233,30 @@ public:
 	void draw(const VertexBuffer3D &vertices3D, 
 			const Transform3D &transform);
 
+	/**
+	 * @brief Draw vertices2D once per each of the instances.
+	 * @param vertices2D - ...
+	 * @param instances  - ...
+	 * @param transform  - applied on top of each instance transform
+	 *
+	 * Current Shader2D must have instance attributes, see 
+	 * Shader2D::INSTANCED_VERTEX_SOURCE. */
+	void draw(const VertexBuffer2D &vertices2D, 
+			const InstanceBuffer2D &instances, 
+			const Transform2D &transform = Transform2D());
+
+	/**
+	 * @brief Draw vertices3D once per each of the instances.
+	 * @param vertices3D - ...
+	 * @param instances  - ...
+	 * @param transform  - applied on top of each instance transform
+	 *
+	 * Current Shader3D must have instance attributes, see 
+	 * Shader3D::INSTANCED_VERTEX_SOURCE. */
+	void draw(const VertexBuffer3D &vertices3D, 
+			const InstanceBuffer3D &instances, 
+			const Transform3D &transform = Transform3D());
+
 	/**
 	 * @brief ...
 	 * @return ... */
@@ -253,17 +295,6 @@ private:
 	 * @param shader - ... */
 	void updateProjectionOnShader3D(Shader3D &shader) const;
 
-	/**
-	 * @brief Copy contents from texSrc to texDst with align.
-	 * @param texSrc - ...
-	 * @param texDst - ...
-	 * @param alignX - ...
-	 * @param alignY - ... */
-	void drawPlainAligned(const Texture &texSrc, 
-			Texture &texDst, 
-			const Align &alignX, 
-			const Align &alignY);
-
 
 	Vector2S m_size;
 	Gl::Uint m_frameBufferId;
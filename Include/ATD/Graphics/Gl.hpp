@@ -9,6 +9,10 @@
 #pragma once
 
 #include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <utility>
 
 
 namespace ATD {
@@ -40,6 +44,8 @@ public:
 	typedef ptrdiff_t      Sizeiptr;
 	typedef ptrdiff_t      Intptr;
 	typedef char           Char;
+	typedef uint64_t       Uint64;
+	typedef void *         Sync;
 
 	/* Constants: */
 
@@ -865,6 +871,9 @@ public:
 	/* texture_border_clamp */
 	static const Enum CLAMP_TO_BORDER;
 
+	/* OpenGL 1.4 */
+	static const Enum MIRRORED_REPEAT;
+
 	/* OpenGL 1.5 */
 	static const Enum BUFFER_SIZE;
 	static const Enum BUFFER_USAGE;
@@ -1267,6 +1276,31 @@ public:
 	static const Enum CLAMP_FRAGMENT_COLOR;
 	static const Enum ALPHA_INTEGER;
 
+	/* OpenGL 3.1 (ARB_uniform_buffer_object) */
+	static const Enum UNIFORM_BUFFER;
+	static const Enum MAX_UNIFORM_BLOCK_SIZE;
+	static const Uint INVALID_INDEX;
+
+	/* OpenGL 3.2 (sync objects) */
+	static const Enum SYNC_GPU_COMMANDS_COMPLETE;
+	static const Bitfield SYNC_FLUSH_COMMANDS_BIT;
+	static const Enum ALREADY_SIGNALED;
+	static const Enum TIMEOUT_EXPIRED;
+	static const Enum CONDITION_SATISFIED;
+	static const Enum WAIT_FAILED;
+
+	/* OpenGL 3.3 (ARB_vertex_type_2_10_10_10_rev) */
+	static const Enum INT_2_10_10_10_REV;
+
+	/* EXT_texture_filter_anisotropic */
+	static const Enum TEXTURE_MAX_ANISOTROPY;
+	static const Enum MAX_TEXTURE_MAX_ANISOTROPY;
+
+	/* OpenGL 4.1 (ARB_get_program_binary) */
+	static const Enum PROGRAM_BINARY_RETRIEVABLE_HINT;
+	static const Enum PROGRAM_BINARY_LENGTH;
+	static const Enum NUM_PROGRAM_BINARY_FORMATS;
+
 
 	/* Function types: */
 
@@ -1277,12 +1311,15 @@ public:
 	typedef void(GetBooleanvFunc)(Enum paramName, Boolean *paramsRet);
 	typedef void(GetFloatvFunc)(Enum paramName, Float *paramsRet);
 	typedef void(GetIntegervFunc)(Enum paramName, Int *paramsRet);
+	typedef const Ubyte *(GetStringFunc)(Enum name);
 
 	typedef void(GenBuffersFunc)(Sizei n, Uint *buffers);
 	typedef void(DeleteBuffersFunc)(Sizei n, const Uint *buffers);
 	typedef void(BindBufferFunc)(Enum target, Uint buffer);
 	typedef void(BufferDataFunc)(Enum target, Sizeiptr size, 
 			const void *data, Enum usage);
+	typedef void(BufferSubDataFunc)(Enum target, Intptr offset, 
+			Sizeiptr size, const void *data);
 	typedef void *(MapBufferFunc)(Enum target, Enum access);
 	typedef Boolean (UnmapBufferFunc)(Enum target);
 	typedef void(VertexAttribPointerFunc)(Uint index, Int size, Enum type, 
@@ -1292,6 +1329,18 @@ public:
 	typedef void(DrawArraysFunc)(Enum mode, Int first, Sizei count);
 	typedef void(DrawElementsFunc)(Enum mode, Sizei count, Enum type, 
 			const void *indexes);
+	typedef void(DrawArraysInstancedFunc)(Enum mode, Int first, 
+			Sizei count, Sizei instanceCount);
+	typedef void(DrawElementsInstancedFunc)(Enum mode, Sizei count, 
+			Enum type, const void *indexes, Sizei instanceCount);
+	typedef void(VertexAttribDivisorFunc)(Uint index, Uint divisor);
+	typedef void(GenVertexArraysFunc)(Sizei n, Uint *arrays);
+	typedef void(DeleteVertexArraysFunc)(Sizei n, const Uint *arrays);
+	typedef void(BindVertexArrayFunc)(Uint array);
+	typedef Sync(FenceSyncFunc)(Enum condition, Bitfield flags);
+	typedef void(DeleteSyncFunc)(Sync sync);
+	typedef Enum(ClientWaitSyncFunc)(Sync sync, Bitfield flags, 
+			Uint64 timeout);
 
 	typedef Uint(CreateShaderFunc)(Enum shaderType);
 	typedef void(DeleteShaderFunc)(Uint shader);
@@ -1313,9 +1362,22 @@ public:
 			Int *paramRet);
 	typedef void(GetProgramInfoLogFunc)(Uint program, Sizei maxLength, 
 			Sizei *logLenRet, Char *logStrRet);	
+	typedef void(ProgramParameteriFunc)(Uint program, Enum paramName, 
+			Int value);
+	typedef void(GetProgramBinaryFunc)(Uint program, Sizei bufSize, 
+			Sizei *lengthRet, Enum *binaryFormatRet, void *binaryRet);
+	typedef void(ProgramBinaryFunc)(Uint program, Enum binaryFormat, 
+			const void *binary, Sizei length);
+	typedef Uint(GetUniformBlockIndexFunc)(Uint program, 
+			const Char *uniformBlockName);
+	typedef void(UniformBlockBindingFunc)(Uint program, 
+			Uint uniformBlockIndex, Uint uniformBlockBinding);
+	typedef void(BindBufferBaseFunc)(Enum target, Uint index, 
+			Uint buffer);
 
 	typedef Int(GetUniformLocationFunc)(Uint program, 
 			const Char *uniformName);
+	typedef Int(GetAttribLocationFunc)(Uint program, const Char *name);
 	typedef void(GetActiveUniformFunc)(Uint program, Uint index, 
 			Sizei bufSize, Sizei *length, Int *size, Enum *type, Char *name);
 	typedef void(GetActiveAttribFunc)(Uint program, Uint index, 
@@ -1351,6 +1413,11 @@ public:
 	typedef void(TexImage2DFunc)(Enum target, Int level, Int internalFormat, 
 			Sizei width, Sizei height, Int border, Enum format, Enum type, 
 			const void *data);
+	typedef void(TexSubImage2DFunc)(Enum target, Int level, 
+			Int xOffset, Int yOffset, Sizei width, Sizei height, 
+			Enum format, Enum type, const void *data);
+	typedef void(PixelStoreiFunc)(Enum paramName, Int param);
+	typedef void(GenerateMipmapFunc)(Enum target);
 	typedef void(TexParameterfFunc)(Enum target, Enum paramName, 
 			Float param);
 	typedef void(TexParameteriFunc)(Enum target, Enum paramName, Int param);
@@ -1368,17 +1435,227 @@ public:
 	typedef Enum(CheckFramebufferStatusFunc)(Enum target);
 	typedef void(ReadPixelsFunc)(Int x, Int y, Sizei width, Sizei height, 
 			Enum format, Enum type, Void *pixels);
+	typedef void(BlitFramebufferFunc)(Int srcX0, Int srcY0, 
+			Int srcX1, Int srcY1, 
+			Int dstX0, Int dstY0, 
+			Int dstX1, Int dstY1, 
+			Bitfield mask, Enum filter);
+	typedef void(DrawBufferFunc)(Enum mode);
+	typedef void(ReadBufferFunc)(Enum mode);
 
 	typedef void(FrontFaceFunc)(Enum mode);
 	typedef void(CullFaceFunc)(Enum mode);
+	typedef void(BlendFuncFunc)(Enum srcFactor, Enum dstFactor);
+	typedef void(DepthMaskFunc)(Boolean flag);
 	typedef void(EnableFunc)(Enum capability);
 	typedef void(DisableFunc)(Enum capability);
 
 
+	/**
+	 * @brief Shadow copy of the OpenGL binding state.
+	 * @class ...
+	 *
+	 * Binding through this class skips the calls, that change nothing, and 
+	 * reading the current bindings does not query the driver. The library 
+	 * binds through it only, so the shadow copy stays valid, unless somebody 
+	 * binds around it. Call reset() in such case (or after making another 
+	 * context current). 
+	 *
+	 * The state describes the context, current in the thread, and it owns 
+	 * the scratch framebuffers of that context. Call release() before the 
+	 * context is released from the thread or destroyed. */
+	class State
+	{
+	public:
+		/**
+		 * @brief ...
+		 * @param owner - Gl, which functions are used
+		 *
+		 * Assumes the default state of a new context. */
+		State(Gl &owner);
+
+		/**
+		 * @brief Forget everything and query the driver.
+		 *
+		 * The scratch framebuffers are forgotten too: they belong to the 
+		 * previous context and are freed with it. */
+		void reset();
+
+		/**
+		 * @brief Delete the scratch framebuffers.
+		 *
+		 * Shall be called with the context still current. */
+		void release();
+
+		/**
+		 * @brief ...
+		 * @return ... */
+		inline Uint program() const
+		{ return m_program; }
+
+		/**
+		 * @brief ...
+		 * @param program - ... */
+		void useProgram(Uint program);
+
+		/**
+		 * @brief ...
+		 * @param program - ... */
+		void deleteProgram(Uint program);
+
+		/**
+		 * @brief Buffer, bound to the target.
+		 * @param target - ...
+		 * @return ...
+		 *
+		 * ELEMENT_ARRAY_BUFFER binding is tracked per vertex array. */
+		Uint buffer(Enum target) const;
+
+		/**
+		 * @brief ...
+		 * @param target - ...
+		 * @param buffer - ... */
+		void bindBuffer(Enum target, Uint buffer);
+
+		/**
+		 * @brief ...
+		 * @param n       - ...
+		 * @param buffers - ... */
+		void deleteBuffers(Sizei n, const Uint *buffers);
+
+		/**
+		 * @brief ...
+		 * @return ... */
+		inline Uint vertexArray() const
+		{ return m_vertexArray; }
+
+		/**
+		 * @brief ...
+		 * @param array - ... */
+		void bindVertexArray(Uint array);
+
+		/**
+		 * @brief ...
+		 * @param n      - ...
+		 * @param arrays - ... */
+		void deleteVertexArrays(Sizei n, const Uint *arrays);
+
+		/**
+		 * @brief ...
+		 * @return ... */
+		inline Enum activeTextureUnit() const
+		{ return m_activeTextureUnit; }
+
+		/**
+		 * @brief ...
+		 * @param unit - TEXTURE0, TEXTURE1, ... */
+		void activeTexture(Enum unit);
+
+		/**
+		 * @brief Texture, bound to the target of the active unit.
+		 * @param target - TEXTURE_2D or TEXTURE_CUBE_MAP
+		 * @return ... */
+		Uint texture(Enum target) const;
+
+		/**
+		 * @brief Bind texture to the target of the active unit.
+		 * @param target  - TEXTURE_2D or TEXTURE_CUBE_MAP
+		 * @param texture - ... */
+		void bindTexture(Enum target, Uint texture);
+
+		/**
+		 * @brief ...
+		 * @param n        - ...
+		 * @param textures - ... */
+		void deleteTextures(Sizei n, const Uint *textures);
+
+		/**
+		 * @brief ...
+		 * @param target - FRAMEBUFFER (same as DRAW_FRAMEBUFFER), 
+		 * READ_FRAMEBUFFER or DRAW_FRAMEBUFFER
+		 * @return ... */
+		Uint framebuffer(Enum target) const;
+
+		/**
+		 * @brief ...
+		 * @param target      - ...
+		 * @param framebuffer - ... */
+		void bindFramebuffer(Enum target, Uint framebuffer);
+
+		/**
+		 * @brief ...
+		 * @param n            - ...
+		 * @param framebuffers - ... */
+		void deleteFramebuffers(Sizei n, const Uint *framebuffers);
+
+		/**
+		 * @brief Framebuffer, which textures are attached to for a moment 
+		 * (for reading or copying).
+		 * @param target - READ_FRAMEBUFFER or DRAW_FRAMEBUFFER
+		 * @return ...
+		 *
+		 * Created on the first use and kept, since creating one per use 
+		 * is expensive. */
+		Uint scratchFramebuffer(Enum target);
+
+		/**
+		 * @brief ...
+		 * @param x      - ...
+		 * @param y      - ...
+		 * @param width  - ...
+		 * @param height - ... */
+		void viewport(Int x, Int y, Sizei width, Sizei height);
+
+		/**
+		 * @brief ...
+		 * @param capability - ...
+		 * @return ... */
+		bool isEnabled(Enum capability) const;
+
+		/**
+		 * @brief ...
+		 * @param capability - ... */
+		void enable(Enum capability);
+
+		/**
+		 * @brief ...
+		 * @param capability - ... */
+		void disable(Enum capability);
+
+	private:
+		Gl &m_owner;
+
+		Uint m_program;
+		Uint m_vertexArray;
+		Enum m_activeTextureUnit;
+		Uint m_readFramebuffer;
+		Uint m_drawFramebuffer;
+		Uint m_readScratchFramebuffer;
+		Uint m_drawScratchFramebuffer;
+		Int m_viewport[4];
+
+		/* Queried from the driver, when not known yet. */
+		mutable std::map<Enum, Uint> m_buffers;
+		mutable std::map<Uint, Uint> m_elementBuffers;
+		mutable std::map<std::pair<Enum, Enum>, Uint> m_textures;
+		mutable std::map<Enum, bool> m_capabilities;
+	};
+
+
 	/**
 	 * @brief Constructor, loads OpenGL functions into methods. */
 	Gl();
 
+	/**
+	 * @brief Whether uniform buffers are supported: GL 3.1 or 
+	 * GL_ARB_uniform_buffer_object.
+	 * @return ...
+	 *
+	 * Queried on the first call (a context shall be current), then kept. 
+	 * The loaded functions alone tell nothing: glXGetProcAddress() 
+	 * resolves any name under Mesa and libglvnd. */
+	bool hasUniformBuffers() const;
+
 	/* Methods are basically OpenGL functions. No need to document them, their 
 	 * documentation can be found online on www.khronos.org or https://docs.gl/ */
 
@@ -1389,11 +1666,13 @@ public:
 	GetBooleanvFunc *getBooleanv = nullptr;
 	GetFloatvFunc *getFloatv = nullptr;
 	GetIntegervFunc *getIntegerv = nullptr;
+	GetStringFunc *getString = nullptr;
 
 	GenBuffersFunc *genBuffers = nullptr;
 	DeleteBuffersFunc *deleteBuffers = nullptr;
 	BindBufferFunc *bindBuffer = nullptr;
 	BufferDataFunc *bufferData = nullptr;
+	BufferSubDataFunc *bufferSubData = nullptr;
 	MapBufferFunc *mapBuffer = nullptr;
 	UnmapBufferFunc *unmapBuffer = nullptr;
 	VertexAttribPointerFunc *vertexAttribPointer = nullptr;
@@ -1401,6 +1680,15 @@ public:
 	DisableVertexAttribArrayFunc *disableVertexAttribArray = nullptr;
 	DrawArraysFunc *drawArrays = nullptr;
 	DrawElementsFunc *drawElements = nullptr;
+	DrawArraysInstancedFunc *drawArraysInstanced = nullptr;
+	DrawElementsInstancedFunc *drawElementsInstanced = nullptr;
+	VertexAttribDivisorFunc *vertexAttribDivisor = nullptr;
+	GenVertexArraysFunc *genVertexArrays = nullptr;
+	DeleteVertexArraysFunc *deleteVertexArrays = nullptr;
+	BindVertexArrayFunc *bindVertexArray = nullptr;
+	FenceSyncFunc *fenceSync = nullptr;
+	DeleteSyncFunc *deleteSync = nullptr;
+	ClientWaitSyncFunc *clientWaitSync = nullptr;
 
 	CreateShaderFunc *createShader = nullptr;
 	DeleteShaderFunc *deleteShader = nullptr;
@@ -1417,8 +1705,17 @@ public:
 	UseProgramFunc *useProgram = nullptr;
 	GetProgramivFunc *getProgramiv = nullptr;
 	GetProgramInfoLogFunc *getProgramInfoLog = nullptr;
+	/* Optional: nullptr, if the driver has no program binaries. */
+	ProgramParameteriFunc *programParameteri = nullptr;
+	GetProgramBinaryFunc *getProgramBinary = nullptr;
+	ProgramBinaryFunc *programBinary = nullptr;
+	/* Optional: nullptr, if not loaded (see hasUniformBuffers()). */
+	GetUniformBlockIndexFunc *getUniformBlockIndex = nullptr;
+	UniformBlockBindingFunc *uniformBlockBinding = nullptr;
+	BindBufferBaseFunc *bindBufferBase = nullptr;
 
 	GetUniformLocationFunc *getUniformLocation = nullptr;
+	GetAttribLocationFunc *getAttribLocation = nullptr;
 	GetActiveUniformFunc *getActiveUniform = nullptr;
 	GetActiveAttribFunc *getActiveAttrib = nullptr;
 	Uniform1fFunc *uniform1f = nullptr;
@@ -1445,6 +1742,9 @@ public:
 	DeleteTexturesFunc *deleteTextures = nullptr;
 	BindTextureFunc *bindTexture = nullptr;
 	TexImage2DFunc *texImage2D = nullptr;
+	TexSubImage2DFunc *texSubImage2D = nullptr;
+	PixelStoreiFunc *pixelStorei = nullptr;
+	GenerateMipmapFunc *generateMipmap = nullptr;
 	TexParameterfFunc *texParameterf = nullptr;
 	TexParameteriFunc *texParameteri = nullptr;
 	TexParameterfvFunc *texParameterfv = nullptr;
@@ -1457,11 +1757,22 @@ public:
 	FramebufferTexture2DFunc *framebufferTexture2D = nullptr;
 	CheckFramebufferStatusFunc *checkFramebufferStatus = nullptr;
 	ReadPixelsFunc *readPixels = nullptr;
+	BlitFramebufferFunc *blitFramebuffer = nullptr;
+	DrawBufferFunc *drawBuffer = nullptr;
+	ReadBufferFunc *readBuffer = nullptr;
 
 	FrontFaceFunc *frontFace = nullptr;
 	CullFaceFunc *cullFace = nullptr;
+	BlendFuncFunc *blendFunc = nullptr;
+	DepthMaskFunc *depthMask = nullptr;
 	EnableFunc *enable = nullptr;
 	DisableFunc *disable = nullptr;
+
+	/* Shadow copy of the binding state, see State. Per thread, because each 
+	 * thread has its own current context (e.g. the window loader context). 
+	 * Reset it after making a context current, release it before the 
+	 * context is released or destroyed. */
+	static thread_local State state;
 };
 
 extern Gl gl;
@@ -0,0 +1,62 @@
+/**
+ * @file      
+ * @brief     OpenGL context without a window.
+ * @details   ...
+ * @author    ArthurTheDigital (arthurthedigital@gmail.com)
+ * @copyright GPL v3.
+ * @since     $Id: $ */
+
+#pragma once
+
+#include <memory>
+
+
+namespace ATD {
+
+/**
+ * @brief OpenGL context, created via EGL without X server.
+ * @class ...
+ *
+ * Makes FrameBuffer, Texture, Shader etc usable without a Window: for 
+ * server-side rendering, benchmarks and asset baking. Draw into a 
+ * FrameBuffer and read its color texture back.
+ *
+ * The surfaceless Mesa platform is preferred (works with llvmpipe 
+ * on machines without GPU), the default EGL display is the fallback. */
+class HeadlessContext
+{
+public:
+	typedef std::shared_ptr<HeadlessContext> Ptr;
+
+	/**
+	 * @brief Create the context and make it current.
+	 * @throws ... */
+	HeadlessContext();
+
+	/**
+	 * @brief ... */
+	~HeadlessContext();
+
+	/**
+	 * @brief Make the context current in the calling thread.
+	 * @throws ... */
+	void makeCurrent();
+
+	/**
+	 * @brief GL_RENDERER of the context.
+	 * @return ... */
+	const char *renderer() const;
+
+private:
+	/* Non-copyable. */
+	HeadlessContext(const HeadlessContext &other) = delete;
+
+	/* EGL handles, EGL headers are not exposed (they include X11). */
+	void *m_display;
+	void *m_surface; /* EGL_NO_SURFACE, if surfaceless. */
+	void *m_context;
+};
+
+} /* namespace ATD */
+
+
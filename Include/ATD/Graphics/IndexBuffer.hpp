@@ -0,0 +1,199 @@
+/**
+ * @file      
+ * @brief     Wrap around OpenGL element (index) buffer.
+ * @details   ...
+ * @author    ArthurTheDigital (arthurthedigital@gmail.com)
+ * @copyright GPL v3.
+ * @since     $Id: $ */
+
+#pragma once
+
+#include <ATD/Graphics/Gl.hpp>
+
+#include <stdint.h>
+#include <string.h>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+
+namespace ATD {
+
+/**
+ * @brief ...
+ * @class ... */
+class IndexBuffer
+{
+public:
+	/**
+	 * @brief ...
+	 * @class ... */
+	class Usage
+	{
+	public:
+		/**
+		 * @brief ...
+		 * @param buffer - ... */
+		Usage(const IndexBuffer &buffer);
+
+		/**
+		 * @brief ... */
+		~Usage();
+
+	private:
+		Gl::Uint m_prevBuffer;
+		bool m_activated;
+	};
+
+	typedef std::shared_ptr<IndexBuffer> Ptr;
+	typedef std::shared_ptr<const IndexBuffer> CPtr;
+
+	/**
+	 * @brief Width of a single index. */
+	enum Type {
+		INDEX_16, 
+		INDEX_32
+	};
+
+
+	/**
+	 * @brief ...
+	 * @param indices - ... */
+	IndexBuffer(const std::vector<uint16_t> &indices);
+
+	/**
+	 * @brief ...
+	 * @param indices - ...
+	 * @param compact - store as 16-bit indices, if all of them fit */
+	IndexBuffer(const std::vector<uint32_t> &indices, bool compact = true);
+
+	/**
+	 * @brief ... */
+	~IndexBuffer();
+
+	/**
+	 * @brief ...
+	 * @return ... */
+	inline Gl::Uint glId() const
+	{ return m_bufferId; }
+
+	/**
+	 * @brief ...
+	 * @return ... */
+	inline size_t size() const
+	{ return m_size; }
+
+	/**
+	 * @brief ...
+	 * @return ... */
+	inline const Type &type() const
+	{ return m_type; }
+
+	/**
+	 * @brief OpenGL type of the index (for drawElements).
+	 * @return ... */
+	Gl::Enum glType() const;
+
+	/**
+	 * @brief Build index list, referencing unique vertices.
+	 * @param vertices       - vertices, possibly containing duplicates
+	 * @param uniqueVertices - the unique vertices are appended here
+	 * @return indices into uniqueVertices, one per each of vertices
+	 *
+	 * Vertices are compared bytewise, so VertexT shall be a plain struct
+	 * without padding (like Vertex2D::GlVertex or Vertex3D::GlVertex). The
+	 * unique vertices keep the order of their first occurence. */
+	template<typename VertexT>
+	static std::vector<uint32_t> deduplicate(
+			const std::vector<VertexT> &vertices, 
+			std::vector<VertexT> &uniqueVertices);
+
+	/**
+	 * @brief Reorder triangle list indices for post-transform cache.
+	 * @param indices     - triangle list indices
+	 * @param verticesNum - number of vertices, referenced by indices
+	 * @return reordered indices
+	 *
+	 * Greedy algorithm by Tom Forsyth ("Linear-speed vertex cache
+	 * optimisation"), simulating LRU cache of 32 entries. */
+	static std::vector<uint32_t> cacheOptimized(
+			const std::vector<uint32_t> &indices, 
+			size_t verticesNum);
+
+	/**
+	 * @brief Reorder vertices in order of their first use by indices.
+	 * @param vertices - vertices to be reordered
+	 * @param indices  - indices to be remapped
+	 *
+	 * Improves pre-transform (fetch) cache locality after the indices were
+	 * reordered with cacheOptimized(). Unused vertices are dropped. */
+	template<typename VertexT>
+	static void reorderForFetch(std::vector<VertexT> &vertices, 
+			std::vector<uint32_t> &indices);
+
+private:
+	Gl::Uint m_bufferId;
+	size_t m_size;
+	Type m_type;
+};
+
+} /* namespace ATD */
+
+
+/* Template functions: */
+
+template<typename VertexT>
+std::vector<uint32_t> ATD::IndexBuffer::deduplicate(
+		const std::vector<VertexT> &vertices, 
+		std::vector<VertexT> &uniqueVertices)
+{
+	struct BytesLess
+	{
+		inline bool operator()(const VertexT *lhs, const VertexT *rhs) const
+		{ return ::memcmp(lhs, rhs, sizeof(VertexT)) < 0; }
+	};
+
+	/* Pointers into the source vector: it is not modified here. */
+	std::map<const VertexT *, uint32_t, BytesLess> indexMap;
+	std::vector<uint32_t> indices;
+	indices.reserve(vertices.size());
+
+	uint32_t baseIndex = static_cast<uint32_t>(uniqueVertices.size());
+	uint32_t nextIndex = baseIndex;
+	for (auto &vertex : vertices) {
+		auto indexIt = indexMap.find(&vertex);
+		if (indexIt == indexMap.end()) {
+			indexMap.insert(std::make_pair(&vertex, nextIndex));
+			uniqueVertices.push_back(vertex);
+			indices.push_back(nextIndex++);
+		} else {
+			indices.push_back(indexIt->second);
+		}
+	}
+
+	return indices;
+}
+
+template<typename VertexT>
+void ATD::IndexBuffer::reorderForFetch(std::vector<VertexT> &vertices, 
+		std::vector<uint32_t> &indices)
+{
+	static const uint32_t UNMAPPED = static_cast<uint32_t>(-1);
+
+	std::vector<uint32_t> remap(vertices.size(), UNMAPPED);
+	std::vector<VertexT> reordered;
+	reordered.reserve(vertices.size());
+
+	for (auto &index : indices) {
+		if (remap[index] == UNMAPPED) {
+			remap[index] = static_cast<uint32_t>(reordered.size());
+			reordered.push_back(vertices[index]);
+		}
+		index = remap[index];
+	}
+
+	vertices.swap(reordered);
+}
+
+
@@ -0,0 +1,148 @@
+/**
+ * @file      
+ * @brief     Wrap around OpenGL vertex buffer (2D per-instance data).
+ * @details   ...
+ * @author    ArthurTheDigital (arthurthedigital@gmail.com)
+ * @copyright GPL v3.
+ * @since     $Id: $ */
+
+#pragma once
+
+#include <ATD/Core/Matrix3.hpp>
+#include <ATD/Core/Vector3.hpp>
+#include <ATD/Core/Vector4.hpp>
+#include <ATD/Graphics/Gl.hpp>
+#include <ATD/Graphics/Pixel.hpp>
+
+#include <memory>
+#include <vector>
+
+
+namespace ATD {
+
+/**
+ * @brief Per-instance transforms and colors for instanced drawing.
+ * @class ...
+ *
+ * Drawn together with a VertexBuffer2D by a Shader2D, which has
+ * 'mat3 atrInstanceTransform' (and optionally 'vec4 atrInstanceColor')
+ * attributes, see Shader2D::INSTANCED_VERTEX_SOURCE. */
+class InstanceBuffer2D
+{
+public:
+	/**
+	 * @brief ...
+	 * @class ... */
+	class Usage
+	{
+	public:
+		/**
+		 * @brief ...
+		 * @param buffer - ... */
+		Usage(const InstanceBuffer2D &buffer);
+
+		/**
+		 * @brief ... */
+		~Usage();
+
+	private:
+		Gl::Uint m_prevBuffer;
+		bool m_activated;
+	};
+
+	/**
+	 * @brief ... */
+	class Instance
+	{
+	public:
+		/**
+		 * @brief ...
+		 * @param n_transform - ...
+		 * @param n_color     - ... */
+		inline Instance(const Matrix3F &n_transform = Matrix3F(), 
+				const Pixel &n_color = Pixel(0xFF, 0xFF, 0xFF))
+			: transform(n_transform)
+			, color(n_color)
+		{}
+
+		Matrix3F transform;
+		Pixel color;
+	};
+
+	/**
+	 * @brief ... */
+	class GlInstance
+	{
+	public:
+		/**
+		 * @brief ...
+		 * @param instance - ... */
+		GlInstance(const Instance &instance);
+
+		/* Matrix3F is stored by rows, while matrix attribute takes
+		 * columns. */
+		Vector3F transformColumns[3];
+		Vector4F color;
+	};
+
+	typedef std::shared_ptr<InstanceBuffer2D> Ptr;
+	typedef std::shared_ptr<const InstanceBuffer2D> CPtr;
+
+
+	/**
+	 * @brief ...
+	 * @param instances - ... */
+	InstanceBuffer2D(const std::vector<Instance> &instances);
+
+	/**
+	 * @brief ... */
+	~InstanceBuffer2D();
+
+	/**
+	 * @brief ...
+	 * @return ... */
+	inline Gl::Uint glId() const
+	{ return m_bufferId; }
+
+	/**
+	 * @brief ...
+	 * @return ... */
+	inline size_t size() const
+	{ return m_size; }
+
+	/**
+	 * @brief Replace all the instances.
+	 * @param instances - ...
+	 *
+	 * The buffer storage is orphaned, so the draws, which still use the
+	 * old data, do not stall the upload. */
+	void update(const std::vector<Instance> &instances);
+
+	/**
+	 * @brief Point instance attributes to this buffer.
+	 * @param transformIndex  - first of 3 'atrInstanceTransform' locations
+	 * @param colorIsRequired - ...
+	 * @param colorIndex      - ...
+	 *
+	 * Vertex array must be bound before calling this function. */
+	void enableAttributes(Gl::Uint transformIndex, 
+			bool colorIsRequired, 
+			Gl::Uint colorIndex) const;
+
+	/**
+	 * @brief Revert enableAttributes().
+	 * @param transformIndex  - ...
+	 * @param colorIsRequired - ...
+	 * @param colorIndex      - ... */
+	static void disableAttributes(Gl::Uint transformIndex, 
+			bool colorIsRequired, 
+			Gl::Uint colorIndex);
+
+private:
+	Gl::Uint m_bufferId;
+	size_t m_size;
+};
+
+} /* namespace ATD */
+
+
@@ -0,0 +1,259 @@
+/**
+ * @file      
+ * @brief     Light sources for the lighting Shader3D.
+ * @details   ...
+ * @author    ArthurTheDigital (arthurthedigital@gmail.com)
+ * @copyright GPL v3.
+ * @since     $Id: $ */
+
+#pragma once
+
+#include <ATD/Core/Vector3.hpp>
+#include <ATD/Core/Vector4.hpp>
+#include <ATD/Graphics/Gl.hpp>
+#include <ATD/Graphics/Pixel.hpp>
+#include <ATD/Graphics/Shader.hpp>
+
+#include <memory>
+#include <vector>
+
+
+namespace ATD {
+
+/**
+ * @brief Light sources, packed for the lighting Shader3D variants.
+ * @class ...
+ *
+ * All the lights are packed into vec4 texels and uploaded with a single
+ * call: into a uniform buffer, or into a float texture, when uniform
+ * buffers are not supported. The lighting shaders index into it, so the
+ * number of lights does not change the number of uploads.
+ *
+ * Typical frame: set the lights, update(), set shader() to the target,
+ * then draw within Lighting::Usage. */
+class Lighting
+{
+public:
+	/**
+	 * @brief Binds the packed lights for drawing.
+	 * @class ... */
+	class Usage
+	{
+	public:
+		/**
+		 * @brief ...
+		 * @param lighting - ... */
+		Usage(const Lighting &lighting);
+
+		/**
+		 * @brief ... */
+		~Usage();
+
+	private:
+		Gl::Uint m_prevTexture;
+		Gl::Enum m_prevUnit;
+		bool m_isTexture;
+		bool m_activated;
+	};
+
+	/**
+	 * @brief Parameters, common for all lights. */
+	class Light
+	{
+	public:
+		/**
+		 * @brief ...
+		 * @param n_color    - ...
+		 * @param n_ambient  - ...
+		 * @param n_diffuse  - ...
+		 * @param n_specular - ... */
+		inline Light(const Pixel &n_color = Pixel(0xFF, 0xFF, 0xFF), 
+				float n_ambient = 0.f, 
+				float n_diffuse = 0.f, 
+				float n_specular = 0.f)
+			: color(n_color)
+			, ambient(n_ambient)
+			, diffuse(n_diffuse)
+			, specular(n_specular)
+		{}
+
+		Pixel color;
+		float ambient;
+		float diffuse;
+		float specular;
+	};
+
+	/**
+	 * @brief Directional light. */
+	class DirLight
+	{
+	public:
+		/**
+		 * @brief ...
+		 * @param n_lt        - ...
+		 * @param n_direction - ... */
+		inline DirLight(const Light &n_lt = Light(), 
+				const Vector3F &n_direction = Vector3F(0.f, 0.f, 1.f))
+			: lt(n_lt)
+			, direction(n_direction)
+		{}
+
+		Light lt;
+		Vector3F direction;
+	};
+
+	/**
+	 * @brief Point light. */
+	class PointLight
+	{
+	public:
+		/**
+		 * @brief ...
+		 * @param n_lt          - ...
+		 * @param n_position    - ...
+		 * @param n_attenuation - constant, linear and quadratic factors */
+		inline PointLight(const Light &n_lt = Light(), 
+				const Vector3F &n_position = Vector3F(), 
+				const Vector3F &n_attenuation = Vector3F(1.f, 0.f, 0.f))
+			: lt(n_lt)
+			, position(n_position)
+			, attenuation(n_attenuation)
+		{}
+
+		Light lt;
+		Vector3F position;
+		Vector3F attenuation;
+	};
+
+	/**
+	 * @brief Spot light. */
+	class SpotLight
+	{
+	public:
+		/**
+		 * @brief ...
+		 * @param n_plt       - ...
+		 * @param n_direction - ...
+		 * @param n_cutoff    - cos of the half angle */
+		inline SpotLight(const PointLight &n_plt = PointLight(), 
+				const Vector3F &n_direction = Vector3F(0.f, 0.f, 1.f), 
+				float n_cutoff = 0.f)
+			: plt(n_plt)
+			, direction(n_direction)
+			, cutoff(n_cutoff)
+		{}
+
+		PointLight plt;
+		Vector3F direction;
+		float cutoff;
+	};
+
+	typedef std::shared_ptr<Lighting> Ptr;
+	typedef std::shared_ptr<const Lighting> CPtr;
+
+
+	/**
+	 * @brief ...
+	 * @param instanced - shaders for drawing InstanceBuffer3D */
+	Lighting(bool instanced = false);
+
+	/**
+	 * @brief ... */
+	~Lighting();
+
+	/**
+	 * @brief ...
+	 * @param dirLights - ... */
+	void setDirLights(const std::vector<DirLight> &dirLights);
+
+	/**
+	 * @brief ...
+	 * @return ... */
+	inline const std::vector<DirLight> &dirLights() const
+	{ return m_dirLights; }
+
+	/**
+	 * @brief ...
+	 * @param pointLights - ... */
+	void setPointLights(const std::vector<PointLight> &pointLights);
+
+	/**
+	 * @brief ...
+	 * @return ... */
+	inline const std::vector<PointLight> &pointLights() const
+	{ return m_pointLights; }
+
+	/**
+	 * @brief ...
+	 * @param spotLights - ... */
+	void setSpotLights(const std::vector<SpotLight> &spotLights);
+
+	/**
+	 * @brief ...
+	 * @return ... */
+	inline const std::vector<SpotLight> &spotLights() const
+	{ return m_spotLights; }
+
+	/**
+	 * @brief ...
+	 * @param specularPower - ... */
+	void setSpecularPower(float specularPower);
+
+	/**
+	 * @brief ...
+	 * @return ... */
+	inline float specularPower() const
+	{ return m_specularPower; }
+
+	/**
+	 * @brief ...
+	 * @param cameraPosition - for the specular light */
+	void setCameraPosition(const Vector3F &cameraPosition);
+
+	/**
+	 * @brief ...
+	 * @return ... */
+	inline const Vector3F &cameraPosition() const
+	{ return m_cameraPosition; }
+
+	/**
+	 * @brief ...
+	 * @return ... */
+	inline Shader3D::LightVariant::Storage storage() const
+	{ return m_storage; }
+
+	/**
+	 * @brief Upload the packed lights, if changed since the last time. */
+	void update();
+
+	/**
+	 * @brief Smallest shader variant, which covers the current lights.
+	 * @param specular    - ...
+	 * @param vertexColor - ...
+	 * @return ... */
+	Shader3D::Ptr shader(bool specular = true, bool vertexColor = true);
+
+private:
+	/**
+	 * @brief Pack the lights into m_texels. */
+	void pack();
+
+
+	Shader3D::LightVariant::Storage m_storage;
+	Gl::Uint m_bufferId;
+	Gl::Uint m_textureId;
+	Shader3D::LightVariants m_variants;
+
+	std::vector<DirLight> m_dirLights;
+	std::vector<PointLight> m_pointLights;
+	std::vector<SpotLight> m_spotLights;
+	float m_specularPower;
+	Vector3F m_cameraPosition;
+
+	std::vector<Vector4F> m_texels;
+	bool m_isChanged;
+};
+
+} /* namespace ATD */
+
+
@@ -15,7 +15,10 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 
 namespace ATD {
@@ -66,14 +69,49 @@ public:
 		Vector2L m_joint;
 	};
 
+	/**
+	 * @brief Glyph quads of a string, with the top left corner at (0, 0).
+	 * @class ... */
+	class Layout
+	{
+	public:
+		typedef std::shared_ptr<const Layout> CPtr;
+
+		/* Glyph positions for joint (0, 0), before the top left offset. */
+		std::vector<Vector2L> positions;
+		Vector2L topLeft;
+		RectL bounds;
+		std::vector<Vertex2D::GlVertex> glVertices;
+	};
+
 	typedef std::shared_ptr<PxFont> Ptr;
 	typedef std::shared_ptr<const PxFont> CPtr;
 
+	/* Glyphs of Basic Multilingual Plane are looked up directly. */
+	static const Unicode::Glyph DENSE_GLYPHS_MAX_NUM;
+
+	/* Cached layouts are dropped all at once, when there are too many 
+	 * (the ones still held by the callers stay valid). */
+	static const size_t LAYOUT_CACHE_MAX_SIZE;
+
 
 	/**
 	 * @brief ... */
 	PxFont();
 
+	/**
+	 * @brief Copies the glyphs and shares the texture and the image.
+	 * @param other - font to copy
+	 *
+	 * The copy starts with an empty layout cache. */
+	PxFont(const PxFont &other);
+
+	/**
+	 * @brief Same as the copy constructor.
+	 * @param other - font to copy
+	 * @return *this */
+	PxFont &operator=(const PxFont &other);
+
 	/**
 	 * @brief ...
 	 * @return ... */
@@ -86,6 +124,15 @@ public:
 	 * @return proper graphical glyph. */
 	const Glyph &getGlyph(const Unicode::Glyph &glyph) const;
 
+	/**
+	 * @brief Layout of a string, memoized for repeated strings.
+	 * @param unicode - ...
+	 * @return ...
+	 *
+	 * Thread-safe: the font may be shared with the render or loader 
+	 * thread. */
+	Layout::CPtr layout(const Unicode &unicode) const;
+
 private:
 	/**
 	 * @brief ...
@@ -107,11 +154,26 @@ private:
 	 * Should be called after image has changed. */
 	void updateTextureFromImage();
 
+	/**
+	 * @brief Rebuild the lookup tables from m_glyphs.
+	 *
+	 * Should be called after glyphs have changed. */
+	void updateGlyphTable();
+
 
 	Glyph m_dftGlyph;
 	std::map<Unicode::Glyph, Glyph> m_glyphs;
 	Texture::Ptr m_texturePtr;
 
+	/* Lookup tables: m_tableGlyphs[0] is the default glyph, dense indices 
+	 * are by code point, sparse ones are sorted by code point. */
+	std::vector<Glyph> m_tableGlyphs;
+	std::vector<uint32_t> m_denseIndices;
+	std::vector<std::pair<Unicode::Glyph, uint32_t>> m_sparseIndices;
+
+	mutable std::map<Unicode, Layout::CPtr> m_layouts;
+	mutable std::mutex m_layoutsMtx;
+
 	Image::Ptr m_imagePtr;
 };
 
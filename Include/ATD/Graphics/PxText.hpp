@@ -23,9 +23,7 @@ namespace ATD {
 
 /* FIXME: PxText class is now crude. It requires redesign.
  * Shall handle multilines.
- * Shall support ordered glyphs.
- *
- * How to handle text being edited? Recreate it from scratch every time? */
+ * Shall support ordered glyphs. */
 
 /**
  * @brief ...
@@ -44,15 +42,40 @@ public:
 	 * @param unicode - ... */
 	PxText(PxFont::CPtr pxFontPtr, const Unicode &unicode = Unicode());
 
+	/**
+	 * @brief Change the text, reusing the vertex buffer.
+	 * @param unicode - ...
+	 *
+	 * Glyph quads are regenerated and uploaded starting from the first 
+	 * changed character only. */
+	void setText(const Unicode &unicode);
+
+	/**
+	 * @brief ...
+	 * @return ... */
+	inline const Unicode &text() const
+	{ return m_unicode; }
+
 	/**
 	 * @brief ...
 	 * @param target - ... */
 	virtual void drawSelf(FrameBuffer &target) const override;
 
 private:
+	/**
+	 * @brief Lay out the glyphs and update the vertices.
+	 * @param first - first changed character */
+	void relayout(size_t first);
+
+
 	Unicode m_unicode;
 	PxFont::CPtr m_pxFontPtr;
 
+	/* Glyph positions for joint (0, 0), before the top left offset. */
+	std::vector<Vector2L> m_positions;
+	Vector2L m_topLeft;
+
+	VertexBuffer2D::Builder m_builder;
 	VertexBuffer2D m_vertices;
 };
 
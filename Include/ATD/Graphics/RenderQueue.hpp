@@ -0,0 +1,145 @@
+/**
+ * @file      
+ * @brief     Deferred, state-sorted drawing to frame buffers.
+ * @details   ...
+ * @author    ArthurTheDigital (arthurthedigital@gmail.com)
+ * @copyright GPL v3.
+ * @since     $Id: $ */
+
+#pragma once
+
+#include <ATD/Core/Transform2D.hpp>
+#include <ATD/Core/Transform3D.hpp>
+#include <ATD/Graphics/FrameBuffer.hpp>
+#include <ATD/Graphics/Shader.hpp>
+#include <ATD/Graphics/Texture.hpp>
+#include <ATD/Graphics/VertexBuffer2D.hpp>
+#include <ATD/Graphics/VertexBuffer3D.hpp>
+
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+
+namespace ATD {
+
+/**
+ * @brief Records draws and executes them sorted by state.
+ * @class ...
+ *
+ * Each draw gets a 64-bit key: target, then opaque/translucent, then
+ * shader, texture and depth. On submit() the draws are sorted by the
+ * key, so that the target, shader, texture and blending are changed
+ * only between the groups.
+ *
+ * Opaque 3D draws go front-to-back (for early depth test), translucent
+ * 3D draws go back-to-front. Translucent 2D draws keep the call order.
+ * Targets are drawn in order of their first use.
+ *
+ * Vertex buffers are not owned: they shall live until submit(). */
+class RenderQueue
+{
+public:
+	typedef std::shared_ptr<RenderQueue> Ptr;
+	typedef std::shared_ptr<const RenderQueue> CPtr;
+
+
+	/**
+	 * @brief ... */
+	RenderQueue();
+
+	/**
+	 * @brief ...
+	 * @param target      - ...
+	 * @param vertices2D  - ...
+	 * @param transform   - ...
+	 * @param texturePtr  - bound to TEX_0, if not nullptr
+	 * @param translucent - draw with alpha blending
+	 *
+	 * Draws with the target current Shader2D (at the moment of call). */
+	void draw(FrameBuffer &target, 
+			const VertexBuffer2D &vertices2D, 
+			const Transform2D &transform, 
+			Texture::CPtr texturePtr = nullptr, 
+			bool translucent = false);
+
+	/**
+	 * @brief ...
+	 * @param target      - ...
+	 * @param vertices3D  - ...
+	 * @param transform   - ...
+	 * @param texturePtr  - bound to TEX_0, if not nullptr
+	 * @param translucent - draw with alpha blending, no depth writes
+	 *
+	 * Draws with the target current Shader3D (at the moment of call).
+	 * Depth is the distance from the target Projection3D to the
+	 * transform offset. */
+	void draw(FrameBuffer &target, 
+			const VertexBuffer3D &vertices3D, 
+			const Transform3D &transform, 
+			Texture::CPtr texturePtr = nullptr, 
+			bool translucent = false);
+
+	/**
+	 * @brief Execute all the recorded draws and clear the queue. */
+	void submit();
+
+	/**
+	 * @brief Drop all the recorded draws. */
+	void clear();
+
+	/**
+	 * @brief ...
+	 * @return number of recorded draws */
+	inline size_t size() const
+	{ return m_commands.size(); }
+
+private:
+	struct Command
+	{
+		uint64_t key;
+		FrameBuffer *target;
+		Shader::Ptr shaderPtr;
+		Texture::CPtr texturePtr;
+		bool translucent;
+
+		const VertexBuffer2D *vertices2D;
+		Transform2D transform2D;
+		const VertexBuffer3D *vertices3D;
+		Transform3D transform3D;
+	};
+
+	/**
+	 * @brief ...
+	 * @param command - key is filled here
+	 * @param order   - depth or call order, larger goes later */
+	void push(Command &command, uint32_t order);
+
+	/**
+	 * @brief Small index of the object in order of its first use.
+	 * @param indices - ...
+	 * @param object  - ...
+	 * @param maxNum  - ...
+	 * @return ...
+	 * @throws ... */
+	static uint64_t getIndex(std::map<const void *, uint64_t> &indices, 
+			const void *object, 
+			uint64_t maxNum);
+
+	/**
+	 * @brief ...
+	 * @param command - ... */
+	static void execute(const Command &command);
+
+
+	std::vector<Command> m_commands;
+	std::map<const void *, uint64_t> m_targetIndices;
+	std::map<const void *, uint64_t> m_shaderIndices;
+	std::map<const void *, uint64_t> m_textureIndices;
+};
+
+} /* namespace ATD */
+
+
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <ATD/Core/Fs.hpp>
 #include <ATD/Core/Matrix3.hpp>
 #include <ATD/Core/Matrix4.hpp>
 #include <ATD/Core/Vector2.hpp>
@@ -18,9 +19,13 @@
 #include <ATD/Graphics/VertexBuffer2D.hpp>
 #include <ATD/Graphics/VertexBuffer3D.hpp>
 
+#include <stdint.h>
+
+#include <array>
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 
 namespace ATD {
@@ -55,6 +60,106 @@ public:
 		bool m_activated;
 	};
 
+	/**
+	 * @brief Uniform, resolved by name once.
+	 * @class ...
+	 *
+	 * Setting a uniform via handle skips the lookup by name and the type 
+	 * check. Obtain it via Shader::getUniformHandle<T>(). Valid for the 
+	 * shader, which issued it, only. */
+	template<typename T>
+	class UniformHandle
+	{
+	public:
+		/**
+		 * @brief Invalid handle. */
+		inline UniformHandle()
+			: m_program(0)
+			, m_index(0)
+		{}
+
+		/**
+		 * @brief ...
+		 * @return ... */
+		inline bool isValid() const
+		{ return m_program != 0; }
+
+	private:
+		friend class Shader;
+
+		/**
+		 * @brief ...
+		 * @param n_program - ...
+		 * @param n_index   - ... */
+		inline UniformHandle(Gl::Uint n_program, size_t n_index)
+			: m_program(n_program)
+			, m_index(n_index)
+		{}
+
+
+		Gl::Uint m_program;
+		size_t m_index;
+	};
+
+	/**
+	 * @brief Compiled shader stage, shared between programs.
+	 * @class ...
+	 *
+	 * A stage may consist of several objects: one with main() and the 
+	 * others with the functions it declares and calls (like a lighting 
+	 * library). */
+	class Object
+	{
+	public:
+		typedef std::shared_ptr<Object> Ptr;
+		typedef std::shared_ptr<const Object> CPtr;
+
+		/**
+		 * @brief ...
+		 * @param source - ...
+		 * @param type   - Gl::VERTEX_SHADER or Gl::FRAGMENT_SHADER
+		 * @throws ... */
+		Object(const std::string &source, Gl::Enum type);
+
+		/**
+		 * @brief ... */
+		~Object();
+
+		/**
+		 * @brief Compiled object from the process-wide cache.
+		 * @param source - ...
+		 * @param type   - ...
+		 * @return ...
+		 * @throws ...
+		 *
+		 * Source is compiled only if there is no object with the same 
+		 * source and type alive. */
+		static Ptr get(const std::string &source, Gl::Enum type);
+
+		/**
+		 * @brief ...
+		 * @return ... */
+		inline Gl::Uint glId() const
+		{ return m_shaderId; }
+
+		/**
+		 * @brief ...
+		 * @return ... */
+		inline Gl::Enum type() const
+		{ return m_type; }
+
+		/**
+		 * @brief ...
+		 * @return ... */
+		inline const std::string &source() const
+		{ return m_source; }
+
+	private:
+		Gl::Uint m_shaderId;
+		Gl::Enum m_type;
+		std::string m_source;
+	};
+
 	/* Plain 3D: */
 
 	/* Light 3D: */
@@ -67,10 +172,34 @@ public:
 	Shader(const std::string &vertexSource, 
 			const std::string &fragmentSource);
 
+	/**
+	 * @brief Link program from several modules per stage.
+	 * @param vertexModules   - sources, exactly one has main()
+	 * @param fragmentModules - sources, exactly one has main()
+	 *
+	 * Modules are compiled via Object::get(), so the ones shared with 
+	 * other programs are compiled once. */
+	Shader(const std::vector<std::string> &vertexModules, 
+			const std::vector<std::string> &fragmentModules);
+
 	/**
 	 * @brief ... */
 	~Shader();
 
+	/**
+	 * @brief Cache linked programs in dir, if the driver supports it.
+	 * @param dir - created, if it does not exist
+	 *
+	 * Programs are stored by hash of their sources and the driver 
+	 * vendor, renderer and version. Shaders, created afterwards, are 
+	 * loaded from the cache, if possible, and compiled (and stored) 
+	 * otherwise. */
+	static void enableBinaryCache(const Fs::Path &dir);
+
+	/**
+	 * @brief ... */
+	static void disableBinaryCache();
+
 	/**
 	 * @brief ...
 	 * @param name - ...
@@ -145,6 +274,93 @@ public:
 	void setUniformSamplerCubeUnit(const std::string &name, 
 			const Texture::Unit &unit);
 
+	/**
+	 * @brief Resolve uniform by name.
+	 * @param name - ...
+	 * @return ...
+	 * @throws if there is no uniform 'name' of type T in the shader
+	 *
+	 * T is one of float, int, Vector2F, Vector2I, Vector3F, Vector3I, 
+	 * Vector4F, Vector4I, Matrix3F, Matrix4F or Texture::Unit (for 
+	 * sampler2D and samplerCube). */
+	template<typename T>
+	UniformHandle<T> getUniformHandle(const std::string &name) const;
+
+	/**
+	 * @brief ...
+	 * @param handle - ...
+	 * @param value  - ... */
+	void setUniform(const UniformHandle<float> &handle, float value);
+
+	/**
+	 * @brief ...
+	 * @param handle - ...
+	 * @param value  - ... */
+	void setUniform(const UniformHandle<int> &handle, int value);
+
+	/**
+	 * @brief ...
+	 * @param handle - ...
+	 * @param value  - ... */
+	void setUniform(const UniformHandle<Vector2F> &handle, 
+			const Vector2F &value);
+
+	/**
+	 * @brief ...
+	 * @param handle - ...
+	 * @param value  - ... */
+	void setUniform(const UniformHandle<Vector2I> &handle, 
+			const Vector2I &value);
+
+	/**
+	 * @brief ...
+	 * @param handle - ...
+	 * @param value  - ... */
+	void setUniform(const UniformHandle<Vector3F> &handle, 
+			const Vector3F &value);
+
+	/**
+	 * @brief ...
+	 * @param handle - ...
+	 * @param value  - ... */
+	void setUniform(const UniformHandle<Vector3I> &handle, 
+			const Vector3I &value);
+
+	/**
+	 * @brief ...
+	 * @param handle - ...
+	 * @param value  - ... */
+	void setUniform(const UniformHandle<Vector4F> &handle, 
+			const Vector4F &value);
+
+	/**
+	 * @brief ...
+	 * @param handle - ...
+	 * @param value  - ... */
+	void setUniform(const UniformHandle<Vector4I> &handle, 
+			const Vector4I &value);
+
+	/**
+	 * @brief ...
+	 * @param handle - ...
+	 * @param value  - ... */
+	void setUniform(const UniformHandle<Matrix3F> &handle, 
+			const Matrix3F &value);
+
+	/**
+	 * @brief ...
+	 * @param handle - ...
+	 * @param value  - ... */
+	void setUniform(const UniformHandle<Matrix4F> &handle, 
+			const Matrix4F &value);
+
+	/**
+	 * @brief Enables given texture unit for uniform sampler
+	 * @param handle - ...
+	 * @param unit   - ... */
+	void setUniform(const UniformHandle<Texture::Unit> &handle, 
+			const Texture::Unit &unit);
+
 	// TODO: size_t getUniformArraySize(const std::string &name);
 
 	/**
@@ -169,39 +385,86 @@ public:
 	// TODO: Debug functions for listing all unoptimized attributes.
 
 private:
+	/* Values are kept on CPU side, so that the same value is not uploaded 
+	 * twice. If the program is not bound, when the value is set, upload is 
+	 * deferred until the next Shader::Usage. */
 	struct UniformLocationDesc
 	{
 		inline UniformLocationDesc(const Gl::Int &n_location, 
 				const Gl::Enum &n_type)
-			: location(n_location), type(n_type), isSet(false)
+			: location(n_location)
+			, type(n_type)
+			, isSet(false)
+			, isPending(false)
+			, value()
 		{}
 
 		Gl::Int location;
 		Gl::Enum type;
 		bool isSet;
+		bool isPending;
+		std::array<unsigned char, sizeof(Matrix4F)> value;
 	};
 
-	typedef std::map<std::string, UniformLocationDesc> UniformLocationMap;
+	typedef std::map<std::string, size_t> UniformLocationMap;
 
 
+	/**
+	 * @brief Attach cached objects of the stage to the program.
+	 * @param modules - ...
+	 * @param type    - ... */
+	void attachModules(const std::vector<std::string> &modules, 
+			Gl::Enum type);
+
+	/**
+	 * @brief ...
+	 * @param path - ...
+	 * @param hash - expected hash of the sources and the driver
+	 * @return false, if there is no suitable binary */
+	bool loadBinary(const Fs::Path &path, uint64_t hash);
+
 	/**
 	 * @brief ...
-	 * @param shaderSource - ...
-	 * @param shaderType   - ...
-	 * @param shaderId     - ... */
-	void compileShader(const std::string &shaderSource, 
-			Gl::Enum shaderType, 
-			Gl::Uint &shaderId);
+	 * @param path - ...
+	 * @param hash - ... */
+	void saveBinary(const Fs::Path &path, uint64_t hash) const;
 
 	/**
 	 * @brief ... */
 	void initUniforms();
 
+	/**
+	 * @brief Index of uniform 'name' of given type.
+	 * @param name - ...
+	 * @param type - ...
+	 * @return ...
+	 * @throws if not found */
+	size_t getUniformIndex(const std::string &name, Gl::Enum type) const;
+
+	/**
+	 * @brief ...
+	 * @param handleProgram - program, which issued the handle
+	 * @param index         - ...
+	 * @param r_value       - raw value in OpenGL layout
+	 * @param valueSize     - ... */
+	void setUniformValue(Gl::Uint handleProgram, size_t index, 
+			const void *r_value, size_t valueSize);
+
+	/**
+	 * @brief Upload the deferred values (the program shall be bound). */
+	void uploadPendingUniforms() const;
+
+	/**
+	 * @brief ...
+	 * @param desc - ... */
+	void uploadUniform(const UniformLocationDesc &desc) const;
+
 
 	Gl::Uint m_program;
-	Gl::Uint m_vertexShaderId;
-	Gl::Uint m_fragmentShaderId;
+	std::vector<Object::Ptr> m_objects;
 	UniformLocationMap m_uniformLocationMap;
+	mutable std::vector<UniformLocationDesc> m_uniforms;
+	mutable std::vector<size_t> m_pendingUniforms;
 	bool m_isCanvasRequired;
 };
 
@@ -224,6 +487,10 @@ public:
 	static const std::string ALPHA_VERTEX_SOURCE;
 	static const std::string ALPHA_FRAGMENT_SOURCE;
 
+	/* Vertex shader, taking transform and color from InstanceBuffer2D 
+	 * (use with any of the fragment sources above). */
+	static const std::string INSTANCED_VERTEX_SOURCE;
+
 	/* FIXME: add more! */
 
 	/* Default 2D shader. */
@@ -237,11 +504,24 @@ public:
 	Shader2D(const std::string &vertexSource = DFT_VERTEX_SOURCE, 
 			const std::string &fragmentSource = DFT_FRAGMENT_SOURCE);
 
+	/**
+	 * @brief ...
+	 * @param vertexModules   - see Shader
+	 * @param fragmentModules - see Shader */
+	Shader2D(const std::vector<std::string> &vertexModules, 
+			const std::vector<std::string> &fragmentModules);
+
 	/**
 	 * @brief ...
 	 * @return ... */
 	const VertexBuffer2D::AttrIndices &getAttrIndices() const;
 
+	/**
+	 * @brief 'unfTransform' uniform, invalid if the shader has none.
+	 * @return ... */
+	inline const UniformHandle<Matrix3F> &transformUniform() const
+	{ return m_transformUniform; }
+
 private:
 	/**
 	 * @brief ...
@@ -252,6 +532,7 @@ private:
 
 
 	VertexBuffer2D::AttrIndices m_attrIndices;
+	UniformHandle<Matrix3F> m_transformUniform;
 };
 
 /**
@@ -269,14 +550,36 @@ public:
 	static const std::string PLAIN_VERTEX_SOURCE;
 	static const std::string PLAIN_FRAGMENT_SOURCE;
 
-	/* Shader for drawing illuminated model with normals. */
+	/* Shader for drawing illuminated model with normals. The fragment 
+	 * shader is LIGHT_FRAGMENT_SOURCE_TEMPLATE, linked with a light storage 
+	 * module: LIGHT_BUFFER_FRAGMENT_SOURCE_TEMPLATE or 
+	 * LIGHT_TEXTURE_FRAGMENT_SOURCE (see LightVariant::fragmentModules() 
+	 * and Lighting::shader()). */
 	static const std::string LIGHT_VERTEX_SOURCE;
 
+	/* Template args (%u): max directional, point and spot lights, then
+	 * specular and vertex color flags (0 or 1), see LightVariant. */
 	static const std::string LIGHT_FRAGMENT_SOURCE_TEMPLATE;
 	static const unsigned LIGHT_DFT_MAX_DIR_LIGHTS;
 	static const unsigned LIGHT_DFT_MAX_POINT_LIGHTS;
 	static const unsigned LIGHT_DFT_MAX_SPOT_LIGHTS;
-	static const std::string LIGHT_FRAGMENT_SOURCE;
+
+	/* Light storage modules, one of them shall be linked together with 
+	 * LIGHT_FRAGMENT_SOURCE_TEMPLATE instance. The lights are packed into 
+	 * vec4 texels: LIGHT_HEADER_TEXELS, then LIGHT_TEXELS per light (see 
+	 * Lighting). Buffer template arg (%u): texels number. */
+	static const std::string LIGHT_BUFFER_FRAGMENT_SOURCE_TEMPLATE;
+	static const std::string LIGHT_TEXTURE_FRAGMENT_SOURCE;
+	static const unsigned LIGHT_HEADER_TEXELS;
+	static const unsigned LIGHT_TEXELS;
+	static const Gl::Uint LIGHT_BUFFER_BINDING;
+	static const Texture::Unit LIGHT_TEXTURE_UNIT;
+
+	/* Vertex shaders, taking transform and color from InstanceBuffer3D 
+	 * (use with PLAIN_FRAGMENT_SOURCE, or with the light fragment modules, 
+	 * same as LIGHT_VERTEX_SOURCE). */
+	static const std::string INSTANCED_VERTEX_SOURCE;
+	static const std::string INSTANCED_LIGHT_VERTEX_SOURCE;
 
 	/* Default 3D shader: */
 	static const std::string DFT_VERTEX_SOURCE;
@@ -285,6 +588,114 @@ public:
 	/* FIXME: Add more! */
 
 
+	/**
+	 * @brief Light numbers and features of a lighting shader.
+	 * @class ...
+	 *
+	 * Instantiates LIGHT_FRAGMENT_SOURCE_TEMPLATE and links it with the
+	 * light storage module. A variant without vertex color ignores
+	 * 'atrColor'. */
+	class LightVariant
+	{
+	public:
+		/**
+		 * @brief Where the packed lights are read from. */
+		enum Storage {
+			UNIFORM_BUFFER, 
+			TEXTURE
+		};
+
+		/**
+		 * @brief ...
+		 * @param n_dirLightsNum   - max directional lights
+		 * @param n_pointLightsNum - max point lights
+		 * @param n_spotLightsNum  - max spot lights
+		 * @param n_specular       - ...
+		 * @param n_vertexColor    - ...
+		 * @param n_storage        - ... */
+		inline LightVariant(unsigned n_dirLightsNum = 
+					LIGHT_DFT_MAX_DIR_LIGHTS, 
+				unsigned n_pointLightsNum = LIGHT_DFT_MAX_POINT_LIGHTS, 
+				unsigned n_spotLightsNum = LIGHT_DFT_MAX_SPOT_LIGHTS, 
+				bool n_specular = true, 
+				bool n_vertexColor = true, 
+				Storage n_storage = UNIFORM_BUFFER)
+			: dirLightsNum(n_dirLightsNum)
+			, pointLightsNum(n_pointLightsNum)
+			, spotLightsNum(n_spotLightsNum)
+			, specular(n_specular)
+			, vertexColor(n_vertexColor)
+			, storage(n_storage)
+		{}
+
+		/**
+		 * @brief Ordering for std::map.
+		 * @param other - ...
+		 * @return ... */
+		bool operator<(const LightVariant &other) const;
+
+		/**
+		 * @brief ...
+		 * @return number of vec4 texels for the packed lights */
+		size_t texelsNum() const;
+
+		/**
+		 * @brief ...
+		 * @return LIGHT_FRAGMENT_SOURCE_TEMPLATE instance and the light
+		 * storage module */
+		std::vector<std::string> fragmentModules() const;
+
+
+		unsigned dirLightsNum;
+		unsigned pointLightsNum;
+		unsigned spotLightsNum;
+		bool specular;
+		bool vertexColor;
+		Storage storage;
+	};
+
+	/**
+	 * @brief Lazily compiled lighting shaders, one per LightVariant.
+	 * @class ...
+	 *
+	 * Light numbers are rounded up to 0, 1, 2, 4, 8 and so on, so that a
+	 * scene with one light does not pay for 16 in every fragment, while
+	 * the number of compiled variants stays small. */
+	class LightVariants
+	{
+	public:
+		/**
+		 * @brief ...
+		 * @param instanced - use INSTANCED_LIGHT_VERTEX_SOURCE instead of
+		 * LIGHT_VERTEX_SOURCE */
+		LightVariants(bool instanced = false);
+
+		/**
+		 * @brief Smallest variant, which covers the required one.
+		 * @param required - active light numbers and features
+		 * @return compiled on the first request, with the light storage
+		 * bound to LIGHT_BUFFER_BINDING or LIGHT_TEXTURE_UNIT
+		 * @throws if the variant does not compile */
+		Ptr get(const LightVariant &required);
+
+		/**
+		 * @brief Variant, which get() compiles for the required one.
+		 * @param required - ...
+		 * @return light numbers rounded up */
+		static LightVariant covering(const LightVariant &required);
+
+		/**
+		 * @brief ...
+		 * @return number of compiled variants */
+		inline size_t size() const
+		{ return m_shaders.size(); }
+
+	private:
+		bool m_instanced;
+		std::map<LightVariant, Ptr> m_shaders;
+	};
+
+
 	/**
 	 * @brief ...
 	 * @param vertexSource   - ...
@@ -292,11 +703,24 @@ public:
 	Shader3D(const std::string &vertexSource = DFT_VERTEX_SOURCE, 
 			const std::string &fragmentSource = DFT_FRAGMENT_SOURCE);
 
+	/**
+	 * @brief ...
+	 * @param vertexModules   - see Shader
+	 * @param fragmentModules - see Shader */
+	Shader3D(const std::vector<std::string> &vertexModules, 
+			const std::vector<std::string> &fragmentModules);
+
 	/**
 	 * @brief ...
 	 * @return ... */
 	const VertexBuffer3D::AttrIndices &getAttrIndices() const;
 
+	/**
+	 * @brief 'unfTransform' uniform, invalid if the shader has none.
+	 * @return ... */
+	inline const UniformHandle<Matrix4F> &transformUniform() const
+	{ return m_transformUniform; }
+
 private:
 	/**
 	 * @brief ...
@@ -307,6 +731,7 @@ private:
 
 
 	VertexBuffer3D::AttrIndices m_attrIndices;
+	UniformHandle<Matrix4F> m_transformUniform;
 };
 
 } /* namespace ATD */
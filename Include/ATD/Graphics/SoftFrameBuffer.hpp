@@ -0,0 +1,232 @@
+/**
+ * @file      
+ * @brief     Software rasterizer, drawing into an Image.
+ * @details   ...
+ * @author    ArthurTheDigital (arthurthedigital@gmail.com)
+ * @copyright GPL v3.
+ * @since     $Id: $ */
+
+#pragma once
+
+#include <ATD/Core/Transform2D.hpp>
+#include <ATD/Core/Transform3D.hpp>
+#include <ATD/Graphics/Image.hpp>
+#include <ATD/Graphics/Vertex2D.hpp>
+#include <ATD/Graphics/Vertex3D.hpp>
+#include <ATD/Graphics/VertexBuffer2D.hpp>
+#include <ATD/Graphics/VertexBuffer3D.hpp>
+
+#include <memory>
+#include <vector>
+
+
+namespace ATD {
+
+/**
+ * @brief CPU counterpart of FrameBuffer, which does not require OpenGL.
+ * @class ...
+ *
+ * Vertices are transformed the same way as FrameBuffer does with the 
+ * default shaders (Projection2D/Projection3D and the draw transform), and 
+ * the fragment color is texture * vertex color, so the image matches 
+ * FrameBuffer::getColorTexture()->getImage() (rows go bottom-up, like in 
+ * OpenGL).
+ *
+ * Draws are deferred: the triangles are binned into screen tiles, which 
+ * are rasterized by several threads on flush() (or image()). Texture 
+ * images are sampled with NEAREST filter and REPEAT wrap (Texture 
+ * defaults). */
+class SoftFrameBuffer
+{
+public:
+	typedef std::shared_ptr<SoftFrameBuffer> Ptr;
+	typedef std::shared_ptr<const SoftFrameBuffer> CPtr;
+
+	/**
+	 * @brief How the fragments are written. */
+	enum Blend {
+		REPLACE, /* As Shader2D::PLAIN_FRAGMENT_SOURCE. */
+		ALPHA    /* As Shader2D::ALPHA_FRAGMENT_SOURCE. */
+	};
+
+	/* Tile side in pixels. */
+	static const size_t TILE_SIZE;
+
+
+	/**
+	 * @brief ...
+	 * @param size       - ...
+	 * @param hasDepth   - depth test for 3D draws
+	 * @param threadsNum - 0 for the number of hardware threads */
+	SoftFrameBuffer(const Vector2S &size, 
+			bool hasDepth = true, 
+			size_t threadsNum = 0);
+
+	/**
+	 * @brief ...
+	 * @return ... */
+	inline const Vector2S &size() const
+	{ return m_size; }
+
+	/**
+	 * @brief ...
+	 * @return aspect ratio - width, divided by height */
+	double aspectRatio() const;
+
+	/**
+	 * @brief ...
+	 * @param projection2D - ... */
+	void setProjection2D(const Projection2D &projection2D);
+
+	/**
+	 * @brief ...
+	 * @param projection3D - ... */
+	void setProjection3D(const Projection3D &projection3D);
+
+	/**
+	 * @brief ...
+	 * @return ... */
+	inline const Projection3D &projection3D() const
+	{ return m_projection3D; }
+
+	/**
+	 * @brief Blend mode for the following draws.
+	 * @param blend - ... */
+	inline void setBlend(const Blend &blend)
+	{ m_blend = blend; }
+
+	/**
+	 * @brief Drop the pending draws, fill the color and the depth.
+	 * @param color - ... */
+	void clear(const Pixel &color = Pixel(0x00, 0x00, 0x00, 0x00));
+
+	/**
+	 * @brief ...
+	 * @param glVertices - positions in pixels, as for VertexBuffer2D
+	 * @param texturePtr - nullptr for vertex color only
+	 * @param transform  - ...
+	 * @param primitive  - ... */
+	void draw(const std::vector<Vertex2D::GlVertex> &glVertices, 
+			const Image::CPtr &texturePtr, 
+			const Transform2D &transform = Transform2D(), 
+			const VertexBuffer2D::Primitive &primitive = 
+				VertexBuffer2D::TRIANGLES);
+
+	/**
+	 * @brief ...
+	 * @param builder    - ...
+	 * @param texturePtr - of builder.textureSize()
+	 * @param transform  - ... */
+	void draw(const VertexBuffer2D::Builder &builder, 
+			const Image::CPtr &texturePtr, 
+			const Transform2D &transform = Transform2D());
+
+	/**
+	 * @brief Depth-tested, if the buffer has depth.
+	 * @param glVertices - ...
+	 * @param texturePtr - nullptr for vertex color only
+	 * @param transform  - ...
+	 * @param primitive  - ... */
+	void draw(const std::vector<Vertex3D::GlVertex> &glVertices, 
+			const Image::CPtr &texturePtr, 
+			const Transform3D &transform = Transform3D(), 
+			const VertexBuffer3D::Primitive &primitive = 
+				VertexBuffer3D::TRIANGLES);
+
+	/**
+	 * @brief Rasterize the pending draws. */
+	void flush();
+
+	/**
+	 * @brief Flushes the pending draws.
+	 * @return ... */
+	const Image &image();
+
+private:
+	/**
+	 * @brief Vertex in screen space, attributes are divided by W.
+	 * @class ... */
+	class RasterVertex
+	{
+	public:
+		float x;
+		float y;
+		float z;
+		float invW;
+		float u;
+		float v;
+		float color[4];
+	};
+
+	/**
+	 * @brief ...
+	 * @class ... */
+	class Triangle
+	{
+	public:
+		RasterVertex vertices[3];
+		size_t drawIndex;
+	};
+
+	/**
+	 * @brief ...
+	 * @class ... */
+	class Draw
+	{
+	public:
+		Image::CPtr texturePtr;
+		Blend blend;
+		bool isDepthTested;
+	};
+
+	/**
+	 * @brief Clip, project and queue a triangle.
+	 * @param clipPositions - after projection, before division by W
+	 * @param texCoords     - ...
+	 * @param colors        - ... */
+	void addTriangle(const Vector4F (&clipPositions)[3], 
+			const Vector2F (&texCoords)[3], 
+			const Vector4F (&colors)[3]);
+
+	/**
+	 * @brief ...
+	 * @param clipPosition - ...
+	 * @param texCoords    - ...
+	 * @param color        - ...
+	 * @return ... */
+	RasterVertex rasterVertex(const Vector4F &clipPosition, 
+			const Vector2F &texCoords, 
+			const Vector4F &color) const;
+
+	/**
+	 * @brief Rasterize the binned triangles, which overlap the tile.
+	 * @param tileIndex   - ...
+	 * @param triangleIds - in the order of drawing */
+	void rasterizeTile(size_t tileIndex, 
+			const std::vector<size_t> &triangleIds);
+
+	/**
+	 * @brief ...
+	 * @param triangle - ...
+	 * @param tile     - clipping rectangle */
+	void rasterizeTriangle(const Triangle &triangle, const RectL &tile);
+
+
+	Vector2S m_size;
+	bool m_hasDepth;
+	size_t m_threadsNum;
+
+	Projection2D m_projection2D;
+	Projection3D m_projection3D;
+	Blend m_blend;
+
+	Image m_image;
+	std::vector<float> m_depth;
+
+	std::vector<Draw> m_draws;
+	std::vector<Triangle> m_triangles;
+};
+
+} /* namespace ATD */
+
+
@@ -8,10 +8,12 @@
 
 #pragma once
 
+#include <ATD/Core/Rectangle.hpp>
 #include <ATD/Graphics/Gl.hpp>
 #include <ATD/Graphics/Image.hpp>
 
 #include <memory>
+#include <vector>
 
 
 namespace ATD {
@@ -39,6 +41,21 @@ public:
 		CUBE_MAP
 	};
 
+	/**
+	 * @brief Texel filtering. */
+	enum Filter {
+		NEAREST, 
+		LINEAR
+	};
+
+	/**
+	 * @brief Texture coordinates outside of [0, 1]. */
+	enum Wrap {
+		CLAMP_TO_EDGE, 
+		REPEAT, 
+		MIRRORED_REPEAT
+	};
+
 	/**
 	 * @brief ... */
 	enum Unit {
@@ -75,6 +92,58 @@ public:
 		bool m_activated;
 	};
 
+	/**
+	 * @brief Reads textures back without waiting for the GPU.
+	 * @class ...
+	 *
+	 * Each request() starts a transfer into one of a ring of pixel 
+	 * buffers and puts a fence after it. poll() returns the oldest 
+	 * requested image as soon as its fence is signaled (usually a frame 
+	 * or two later). */
+	class Readback
+	{
+	public:
+		typedef std::shared_ptr<Readback> Ptr;
+
+		/**
+		 * @brief ...
+		 * @param buffersNum - max number of pending requests */
+		Readback(size_t buffersNum = 2);
+
+		/**
+		 * @brief ... */
+		~Readback();
+
+		/**
+		 * @brief Start reading the texture.
+		 * @param texture - ...
+		 * @return false if all the buffers are pending */
+		bool request(const Texture &texture);
+
+		/**
+		 * @brief Take the oldest requested image, if it is ready.
+		 * @return nullptr if nothing is ready yet */
+		Image::Ptr poll();
+
+		/**
+		 * @brief ...
+		 * @return ... */
+		inline size_t pendingNum() const
+		{ return m_pendingNum; }
+
+	private:
+		struct Slot
+		{
+			Gl::Uint buffer;
+			Gl::Sync fence;
+			Vector2S size;
+		};
+
+		std::vector<Slot> m_slots;
+		size_t m_head;
+		size_t m_pendingNum;
+	};
+
 	/**
 	 * @brief ...
 	 * @param image - ...
@@ -95,7 +164,13 @@ public:
 			const Data &data = COLOR, 
 			const Type &type = TEX_2D);
 
-	/* TODO: Copy constructor. */
+	/**
+	 * @brief Copy on GPU.
+	 * @param other - ...
+	 *
+	 * Filters and mipmaps (if any) are copied too. Wrap and anisotropy 
+	 * are left default. */
+	Texture(const Texture &other);
 
 	/**
 	 * @brief ... */
@@ -120,15 +195,108 @@ public:
 	{ return m_size; }
 
 	/**
-	 * @brief Copy the texture to image.
+	 * @brief ...
+	 * @return ... */
+	inline const Filter &minFilter() const
+	{ return m_minFilter; }
+
+	/**
+	 * @brief ...
 	 * @return ... */
+	inline const Filter &magFilter() const
+	{ return m_magFilter; }
+
+	/**
+	 * @brief ...
+	 * @return ... */
+	inline bool hasMipmaps() const
+	{ return m_hasMipmaps; }
+
+	/**
+	 * @brief ...
+	 * @param minFilter - used, when the texture is minified
+	 * @param magFilter - used, when the texture is magnified
+	 *
+	 * With mipmaps, minFilter is applied both within a mipmap level and 
+	 * between the levels (NEAREST_MIPMAP_NEAREST or LINEAR_MIPMAP_LINEAR). */
+	void setFilter(const Filter &minFilter, const Filter &magFilter);
+
+	/**
+	 * @brief ...
+	 * @param wrapS - ...
+	 * @param wrapT - ... */
+	void setWrap(const Wrap &wrapS, const Wrap &wrapT);
+
+	/**
+	 * @brief Set anisotropic filtering, if supported by the driver.
+	 * @param anisotropy - max samples per texel, 1.f to disable
+	 * @return applied anisotropy (clamped by the driver maximum, 1.f if 
+	 * anisotropic filtering is not supported) */
+	float setAnisotropy(float anisotropy);
+
+	/**
+	 * @brief Generate mipmaps from level 0 on GPU. */
+	void generateMipmaps();
+
+	/**
+	 * @brief Generate mipmaps from image on CPU (box filter).
+	 * @param image - same image, as the one at level 0
+	 * @throws ...
+	 *
+	 * For drivers, where glGenerateMipmap is slow or broken. */
+	void generateMipmaps(const Image &image);
+
+	/**
+	 * @brief Copy the texture to image.
+	 * @return ...
+	 *
+	 * Waits for the GPU to finish drawing, see Readback to avoid that. */
 	Image::Ptr getImage() const;
 
+	/**
+	 * @brief Upload a part of the image into the texture.
+	 * @param image  - source, placed at the texture origin
+	 * @param region - part to upload (same in image and texture coords)
+	 *
+	 * Region is clipped by both image and texture bounds. The call 
+	 * returns, when the driver has copied the pixels. */
+	void update(const Image &image, const RectL &region);
+
+	/**
+	 * @brief Same as update(), but does not wait for the driver.
+	 * @param image  - ...
+	 * @param region - ...
+	 *
+	 * The region is copied into one of a ring of pixel buffers, which is 
+	 * then transferred to the texture asynchronously. The pixel buffers 
+	 * are created on the first call. */
+	void updateAsync(const Image &image, const RectL &region);
+
+	/**
+	 * @brief Copy a region between textures on GPU (framebuffer blit).
+	 * @param src     - ...
+	 * @param srcRect - region of src to copy
+	 * @param dst     - ...
+	 * @param dstPos  - where srcRect origin goes in dst
+	 * @throws ...
+	 *
+	 * Both textures shall be TEX_2D and hold the same data. The region 
+	 * is clipped by both textures bounds. */
+	static void copy(const Texture &src, 
+			const RectL &srcRect, 
+			Texture &dst, 
+			const Vector2L &dstPos);
+
 private:
 	Gl::Uint m_texture;
 	Data m_data;
 	Type m_type;
 	Vector2S m_size;
+	Filter m_minFilter;
+	Filter m_magFilter;
+	bool m_hasMipmaps;
+	std::vector<Gl::Uint> m_pixelBuffers;
+	size_t m_pixelBufferIndex;
 };
 
 } /* namespace ATD */
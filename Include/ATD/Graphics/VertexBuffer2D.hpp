@@ -10,8 +10,12 @@
 
 #include <ATD/Core/Rectangle.hpp>
 #include <ATD/Graphics/Gl.hpp>
+#include <ATD/Graphics/IndexBuffer.hpp>
+#include <ATD/Graphics/InstanceBuffer2D.hpp>
 #include <ATD/Graphics/Vertex2D.hpp>
+#include <ATD/Graphics/VertexLayout.hpp>
 
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -44,6 +48,95 @@ public:
 		bool m_activated;
 	};
 
+	/**
+	 * @brief Collects GL vertices for a buffer, without intermediate 
+	 * Vertex2D lists.
+	 * @class ...
+	 *
+	 * Texture coordinates are given in texture pixels and normalized right 
+	 * away. Storage is reserved once, so filling it up to the capacity 
+	 * does not allocate. */
+	class Builder
+	{
+	public:
+		/**
+		 * @brief ...
+		 * @param textureSize - ...
+		 * @param capacity    - number of vertices to reserve */
+		Builder(const Vector2S &textureSize, size_t capacity = 0);
+
+		/**
+		 * @brief ...
+		 * @param capacity - number of vertices */
+		void reserve(size_t capacity);
+
+		/**
+		 * @brief Keeps the reserved storage. */
+		void clear();
+
+		/**
+		 * @brief Drop the vertices, starting from the given one.
+		 * @param size - number of vertices to keep */
+		void truncate(size_t size);
+
+		/**
+		 * @brief ...
+		 * @param v0 - ...
+		 * @param v1 - ...
+		 * @param v2 - ... */
+		void addTriangle(const Vertex2D::GlVertex &v0, 
+				const Vertex2D::GlVertex &v1, 
+				const Vertex2D::GlVertex &v2);
+
+		/**
+		 * @brief Two triangles.
+		 * @param topLeft     - ...
+		 * @param topRight    - ...
+		 * @param bottomRight - ...
+		 * @param bottomLeft  - ... */
+		void addQuad(const Vertex2D::GlVertex &topLeft, 
+				const Vertex2D::GlVertex &topRight, 
+				const Vertex2D::GlVertex &bottomRight, 
+				const Vertex2D::GlVertex &bottomLeft);
+
+		/**
+		 * @brief Append already built vertices.
+		 * @param glVertices - ... */
+		void append(const std::vector<Vertex2D::GlVertex> &glVertices);
+
+		/**
+		 * @brief Textured rectangle of the texture bounds size.
+		 * @param position      - top left corner, in pixels
+		 * @param textureBounds - ...
+		 * @param color         - ... */
+		void addRect(const Vector2F &position, 
+				const RectL &textureBounds, 
+				const Pixel &color = Pixel(0xFF, 0xFF, 0xFF));
+
+		/**
+		 * @brief ...
+		 * @return ... */
+		inline const Vector2S &textureSize() const
+		{ return m_textureSize; }
+
+		/**
+		 * @brief ...
+		 * @return ... */
+		inline const std::vector<Vertex2D::GlVertex> &glVertices() const
+		{ return m_glVertices; }
+
+	private:
+		/**
+		 * @brief Same, as Vertex2D::glVertex().
+		 * @param texCoords - in texture pixels
+		 * @return ... */
+		Vector2F glTexCoords(const Vector2L &texCoords) const;
+
+
+		Vector2S m_textureSize;
+		std::vector<Vertex2D::GlVertex> m_glVertices;
+	};
+
 	typedef std::shared_ptr<VertexBuffer2D> Ptr;
 	typedef std::shared_ptr<const VertexBuffer2D> CPtr;
 
@@ -62,9 +155,19 @@ public:
 		Gl::Uint positionIndex = 0;
 		Gl::Uint texCoordsIndex = 0;
 		Gl::Uint colorIndex = 0;
+		Gl::Uint instanceTransformIndex = 0;
+		Gl::Uint instanceColorIndex = 0;
 
 		bool texCoordsAreRequired = false;
 		bool colorIsRequired = false;
+		bool instanceTransformIsRequired = false;
+		bool instanceColorIsRequired = false;
+
+		/**
+		 * @brief Order for caching vertex arrays per attribute layout.
+		 * @param other - ...
+		 * @return ... */
+		bool operator<(const AttrIndices &other) const;
 	};
 
 
@@ -88,17 +191,41 @@ public:
 	 * @brief ...
 	 * @param vertices    - ...
 	 * @param textureSize - ...
-	 * @param primitive   - ... */
+	 * @param primitive   - ...
+	 * @param layout      - ... */
 	VertexBuffer2D(const std::vector<Vertex2D> &vertices, 
 			const Vector2S &textureSize, 
-			const Primitive &primitive = TRIANGLES);
+			const Primitive &primitive = TRIANGLES, 
+			const VertexLayout &layout = VertexLayout());
 
 	/**
 	 * @brief ...
 	 * @param glVertices - ...
-	 * @param primitive  - ... */
+	 * @param primitive  - ...
+	 * @param layout     - ... */
+	VertexBuffer2D(const std::vector<Vertex2D::GlVertex> &glVertices, 
+			const Primitive &primitive = TRIANGLES, 
+			const VertexLayout &layout = VertexLayout());
+
+	/**
+	 * @brief ...
+	 * @param builder   - ...
+	 * @param primitive - ...
+	 * @param layout    - ... */
+	VertexBuffer2D(const Builder &builder, 
+			const Primitive &primitive = TRIANGLES, 
+			const VertexLayout &layout = VertexLayout());
+
+	/**
+	 * @brief Indexed buffer.
+	 * @param glVertices     - ...
+	 * @param indexBufferPtr - indices into glVertices
+	 * @param primitive      - ...
+	 * @param layout         - ... */
 	VertexBuffer2D(const std::vector<Vertex2D::GlVertex> &glVertices, 
-			const Primitive &primitive = TRIANGLES);
+			const IndexBuffer::CPtr &indexBufferPtr, 
+			const Primitive &primitive = TRIANGLES, 
+			const VertexLayout &layout = VertexLayout());
 
 	// TODO: Copy constructor
 
@@ -124,6 +251,29 @@ public:
 	inline const Primitive &primitive() const
 	{ return m_primitive; }
 
+	/**
+	 * @brief ...
+	 * @return nullptr for non-indexed buffer */
+	inline IndexBuffer::CPtr indexBufferPtr() const
+	{ return m_indexBufferPtr; }
+
+	/**
+	 * @brief ...
+	 * @return ... */
+	inline const VertexLayout &layout() const
+	{ return m_layout; }
+
+	/**
+	 * @brief Replace the vertices of a non-indexed buffer.
+	 * @param glVertices - ...
+	 * @param first      - first changed vertex, the ones before are kept
+	 *
+	 * The buffer storage is reused while the vertices fit, otherwise it 
+	 * grows geometrically, so frequently changed buffers (like PxText) 
+	 * are not recreated. */
+	void update(const std::vector<Vertex2D::GlVertex> &glVertices, 
+			size_t first = 0);
+
 	/**
 	 * @brief Draw vertices using current OpenGL texture and shader.
 	 * @param attrIndices - indices of attributes to be passed
@@ -132,10 +282,37 @@ public:
 	 * calling this function. */
 	void drawSelfInternal(const AttrIndices &attrIndices) const;
 
+	/**
+	 * @brief Draw vertices once per each of the instances.
+	 * @param attrIndices - ...
+	 * @param instances   - ...
+	 * @throws ...
+	 *
+	 * Same as above, but the shader must have instance attributes. */
+	void drawSelfInternal(const AttrIndices &attrIndices, 
+			const InstanceBuffer2D &instances) const;
+
 private:
+	/**
+	 * @brief Fill the buffer, packing the vertices if the layout requires.
+	 * @param glVertices - ... */
+	void upload(const std::vector<Vertex2D::GlVertex> &glVertices);
+
+	/**
+	 * @brief Vertex array object, set up for the given attribute layout.
+	 * @param attrIndices - ...
+	 * @return ...
+	 *
+	 * Created on the first request and cached afterwards. */
+	Gl::Uint vertexArrayId(const AttrIndices &attrIndices) const;
+
 	Gl::Uint m_bufferId;
 	size_t m_size;
+	size_t m_capacity;
 	Primitive m_primitive;
+	IndexBuffer::CPtr m_indexBufferPtr;
+	VertexLayout m_layout;
+	mutable std::map<AttrIndices, Gl::Uint> m_vertexArrayIds;
 };
 
 } /* namespace ATD */
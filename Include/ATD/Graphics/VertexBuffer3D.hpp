@@ -9,8 +9,12 @@
 #pragma once
 
 #include <ATD/Graphics/Gl.hpp>
+#include <ATD/Graphics/IndexBuffer.hpp>
+#include <ATD/Graphics/InstanceBuffer3D.hpp>
 #include <ATD/Graphics/Vertex3D.hpp>
+#include <ATD/Graphics/VertexLayout.hpp>
 
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -54,6 +58,13 @@ public:
 		TRIANGLE_FAN
 	};
 
+	/**
+	 * @brief How to build indices from a Vertex3D list. */
+	enum Indexing {
+		DEDUPLICATE, 
+		DEDUPLICATE_CACHE_OPTIMIZED
+	};
+
 	/**
 	 * @brief describes attributes to pass while drawing */
 	struct AttrIndices
@@ -62,10 +73,20 @@ public:
 		Gl::Uint texCoordsIndex = 0;
 		Gl::Uint normalIndex = 0;
 		Gl::Uint colorIndex = 0;
+		Gl::Uint instanceTransformIndex = 0;
+		Gl::Uint instanceColorIndex = 0;
 
 		bool texCoordsAreRequired = false;
 		bool normalIsRequired = false;
 		bool colorIsRequired = false;
+		bool instanceTransformIsRequired = false;
+		bool instanceColorIsRequired = false;
+
+		/**
+		 * @brief Order for caching vertex arrays per attribute layout.
+		 * @param other - ...
+		 * @return ... */
+		bool operator<(const AttrIndices &other) const;
 	};
 
 
@@ -80,17 +101,47 @@ public:
 	 * @brief ...
 	 * @param vertices    - ...
 	 * @param textureSize - ...
-	 * @param primitive   - ... */
+	 * @param primitive   - ...
+	 * @param layout      - ... */
+	VertexBuffer3D(const std::vector<Vertex3D> &vertices, 
+			const Vector2S &textureSize, 
+			const Primitive &primitive = TRIANGLES, 
+			const VertexLayout &layout = VertexLayout());
+
+	/**
+	 * @brief Indexed buffer with identical vertices merged.
+	 * @param vertices    - ...
+	 * @param textureSize - ...
+	 * @param primitive   - ...
+	 * @param indexing    - ...
+	 * @param layout      - ...
+	 *
+	 * Cache optimization is applied to TRIANGLES primitive only. */
 	VertexBuffer3D(const std::vector<Vertex3D> &vertices, 
 			const Vector2S &textureSize, 
-			const Primitive &primitive = TRIANGLES);
+			const Primitive &primitive, 
+			const Indexing &indexing, 
+			const VertexLayout &layout = VertexLayout());
 
 	/**
 	 * @brief ...
 	 * @param glVertices - ...
-	 * @param primitive  - ... */
+	 * @param primitive  - ...
+	 * @param layout     - ... */
 	VertexBuffer3D(const std::vector<Vertex3D::GlVertex> &glVertices, 
-			const Primitive &primitive = TRIANGLES);
+			const Primitive &primitive = TRIANGLES, 
+			const VertexLayout &layout = VertexLayout());
+
+	/**
+	 * @brief Indexed buffer.
+	 * @param glVertices     - ...
+	 * @param indexBufferPtr - indices into glVertices
+	 * @param primitive      - ...
+	 * @param layout         - ... */
+	VertexBuffer3D(const std::vector<Vertex3D::GlVertex> &glVertices, 
+			const IndexBuffer::CPtr &indexBufferPtr, 
+			const Primitive &primitive = TRIANGLES, 
+			const VertexLayout &layout = VertexLayout());
 
 	/**
 	 * @brief ... */
@@ -114,6 +165,18 @@ public:
 	inline const Primitive &primitive() const
 	{ return m_primitive; }
 
+	/**
+	 * @brief ...
+	 * @return nullptr for non-indexed buffer */
+	inline IndexBuffer::CPtr indexBufferPtr() const
+	{ return m_indexBufferPtr; }
+
+	/**
+	 * @brief ...
+	 * @return ... */
+	inline const VertexLayout &layout() const
+	{ return m_layout; }
+
 	/**
 	 * @brief Draw vertices using current OpenGL texture and shader.
 	 * @param attrIndices - ...
@@ -122,10 +185,36 @@ public:
 	 * calling this function. */
 	void drawSelfInternal(const AttrIndices &attrIndices) const;
 
+	/**
+	 * @brief Draw vertices once per each of the instances.
+	 * @param attrIndices - ...
+	 * @param instances   - ...
+	 * @throws ...
+	 *
+	 * Same as above, but the shader must have instance attributes. */
+	void drawSelfInternal(const AttrIndices &attrIndices, 
+			const InstanceBuffer3D &instances) const;
+
 private:
+	/**
+	 * @brief Fill the buffer, packing the vertices if the layout requires.
+	 * @param glVertices - ... */
+	void upload(const std::vector<Vertex3D::GlVertex> &glVertices);
+
+	/**
+	 * @brief Vertex array object, set up for the given attribute layout.
+	 * @param attrIndices - ...
+	 * @return ...
+	 *
+	 * Created on the first request and cached afterwards. */
+	Gl::Uint vertexArrayId(const AttrIndices &attrIndices) const;
+
 	Gl::Uint m_bufferId;
 	size_t m_size;
 	Primitive m_primitive;
+	IndexBuffer::CPtr m_indexBufferPtr;
+	VertexLayout m_layout;
+	mutable std::map<AttrIndices, Gl::Uint> m_vertexArrayIds;
 };
 
 } /* namespace ATD */
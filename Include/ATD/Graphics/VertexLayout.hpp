@@ -0,0 +1,141 @@
+/**
+ * @file      
+ * @brief     Packed vertex formats for vertex buffers.
+ * @details   ...
+ * @author    ArthurTheDigital (arthurthedigital@gmail.com)
+ * @copyright GPL v3.
+ * @since     $Id: $ */
+
+#pragma once
+
+#include <ATD/Graphics/Gl.hpp>
+#include <ATD/Graphics/Vertex2D.hpp>
+#include <ATD/Graphics/Vertex3D.hpp>
+
+#include <stdint.h>
+
+#include <vector>
+
+
+namespace ATD {
+
+/**
+ * @brief How vertex attributes are stored in a vertex buffer.
+ * @class ...
+ *
+ * Position is always stored as floats. The packed formats are normalized
+ * by OpenGL while fetching, so the shaders see the same vec2/vec3/vec4
+ * attributes regardless of the layout.
+ *
+ * Default layout is the same, as Vertex2D::GlVertex and
+ * Vertex3D::GlVertex (32 and 48 bytes), COMPACT takes 16 and 24 bytes. */
+class VertexLayout
+{
+public:
+	/**
+	 * @brief ... */
+	enum TexCoords {
+		TEX_COORDS_FLOAT, 
+		TEX_COORDS_HALF_FLOAT, 
+		TEX_COORDS_UNORM16 /* [0, 1] only, no repeat. */
+	};
+
+	/**
+	 * @brief ... */
+	enum Normal {
+		NORMAL_FLOAT, 
+		NORMAL_INT_2_10_10_10_REV, 
+		NORMAL_SNORM16
+	};
+
+	/**
+	 * @brief ... */
+	enum Color {
+		COLOR_FLOAT, 
+		COLOR_UNORM8
+	};
+
+	/**
+	 * @brief Arguments for glVertexAttribPointer(). */
+	struct Attribute
+	{
+		Gl::Int size;
+		Gl::Enum type;
+		Gl::Boolean normalized;
+		size_t offset;
+	};
+
+	/* Half-float texture coordinates, 2_10_10_10 normals and 8-bit color. */
+	static const VertexLayout COMPACT;
+
+
+	/**
+	 * @brief ...
+	 * @param n_texCoords - ...
+	 * @param n_normal    - ...
+	 * @param n_color     - ... */
+	inline VertexLayout(TexCoords n_texCoords = TEX_COORDS_FLOAT, 
+			Normal n_normal = NORMAL_FLOAT, 
+			Color n_color = COLOR_FLOAT)
+		: texCoords(n_texCoords)
+		, normal(n_normal)
+		, color(n_color)
+	{}
+
+	/**
+	 * @brief ...
+	 * @return true if the data is the same, as GlVertex */
+	bool isFloat() const;
+
+	/**
+	 * @brief ...
+	 * @param is3D - Vertex3D (with normal) or Vertex2D
+	 * @return bytes per vertex */
+	size_t stride(bool is3D) const;
+
+	/**
+	 * @brief ...
+	 * @param is3D - ...
+	 * @return ... */
+	Attribute positionAttribute(bool is3D) const;
+
+	/**
+	 * @brief ...
+	 * @param is3D - ...
+	 * @return ... */
+	Attribute texCoordsAttribute(bool is3D) const;
+
+	/**
+	 * @brief Vertex3D only.
+	 * @return ... */
+	Attribute normalAttribute() const;
+
+	/**
+	 * @brief ...
+	 * @param is3D - ...
+	 * @return ... */
+	Attribute colorAttribute(bool is3D) const;
+
+	/**
+	 * @brief ...
+	 * @param glVertices - ...
+	 * @return stride(false) bytes per vertex */
+	std::vector<uint8_t> packed(
+			const std::vector<Vertex2D::GlVertex> &glVertices) const;
+
+	/**
+	 * @brief ...
+	 * @param glVertices - ...
+	 * @return stride(true) bytes per vertex */
+	std::vector<uint8_t> packed(
+			const std::vector<Vertex3D::GlVertex> &glVertices) const;
+
+
+	TexCoords texCoords;
+	Normal normal;
+	Color color;
+};
+
+} /* namespace ATD */
+
+
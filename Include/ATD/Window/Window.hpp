@@ -13,8 +13,12 @@
 
 #include <string.h>
 
+#include <atomic>
+#include <exception>
+#include <functional>
 #include <list>
 #include <map>
+#include <memory>
 #include <mutex>
 
 
@@ -111,6 +115,86 @@ public:
 		Window *m_window;
 	};
 
+	/* Custom drawing into the window FrameBuffer. */
+	typedef std::function<void(FrameBuffer &)> DrawFunc;
+
+	/* Code, that requires the window GL context. */
+	typedef std::function<void()> GlFunc;
+
+	/**
+	 * @brief State of a load() call, shared with the loader thread.
+	 * @class ... */
+	class LoadJob
+	{
+	public:
+		typedef std::function<std::shared_ptr<void>()> LoadFunc;
+
+
+		/**
+		 * @brief ...
+		 * @param n_loadFunc - ... */
+		inline LoadJob(const LoadFunc &n_loadFunc)
+			: loadFunc(n_loadFunc)
+			, resourcePtr()
+			, errorPtr()
+			, isReady(false)
+		{}
+
+
+		LoadFunc loadFunc; /* Released, when ready. */
+		std::shared_ptr<void> resourcePtr;
+		std::exception_ptr errorPtr;
+		std::atomic<bool> isReady; /* Set last, the rest is read after it. */
+	};
+
+	/**
+	 * @brief Resource, being created on the loader thread.
+	 * @class ...
+	 *
+	 * Becomes ready only after the loader context fence is signaled, so 
+	 * the resource may be drawn right away. */
+	template <class T>
+	class Loading
+	{
+	public:
+		/**
+		 * @brief Nothing being loaded. */
+		inline Loading()
+			: m_jobPtr()
+		{}
+
+		/**
+		 * @brief ...
+		 * @param n_jobPtr - ... */
+		inline Loading(const std::shared_ptr<LoadJob> &n_jobPtr)
+			: m_jobPtr(n_jobPtr)
+		{}
+
+		/**
+		 * @brief ...
+		 * @return true, if created (or failed) */
+		inline bool isReady() const
+		{ return m_jobPtr && m_jobPtr->isReady.load(); }
+
+		/**
+		 * @brief ...
+		 * @return nullptr, until ready
+		 * @throws the error of the creation */
+		inline std::shared_ptr<T> get() const
+		{
+			if (!isReady()) {
+				return nullptr;
+			}
+			if (m_jobPtr->errorPtr) {
+				std::rethrow_exception(m_jobPtr->errorPtr);
+			}
+			return std::static_pointer_cast<T>(m_jobPtr->resourcePtr);
+		}
+
+	private:
+		std::shared_ptr<LoadJob> m_jobPtr;
+	};
+
 	/* @brief ...
 	 *
 	 * To avoid division by zero ;) */
@@ -136,6 +220,70 @@ public:
 	 * @brief ... */
 	virtual ~Window();
 
+	/**
+	 * @brief Move the GL context and all the GL work to a render thread.
+	 *
+	 * Then clear(), draw(), set{Shader,Projection}*() and setPostShader() 
+	 * are recorded and executed on the render thread in order. display() 
+	 * hands the recorded frame over and returns as soon as the previous 
+	 * frame is rendered, so the next frame is simulated, while the current 
+	 * one is rendered. poll() stays on the calling thread.
+	 *
+	 * Synchronization rules:
+	 * - Drawables and vertex buffers are not drawn by reference (it throws), 
+	 * since the game thread changes them, while the frame is rendered. 
+	 * Draw vertex buffers by pointer (the transform is copied) or capture 
+	 * copies of the drawn state into a DrawFunc.
+	 * - GL resources (Texture, Shader, VertexBuffer, FrameBuffer, ...) 
+	 * shall be created, updated and destroyed via invoke() or inside a 
+	 * DrawFunc. Resources, captured by the recorded commands, are released 
+	 * on the render thread.
+	 * - Errors of the render thread are rethrown by the next display() or 
+	 * invoke(). */
+	void startRenderThread();
+
+	/**
+	 * @brief Finish the frame in flight and take the GL context back to 
+	 * the calling thread. */
+	void stopRenderThread();
+
+	/**
+	 * @brief ...
+	 * @return ... */
+	inline bool hasRenderThread() const
+	{ return m_renderThread != nullptr; }
+
+	/**
+	 * @brief Call the function with the window GL context current.
+	 * @param glFunc - ...
+	 *
+	 * With a render thread, waits for the frame in flight, then the 
+	 * function is called on the render thread (before the frame being 
+	 * recorded). Otherwise it is called right away. */
+	void invoke(const GlFunc &glFunc);
+
+	/**
+	 * @brief Create a GL resource (Texture, VertexBuffer3D, Shader, ...) 
+	 * on the loader thread, with a context, shared with the window one.
+	 * @param loadFunc - creates the resource
+	 * @return handle, which gets the resource, once it is uploaded
+	 * @throws if shared contexts or fences are not supported
+	 *
+	 * The loader thread is started on the first call. The jobs are 
+	 * executed in order. Vertex arrays and frame buffers are not shared 
+	 * between contexts: they are created on the first draw, so VertexBuffer 
+	 * is fine, but FrameBuffer shall not be loaded this way. */
+	template <class T>
+	Loading<T> load(const std::function<std::shared_ptr<T>()> &loadFunc)
+	{
+		std::shared_ptr<LoadJob> jobPtr(new LoadJob(
+					[loadFunc]() -> std::shared_ptr<void> {
+						return loadFunc();
+					}));
+		pushLoadJob(jobPtr);
+		return Loading<T>(jobPtr);
+	}
+
 	/**
 	 * @brief refresh inner Event queue
 	 * @param keepEvents - whether to store the newfound events
@@ -187,24 +335,60 @@ public:
 	 * @param projection3D - ... */
 	void setProjection3D(const Projection3D &projection3D);
 
+	/**
+	 * @brief Synchronize display() with the monitor refresh.
+	 * @param interval - 1 for vsync (each refresh), 0 for no vsync, -1 for 
+	 * adaptive vsync (late frames are shown right away)
+	 * @return false, if the interval is not supported by GLX */
+	bool setSwapInterval(int interval);
+
+	/**
+	 * @brief Placement of the upscaled image, when the window size is not a 
+	 * multiple of the pixel size.
+	 * @param alignX - ...
+	 * @param alignY - ... */
+	void setAlign(const Align &alignX, const Align &alignY);
+
+	/**
+	 * @brief Shader, used by display() to draw the image into the window.
+	 * @param postShaderPtr - nullptr for the default
+	 *
+	 * By default, the image is blitted, which is the cheapest way of 
+	 * pixel-perfect upscale. */
+	void setPostShader(Shader2D::Ptr postShaderPtr);
+
 	/**
 	 * @brief ... */
 	void clear();
 
 	/**
 	 * @brief ...
-	 * @param drawable - ... */
+	 * @param drawable - ...
+	 * @throws with a render thread (see startRenderThread()) */
 	void draw(const ATD::FrameBuffer::Drawable &drawable);
 
 	/**
 	 * @brief ...
 	 * @param vertices2D - ...
-	 * @param transform  - ... */
+	 * @param transform  - ...
+	 * @throws with a render thread (see startRenderThread()) */
 	void draw(const VertexBuffer2D &vertices2D, 
 			const Transform2D &transform);
 
+	/**
+	 * @brief ...
+	 * @param vertices2DPtr - kept until the frame is rendered
+	 * @param transform     - ... */
+	void draw(const VertexBuffer2D::CPtr &vertices2DPtr, 
+			const Transform2D &transform);
+
 	/* TODO: draw(const VertexBuffer3D &); */
 
+	/**
+	 * @brief ...
+	 * @param drawFunc - called with the window FrameBuffer */
+	void draw(const DrawFunc &drawFunc);
+
 	/**
 	 * @brief ...
 	 * @return ... */
@@ -227,9 +411,27 @@ private:
 	 * @brief ... */
 	class WindowInternal;
 
+	/**
+	 * @brief ... */
+	class RenderThread;
+
+	/**
+	 * @brief ... */
+	class Loader;
+
 	/* Non-copyable. */
 	Window(const Window &other) = delete;
 
+	/**
+	 * @brief Record the command, or call it, if no render thread.
+	 * @param glFunc - ... */
+	void record(const GlFunc &glFunc);
+
+	/**
+	 * @brief Start the loader thread, if not yet, and queue the job.
+	 * @param jobPtr - ... */
+	void pushLoadJob(const std::shared_ptr<LoadJob> &jobPtr);
+
 	/* Accessible from Observer. */
 	friend void Observer::attach(Window *, uint32_t);
 	friend void Observer::detach();
@@ -237,6 +439,8 @@ private:
 
 	WindowX11 *m_x11; /* X11 data */
 	WindowInternal *m_internal; /* Internal data */
+	RenderThread *m_renderThread; /* nullptr, if drawing on the caller */
+	Loader *m_loader; /* nullptr, until the first load() */
 
 	/* Observers data. */
 	std::map<Observer *, uint32_t> m_observerPtrs;
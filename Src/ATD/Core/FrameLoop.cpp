@@ -0,0 +1,201 @@
+/**
+ * @file      
+ * @brief     Main loop driver with frame pacing.
+ * @details   ...
+ * @author    ArthurTheDigital (arthurthedigital@gmail.com)
+ * @copyright GPL v3.
+ * @since     $Id: $ */
+
+#include <ATD/Core/FrameLoop.hpp>
+
+#include <algorithm>
+#include <thread>
+
+
+/* ATD::FrameLoop constants: */
+
+const size_t ATD::FrameLoop::STATS_FRAMES_NUM = 256;
+
+const double ATD::FrameLoop::MISSED_FRAME_TIME_FRC = 1.5;
+
+const ATD::FrameLoop::Clock::duration ATD::FrameLoop::SPIN_DURATION = 
+	std::chrono::duration_cast<ATD::FrameLoop::Clock::duration>(
+			std::chrono::microseconds(2000));
+
+
+/* ATD::FrameLoop auxiliary: */
+
+static double _seconds(const ATD::FrameLoop::Clock::duration &duration)
+{
+	return std::chrono::duration_cast<std::chrono::duration<double>>(
+			duration).count();
+}
+
+static ATD::FrameLoop::Clock::duration _duration(double seconds)
+{
+	return std::chrono::duration_cast<ATD::FrameLoop::Clock::duration>(
+			std::chrono::duration<double>(seconds));
+}
+
+
+/* ATD::FrameLoop: */
+
+ATD::FrameLoop::FrameLoop(double updateRate, 
+		double renderRate, 
+		size_t maxUpdatesPerFrame)
+	: m_updateStep(1. / updateRate)
+	, m_renderPeriod(renderRate > 0. ? 
+			_duration(1. / renderRate) : Clock::duration::zero())
+	, m_maxUpdatesPerFrame(maxUpdatesPerFrame)
+	, m_isRunning(false)
+	, m_frameTimes()
+	, m_medianFrameTimes()
+	, m_framesNum(0)
+	, m_missedDeadlinesNum(0)
+	, m_droppedUpdatesNum(0)
+{
+	m_frameTimes.reserve(STATS_FRAMES_NUM);
+	m_medianFrameTimes.reserve(STATS_FRAMES_NUM);
+}
+
+void ATD::FrameLoop::run(const ATD::FrameLoop::UpdateFunc &update, 
+		const ATD::FrameLoop::RenderFunc &render)
+{
+	m_isRunning = true;
+
+	Clock::time_point frameStart = Clock::now();
+	Clock::time_point deadline = frameStart;
+	double accumulated = 0.;
+	bool isFirstFrame = true;
+
+	while (m_isRunning) {
+		Clock::time_point frameStartNew = Clock::now();
+		double frameTime = _seconds(frameStartNew - frameStart);
+		frameStart = frameStartNew;
+
+		if (!isFirstFrame) {
+			/* Without render rate, the deadline is the swap. */
+			if (m_renderPeriod == Clock::duration::zero() && 
+					isSwapMissed(frameTime)) {
+				m_missedDeadlinesNum++;
+			}
+			recordFrameTime(frameTime);
+		}
+		isFirstFrame = false;
+
+		/* Fixed-timestep updates. */
+		accumulated += frameTime;
+		size_t updatesNum = 0;
+		while (m_isRunning && accumulated >= m_updateStep) {
+			if (updatesNum == m_maxUpdatesPerFrame) {
+				/* Too far behind: drop the rest instead of catching up. */
+				m_droppedUpdatesNum += 
+					static_cast<size_t>(accumulated / m_updateStep);
+				accumulated = 0.;
+				break;
+			}
+
+			if (!update(m_updateStep)) {
+				m_isRunning = false;
+			}
+			accumulated -= m_updateStep;
+			updatesNum++;
+		}
+
+		if (!m_isRunning) {
+			break;
+		}
+
+		render(accumulated / m_updateStep);
+
+		/* Without render rate, the frames are paced by display(). */
+		if (m_renderPeriod != Clock::duration::zero()) {
+			deadline += m_renderPeriod;
+
+			Clock::time_point now = Clock::now();
+			if (now > deadline) {
+				/* Start the cadence over, instead of rushing the next 
+				 * frames to catch up. */
+				m_missedDeadlinesNum++;
+				deadline = now;
+			} else {
+				waitUntil(deadline);
+			}
+		}
+	}
+}
+
+void ATD::FrameLoop::stop()
+{
+	m_isRunning = false;
+}
+
+ATD::FrameLoop::Stats ATD::FrameLoop::stats() const
+{
+	Stats result;
+	result.framesNum = m_framesNum;
+	result.missedDeadlinesNum = m_missedDeadlinesNum;
+	result.droppedUpdatesNum = m_droppedUpdatesNum;
+
+	if (m_frameTimes.empty()) {
+		return result;
+	}
+
+	std::vector<double> frameTimes = m_frameTimes;
+	std::sort(frameTimes.begin(), frameTimes.end());
+
+	double sum = 0.;
+	for (auto &frameTime : frameTimes) {
+		sum += frameTime;
+	}
+
+	result.minFrameTime = frameTimes.front();
+	result.avgFrameTime = sum / static_cast<double>(frameTimes.size());
+	result.p99FrameTime = frameTimes[(frameTimes.size() - 1) * 99 / 100];
+	result.maxFrameTime = frameTimes.back();
+	return result;
+}
+
+void ATD::FrameLoop::waitUntil(
+		const ATD::FrameLoop::Clock::time_point &deadline)
+{
+	/* Sleep may oversleep by a scheduler tick, so it stops short. */
+	Clock::time_point sleepDeadline = deadline - SPIN_DURATION;
+	if (Clock::now() < sleepDeadline) {
+		std::this_thread::sleep_until(sleepDeadline);
+	}
+
+	while (Clock::now() < deadline) {
+		std::this_thread::yield();
+	}
+}
+
+void ATD::FrameLoop::recordFrameTime(double frameTime)
+{
+	if (m_frameTimes.size() < STATS_FRAMES_NUM) {
+		m_frameTimes.push_back(frameTime);
+	} else {
+		m_frameTimes[m_framesNum % STATS_FRAMES_NUM] = frameTime;
+	}
+	m_framesNum++;
+}
+
+bool ATD::FrameLoop::isSwapMissed(double frameTime)
+{
+	/* The swap period is not known yet. */
+	if (m_frameTimes.size() < STATS_FRAMES_NUM / 4) {
+		return false;
+	}
+
+	/* A missed swap makes the frame a multiple of the period, so the 
+	 * median stays the period, unless most of the frames are missed. */
+	m_medianFrameTimes.assign(m_frameTimes.begin(), m_frameTimes.end());
+	auto medianIter = m_medianFrameTimes.begin() + 
+		m_medianFrameTimes.size() / 2;
+	std::nth_element(m_medianFrameTimes.begin(), medianIter, 
+			m_medianFrameTimes.end());
+
+	return frameTime > *medianIter * MISSED_FRAME_TIME_FRC;
+}
+
+
@@ -533,7 +533,7 @@ void ATD::Fs::Path::mkDir() const
 
 	/* Because, the last added path exists */
 	for (auto pcRIter = pathCache.rbegin() + 1; pcRIter != pathCache.rend(); pcRIter++) {
-		int mkdirResult = ::mkdir(pcRIter->native().c_str(), 0666);
+		int mkdirResult = ::mkdir(pcRIter->native().c_str(), 0777);
 		if (mkdirResult == -1) {
 			if (errno != EEXIST) {
 				if (pcRIter != pathCache.rbegin() + 1) {
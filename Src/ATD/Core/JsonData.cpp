@@ -0,0 +1,200 @@
+/**
+ * @file      
+ * @brief     Text and binary encodings of JSON-described assets.
+ * @details   ...
+ * @author    ArthurTheDigital (arthurthedigital@gmail.com)
+ * @copyright GPL v3.
+ * @since     $Id: $ */
+
+#include <ATD/Core/JsonData.hpp>
+#include <ATD/Core/JsonDataInternal.hpp>
+
+#include <ATD/Core/Printf.hpp>
+
+#include <stdint.h>
+
+#include <fstream>
+#include <stdexcept>
+
+
+/* ATD::JsonData constants: */
+
+const std::vector<std::string> ATD::JsonData::EXTENSIONS = 
+	std::vector<std::string>({
+		"json", 
+		"cbor", 
+		"msgpack"
+	});
+
+const size_t ATD::JsonData::EXT_JSON =    0;
+const size_t ATD::JsonData::EXT_CBOR =    1;
+const size_t ATD::JsonData::EXT_MSGPACK = 2;
+
+const std::string ATD::JsonData::CBOR_MAGIC = std::string("\xD9\xD9\xF7");
+
+
+/* ATD::JsonData: */
+
+ATD::JsonData::Format ATD::JsonData::formatFromPath(
+		const ATD::Fs::Path &filename)
+{
+	size_t extension = filename.extensionFromList(EXTENSIONS);
+	return extension == EXT_JSON ? JSON : 
+		extension == EXT_CBOR ? CBOR : 
+		extension == EXT_MSGPACK ? MSGPACK : 
+		UNKNOWN;
+}
+
+ATD::JsonData::Format ATD::JsonData::formatFromData(
+		const std::string &data)
+{
+	if (data.compare(0, CBOR_MAGIC.size(), CBOR_MAGIC) == 0) {
+		return CBOR;
+	}
+
+	for (auto &symbol : data) {
+		uint8_t byte = static_cast<uint8_t>(symbol);
+		if (byte == ' ' || byte == '\t' || byte == '\r' || byte == '\n') {
+			continue;
+		}
+
+		/* Documents are objects, so only maps are recognized: CBOR and
+		 * MessagePack arrays have overlapping first bytes. */
+		return byte == '{' || byte == '[' ? JSON : 
+			byte >= 0xA0 && byte <= 0xBF ? CBOR : 
+			(byte >= 0x80 && byte <= 0x8F) || byte == 0xDE || byte == 0xDF ? 
+			MSGPACK : 
+			UNKNOWN;
+	}
+	return UNKNOWN;
+}
+
+std::string ATD::JsonData::readFile(const ATD::Fs::Path &filename)
+{
+	std::ifstream file(filename.native(), std::ios_base::binary);
+	if (!file.is_open()) {
+		throw std::runtime_error(
+				Aux::printf(
+					"Failed to open %s for reading", 
+					filename.native().c_str()));
+	}
+
+	/* Obtain the size of the file. */
+	file.seekg(0, std::ios_base::end);
+	size_t fileSize = static_cast<size_t>(file.tellg());
+	file.seekg(0, std::ios_base::beg);
+
+	std::string data(fileSize, '\0');
+	file.read(&data[0], data.size());
+	file.close();
+	return data;
+}
+
+void ATD::JsonData::writeFile(const ATD::Fs::Path &filename, 
+		const std::string &data)
+{
+	std::ofstream file(filename.native(), std::ios_base::binary);
+	if (!file.is_open()) {
+		throw std::runtime_error(
+				Aux::printf(
+					"Failed to open %s for writing", 
+					filename.native().c_str()));
+	}
+
+	file.write(&data[0], data.size());
+	file.close();
+}
+
+void ATD::JsonData::convert(const ATD::Fs::Path &source, 
+		const ATD::Fs::Path &destination)
+{
+	JsonDataInternal::save(destination, JsonDataInternal::load(source));
+}
+
+
+/* ATD::JsonDataInternal: */
+
+nlohmann::json ATD::JsonDataInternal::decode(const std::string &data, 
+		ATD::JsonData::Format format)
+{
+	try {
+		switch (format) {
+			case JsonData::JSON:
+				return nlohmann::json::parse(data);
+			case JsonData::CBOR:
+				/* The self-describe tag is not parsed by nlohmann. */
+				if (data.compare(0, JsonData::CBOR_MAGIC.size(), 
+							JsonData::CBOR_MAGIC) == 0) {
+					return nlohmann::json::from_cbor(
+							data.substr(JsonData::CBOR_MAGIC.size()));
+				}
+				return nlohmann::json::from_cbor(data);
+			case JsonData::MSGPACK:
+				return nlohmann::json::from_msgpack(data);
+			default:
+				break;
+		}
+	} catch (const std::exception &e) {
+		throw std::runtime_error(Aux::printf("Failed to decode %s: %s", 
+					format == JsonData::JSON ? "JSON" : 
+					format == JsonData::CBOR ? "CBOR" : "MessagePack", 
+					e.what()));
+	}
+	throw std::runtime_error("Failed to decode data of unknown format");
+}
+
+std::string ATD::JsonDataInternal::encode(const nlohmann::json &jData, 
+		ATD::JsonData::Format format)
+{
+	std::vector<uint8_t> bytes;
+	switch (format) {
+		case JsonData::JSON:
+			return jData.dump();
+		case JsonData::CBOR:
+			bytes = nlohmann::json::to_cbor(jData);
+			return JsonData::CBOR_MAGIC + 
+				std::string(bytes.begin(), bytes.end());
+		case JsonData::MSGPACK:
+			bytes = nlohmann::json::to_msgpack(jData);
+			return std::string(bytes.begin(), bytes.end());
+		default:
+			break;
+	}
+	throw std::runtime_error("Failed to encode data to unknown format");
+}
+
+nlohmann::json ATD::JsonDataInternal::load(const ATD::Fs::Path &filename)
+{
+	std::string data = JsonData::readFile(filename);
+
+	JsonData::Format format = JsonData::formatFromData(data);
+	if (format == JsonData::UNKNOWN) {
+		format = JsonData::formatFromPath(filename);
+	}
+	if (format == JsonData::UNKNOWN) {
+		throw std::runtime_error(
+				Aux::printf(
+					"Failed to detect data format of %s", 
+					filename.native().c_str()));
+	}
+
+	try {
+		return decode(data, format);
+	} catch (const std::exception &e) {
+		throw std::runtime_error(Aux::printf("%s: %s", 
+					filename.native().c_str(), e.what()));
+	}
+}
+
+void ATD::JsonDataInternal::save(const ATD::Fs::Path &filename, 
+		const nlohmann::json &jData)
+{
+	JsonData::Format format = JsonData::formatFromPath(filename);
+	if (format == JsonData::UNKNOWN) {
+		format = JsonData::JSON;
+	}
+
+	JsonData::writeFile(filename, encode(jData, format));
+}
+
+
@@ -0,0 +1,62 @@
+/**
+ * @file      
+ * @brief     Parsed JSON documents for Loadable implementations.
+ * @details   ...
+ * @author    ArthurTheDigital (arthurthedigital@gmail.com)
+ * @copyright GPL v3.
+ * @since     $Id: $ */
+
+#pragma once
+
+#include <ATD/Core/JsonData.hpp>
+
+#include <nlohmann/json.hpp>
+
+
+namespace ATD {
+
+/**
+ * @brief JsonData, loaded into nlohmann::json.
+ * @class ...
+ *
+ * Not a part of public headers: nlohmann is available to the library
+ * sources only. */
+class JsonDataInternal
+{
+public:
+	/**
+	 * @brief ...
+	 * @param data   - ...
+	 * @param format - JSON, CBOR or MSGPACK
+	 * @return ...
+	 * @throws ... */
+	static nlohmann::json decode(const std::string &data, 
+			JsonData::Format format);
+
+	/**
+	 * @brief ...
+	 * @param jData  - ...
+	 * @param format - JSON, CBOR or MSGPACK
+	 * @return ...
+	 * @throws ... */
+	static std::string encode(const nlohmann::json &jData, 
+			JsonData::Format format);
+
+	/**
+	 * @brief Load a file in any of the formats.
+	 * @param filename - ...
+	 * @return ...
+	 * @throws ... */
+	static nlohmann::json load(const Fs::Path &filename);
+
+	/**
+	 * @brief Save a file in the format of its extension (JSON by default).
+	 * @param filename - ...
+	 * @param jData    - ...
+	 * @throws ... */
+	static void save(const Fs::Path &filename, const nlohmann::json &jData);
+};
+
+} /* namespace ATD */
+
+
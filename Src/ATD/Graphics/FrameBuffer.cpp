@@ -63,11 +63,10 @@ ATD::FrameBuffer::Usage::Usage(const ATD::FrameBuffer &frameBuffer)
 	: m_prevFrameBuffer(0)
 	, m_activated(false)
 {
-	gl.getIntegerv(Gl::FRAMEBUFFER_BINDING, 
-			reinterpret_cast<Gl::Int *>(&m_prevFrameBuffer));
+	m_prevFrameBuffer = gl.state.framebuffer(Gl::FRAMEBUFFER);
 
 	if (m_prevFrameBuffer != frameBuffer.glId()) {
-		gl.bindFramebuffer(Gl::FRAMEBUFFER, frameBuffer.glId());
+		gl.state.bindFramebuffer(Gl::FRAMEBUFFER, frameBuffer.glId());
 		m_activated = true;
 	}
 }
@@ -75,7 +74,7 @@ ATD::FrameBuffer::Usage::Usage(const ATD::FrameBuffer &frameBuffer)
 ATD::FrameBuffer::Usage::~Usage()
 {
 	if (m_activated) {
-		gl.bindFramebuffer(ATD::Gl::FRAMEBUFFER, m_prevFrameBuffer);
+		gl.state.bindFramebuffer(ATD::Gl::FRAMEBUFFER, m_prevFrameBuffer);
 	}
 }
 
@@ -109,11 +108,27 @@ ATD::Matrix4F _yFlip3D()
 	return yFlip;
 }
 
+/* Offset of the src texture within the dst one. */
+ATD::Vector2L _alignedOffset(const ATD::Vector2S &srcSize, 
+		const ATD::Vector2S &dstSize, 
+		const ATD::Align &alignX, 
+		const ATD::Align &alignY)
+{
+	long deltaX = static_cast<long>(dstSize.x) - static_cast<long>(srcSize.x);
+	long deltaY = static_cast<long>(dstSize.y) - static_cast<long>(srcSize.y);
 
-/* ATD::FrameBuffer auxiliary: basic shader: */
+	ATD::Vector2L offset;
 
-ATD::Shader2D::Ptr _basicShader2DPtr(nullptr);
-std::recursive_mutex _basicShader2DMtx;
+	offset.x = (alignX == ATD::Align::LOWER) ? 0 : 
+		(alignX == ATD::Align::CENTER) ? deltaX / 2 : 
+		deltaX;
+
+	offset.y = (alignY == ATD::Align::LOWER) ? 0 : 
+		(alignY == ATD::Align::CENTER) ? deltaY / 2 : 
+		deltaY;
+
+	return offset;
+}
 
 
 /* ATD::FrameBuffer: */
@@ -213,9 +228,11 @@ ATD::FrameBuffer::FrameBuffer(const ATD::FrameBuffer &other,
 		m_colorTexturePtr = Texture::Ptr(new Texture(m_size, Pixel(), 
 					Texture::COLOR));
 
-		/* Draw contents of other's color texture on new color texture. */
-		drawPlainAligned(*other.m_colorTexturePtr, *m_colorTexturePtr, 
-				alignX, alignY);
+		/* Copy contents of other's color texture to new color texture. */
+		Texture::copy(*other.m_colorTexturePtr, 
+				RectL(static_cast<Vector2L>(other.m_size)), 
+				*m_colorTexturePtr, 
+				_alignedOffset(other.m_size, m_size, alignX, alignY));
 
 		GL_CHECK("", gl.framebufferTexture2D(Gl::FRAMEBUFFER, 
 				Gl::COLOR_ATTACHMENT0, /* attachment */
@@ -230,11 +247,11 @@ ATD::FrameBuffer::FrameBuffer(const ATD::FrameBuffer &other,
 		m_depthTexturePtr = Texture::Ptr(new Texture(m_size, Pixel(), 
 					Texture::DEPTH));
 
-		/* Draw contents of other's depth texture on new depth texture. */
-		// drawPlainAligned(*other.m_depthTexturePtr, *m_depthTexturePtr, 
-		//		alignX, alignY);
-		/* FIXME: Temporary frame buffer is incomplete after attaching 
-		 * depth texture as color. Shall find a better way to copy textures. */
+		/* Copy contents of other's depth texture to new depth texture. */
+		Texture::copy(*other.m_depthTexturePtr, 
+				RectL(static_cast<Vector2L>(other.m_size)), 
+				*m_depthTexturePtr, 
+				_alignedOffset(other.m_size, m_size, alignX, alignY));
 
 		GL_CHECK("", gl.framebufferTexture2D(Gl::FRAMEBUFFER, 
 				Gl::DEPTH_ATTACHMENT, /* attachment */
@@ -263,7 +280,7 @@ ATD::FrameBuffer::~FrameBuffer()
 	/* If bound via 'Usage' subclass, it is already unbound automatically. 
 	 * Textures get deinited automatically when all smart pointers destroyed. 
 	 * No other deinit required. */
-	gl.deleteFramebuffers(1, &m_frameBufferId);
+	gl.state.deleteFramebuffers(1, &m_frameBufferId);
 }
 
 double ATD::FrameBuffer::aspectRatio() const
@@ -315,7 +332,7 @@ void ATD::FrameBuffer::draw(const ATD::VertexBuffer2D &vertices2D,
 		const ATD::Transform2D &transform)
 {
 	Shader2D &shader2D = m_shader2DPtr ? *m_shader2DPtr : *m_dftShader2DPtr;
-	shader2D.setUniform("unfTransform", 
+	shader2D.setUniform(shader2D.transformUniform(), 
 			(m_coords2DOffset.matrix() *
 				m_coords2DScale.matrix() * 
 				transform.matrix()));
@@ -326,7 +343,7 @@ void ATD::FrameBuffer::draw(const ATD::VertexBuffer2D &vertices2D,
 
 		Usage useFBuffer(*this);
 		Shader::Usage useShader(shader2D);
-		gl.viewport(0, 0, m_size.x, m_size.y);
+		gl.state.viewport(0, 0, m_size.x, m_size.y);
 		/* https://stackoverflow.com/questions/33718237/\
 		 * do-you-have-to-call-glviewport-every-time-you-bind-\
 		 * a-frame-buffer-with-a-differe */
@@ -335,7 +352,7 @@ void ATD::FrameBuffer::draw(const ATD::VertexBuffer2D &vertices2D,
 	} else {
 		Usage useFBuffer(*this);
 		Shader::Usage useShader(shader2D);
-		gl.viewport(0, 0, m_size.x, m_size.y);
+		gl.state.viewport(0, 0, m_size.x, m_size.y);
 		/* https://stackoverflow.com/questions/33718237/\
 		 * do-you-have-to-call-glviewport-every-time-you-bind-\
 		 * a-frame-buffer-with-a-differe */
@@ -349,7 +366,7 @@ void ATD::FrameBuffer::draw(const ATD::VertexBuffer3D &vertices3D,
 {
 
 	Shader3D &shader3D = m_shader3DPtr ? *m_shader3DPtr : *m_dftShader3DPtr;
-	shader3D.setUniform("unfTransform", transform.matrix());
+	shader3D.setUniform(shader3D.transformUniform(), transform.matrix());
 
 	/* Texture::Usage is expected to be set before. */
 	if (shader3D.isCanvasRequired() && m_colorTexturePtr) {
@@ -357,18 +374,70 @@ void ATD::FrameBuffer::draw(const ATD::VertexBuffer3D &vertices3D,
 
 		Usage useFBuffer(*this);
 		Shader::Usage useShader(shader3D);
-		gl.viewport(0, 0, m_size.x, m_size.y);
+		gl.state.viewport(0, 0, m_size.x, m_size.y);
 
 		vertices3D.drawSelfInternal(shader3D.getAttrIndices());
 	} else {
 		Usage useFBuffer(*this);
 		Shader::Usage useShader(shader3D);
-		gl.viewport(0, 0, m_size.x, m_size.y);
+		gl.state.viewport(0, 0, m_size.x, m_size.y);
 
 		vertices3D.drawSelfInternal(shader3D.getAttrIndices());
 	}
 }
 
+void ATD::FrameBuffer::draw(const ATD::VertexBuffer2D &vertices2D, 
+		const ATD::InstanceBuffer2D &instances, 
+		const ATD::Transform2D &transform)
+{
+	Shader2D &shader2D = m_shader2DPtr ? *m_shader2DPtr : *m_dftShader2DPtr;
+	shader2D.setUniform(shader2D.transformUniform(), 
+			(m_coords2DOffset.matrix() *
+				m_coords2DScale.matrix() * 
+				transform.matrix()));
+
+	/* Instances, drawn in one call, do not see each other on canvas. */
+	if (shader2D.isCanvasRequired() && m_colorTexturePtr) {
+		Texture::Usage useCanvas(*m_colorTexturePtr, Texture::TEX_7);
+
+		Usage useFBuffer(*this);
+		Shader::Usage useShader(shader2D);
+		gl.state.viewport(0, 0, m_size.x, m_size.y);
+
+		vertices2D.drawSelfInternal(shader2D.getAttrIndices(), instances);
+	} else {
+		Usage useFBuffer(*this);
+		Shader::Usage useShader(shader2D);
+		gl.state.viewport(0, 0, m_size.x, m_size.y);
+
+		vertices2D.drawSelfInternal(shader2D.getAttrIndices(), instances);
+	}
+}
+
+void ATD::FrameBuffer::draw(const ATD::VertexBuffer3D &vertices3D, 
+		const ATD::InstanceBuffer3D &instances, 
+		const ATD::Transform3D &transform)
+{
+	Shader3D &shader3D = m_shader3DPtr ? *m_shader3DPtr : *m_dftShader3DPtr;
+	shader3D.setUniform(shader3D.transformUniform(), transform.matrix());
+
+	if (shader3D.isCanvasRequired() && m_colorTexturePtr) {
+		Texture::Usage useCanvas(*m_colorTexturePtr, Texture::TEX_7);
+
+		Usage useFBuffer(*this);
+		Shader::Usage useShader(shader3D);
+		gl.state.viewport(0, 0, m_size.x, m_size.y);
+
+		vertices3D.drawSelfInternal(shader3D.getAttrIndices(), instances);
+	} else {
+		Usage useFBuffer(*this);
+		Shader::Usage useShader(shader3D);
+		gl.state.viewport(0, 0, m_size.x, m_size.y);
+
+		vertices3D.drawSelfInternal(shader3D.getAttrIndices(), instances);
+	}
+}
+
 void ATD::FrameBuffer::setupShader2D(Shader2D &shader) const
 {
 	updateCanvasUniformsOnShader(static_cast<Shader &>(shader));
@@ -402,105 +471,4 @@ void ATD::FrameBuffer::updateProjectionOnShader3D(Shader3D &shader) const
 	shader.setUniform("unfProject", _yFlip3D() * m_projection3D.matrix());
 }
 
-void ATD::FrameBuffer::drawPlainAligned(const ATD::Texture &texSrc, 
-		ATD::Texture &texDst, 
-		const ATD::Align &alignX, 
-		const ATD::Align &alignY)
-{
-	long deltaX = texDst.size().x - texSrc.size().x;
-	long deltaY = texDst.size().y - texDst.size().y;
-
-	Vector2L offset;
-
-	offset.x = (alignX == Align::LOWER) ? 0 : 
-		(alignX == Align::CENTER) ? deltaX / 2 : 
-		deltaX;
-
-	offset.y = (alignY == Align::LOWER) ? 0 : 
-		(alignY == Align::CENTER) ? deltaY / 2 : 
-		deltaY;
-
-	/* Init vertices. */
-	VertexBuffer2D vertices(RectL(texSrc.size()), texSrc.size());
-
-	/* Init transform. */
-	Transform2D transform;
-	transform.setOffset(static_cast<ATD::Vector2D>(offset));	
-
-	/* Create temporary frame buffer. */
-	Gl::Uint frameBufferTmpId = 0;
-	GL_CHECK("", gl.genFramebuffers(1, &frameBufferTmpId));
-
-	/* Remember the previously bound frame buffer and use the 
-	 * temporary one. */
-	Gl::Uint frameBufferPrevId = 0;
-	gl.getIntegerv(Gl::FRAMEBUFFER_BINDING, 
-			reinterpret_cast<Gl::Int *>(&frameBufferPrevId));
-
-	GL_CHECK("", gl.bindFramebuffer(Gl::FRAMEBUFFER, frameBufferTmpId));
-
-	/* Attach dst texture to the frame buffer as color. */
-	GL_CHECK("", gl.framebufferTexture2D(Gl::FRAMEBUFFER, 
-			Gl::COLOR_ATTACHMENT0, /* attachment */
-			Gl::TEXTURE_2D, /* textarget */
-			texDst.glId(), 
-			0));
-
-	/* Check temporary frame buffer. */
-	{
-		Gl::Enum status = gl.checkFramebufferStatus(Gl::FRAMEBUFFER);
-		if (status != Gl::FRAMEBUFFER_COMPLETE) {
-			/* Restore previous frame buffer. */
-			GL_CHECK("", gl.bindFramebuffer(Gl::FRAMEBUFFER, 
-						frameBufferPrevId));
-
-			/* Delete temporary frame buffer. */
-			gl.deleteFramebuffers(1, &frameBufferTmpId);
-
-			throw std::runtime_error(
-					Aux::printf(
-						"incomplete frame buffer %u: 0x%x", 
-						glId(), 
-						static_cast<unsigned>(status)));
-		}
-	}
-
-	/* Do drawing with basic 2D shader. */
-	{
-		std::lock_guard<std::recursive_mutex> lock(_basicShader2DMtx);
-
-		if (!_basicShader2DPtr) {
-			_basicShader2DPtr = 
-				Shader2D::Ptr(
-						new Shader2D(
-							Shader2D::PLAIN_VERTEX_SOURCE, 
-							Shader2D::PLAIN_FRAGMENT_SOURCE));
-		}
-
-		Transform2D tmpCoords2DScale = _coords2DScaleTransform(texDst.size());
-		Transform2D tmpCoords2DOffset = _coords2DOffsetTransform();
-
-		_basicShader2DPtr->setUniform("unfProject", 
-				Projection2D().matrix());
-
-		_basicShader2DPtr->setUniform("unfTransform", 
-				(tmpCoords2DOffset.matrix() *
-					tmpCoords2DScale.matrix() * 
-					transform.matrix()));
-
-		Texture::Usage useTexture(texSrc);
-
-		Shader::Usage useShader(*_basicShader2DPtr);
-
-		GL_CHECK("", vertices.drawSelfInternal(
-					_basicShader2DPtr->getAttrIndices()));
-	}
-
-	/* Restore previous frame buffer. */
-	GL_CHECK("", gl.bindFramebuffer(Gl::FRAMEBUFFER, frameBufferPrevId));
-
-	/* Delete temporary frame buffer. */
-	gl.deleteFramebuffers(1, &frameBufferTmpId);
-}
-
 
@@ -9,12 +9,16 @@
 #include <ATD/Graphics/Gl.hpp>
 
 #include <ATD/Core/Debug.hpp>
+#include <ATD/Core/Printf.hpp>
 
 #include <GL/gl.h>
 #include <GL/glx.h>
 
 #include <stdio.h>
+#include <string.h>
 
+#include <atomic>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -34,6 +38,46 @@ static GlFunc _loadFunction(const char *procName,
 	return result;
 }
 
+/* Whether GL_VERSION string is major.minor or above. */
+static bool _isVersionAtLeast(const char *versionStr, int major, int minor)
+{
+	int versionMajor = 0;
+	int versionMinor = 0;
+
+	/* "OpenGL ES " prefix may go before the numbers. */
+	while (versionStr && *versionStr && 
+			(*versionStr < '0' || *versionStr > '9')) {
+		versionStr++;
+	}
+	if (!versionStr || 
+			::sscanf(versionStr, "%d.%d", &versionMajor, &versionMinor) != 2) {
+		return false;
+	}
+	return versionMajor > major || 
+		(versionMajor == major && versionMinor >= minor);
+}
+
+/* Extensions string is space separated. */
+static bool _hasExtension(const char *extensionsStr, const char *name)
+{
+	size_t nameLen = ::strlen(name);
+	const char *extension = extensionsStr;
+	while (extension && *extension) {
+		size_t extensionLen = ::strcspn(extension, " ");
+		if (extensionLen == nameLen && 
+				::strncmp(extension, name, nameLen) == 0) {
+			return true;
+		}
+		extension += extensionLen;
+		extension += ::strspn(extension, " ");
+	}
+	return false;
+}
+
+/* -1 until queried, then 0 or 1. The contexts of the process are assumed 
+ * to be of the same driver. */
+static std::atomic<int> _uniformBuffersSupport(-1);
+
 
 /* ATD::Gl constants: */
 
@@ -965,6 +1009,9 @@ const ATD::Gl::Enum ATD::Gl::DOT3_RGBA = GL_DOT3_RGBA;
 /* texture_border_clamp */
 const ATD::Gl::Enum ATD::Gl::CLAMP_TO_BORDER = GL_CLAMP_TO_BORDER;
 
+/* OpenGL 1.4 */
+const ATD::Gl::Enum ATD::Gl::MIRRORED_REPEAT = GL_MIRRORED_REPEAT;
+
 /* OpenGL 1.5 */
 const ATD::Gl::Enum ATD::Gl::BUFFER_SIZE = GL_BUFFER_SIZE;
 const ATD::Gl::Enum ATD::Gl::BUFFER_USAGE = GL_BUFFER_USAGE;
@@ -1480,6 +1527,359 @@ const ATD::Gl::Enum ATD::Gl::CLAMP_VERTEX_COLOR = GL_CLAMP_VERTEX_COLOR;
 const ATD::Gl::Enum ATD::Gl::CLAMP_FRAGMENT_COLOR = GL_CLAMP_FRAGMENT_COLOR;
 const ATD::Gl::Enum ATD::Gl::ALPHA_INTEGER = GL_ALPHA_INTEGER;
 
+/* OpenGL 3.1 (ARB_uniform_buffer_object) */
+const ATD::Gl::Enum ATD::Gl::UNIFORM_BUFFER = GL_UNIFORM_BUFFER;
+const ATD::Gl::Enum ATD::Gl::MAX_UNIFORM_BLOCK_SIZE = 
+	GL_MAX_UNIFORM_BLOCK_SIZE;
+const ATD::Gl::Uint ATD::Gl::INVALID_INDEX = GL_INVALID_INDEX;
+
+/* OpenGL 3.2 (sync objects) */
+const ATD::Gl::Enum ATD::Gl::SYNC_GPU_COMMANDS_COMPLETE = 
+	GL_SYNC_GPU_COMMANDS_COMPLETE;
+const ATD::Gl::Bitfield ATD::Gl::SYNC_FLUSH_COMMANDS_BIT = 
+	GL_SYNC_FLUSH_COMMANDS_BIT;
+const ATD::Gl::Enum ATD::Gl::ALREADY_SIGNALED = GL_ALREADY_SIGNALED;
+const ATD::Gl::Enum ATD::Gl::TIMEOUT_EXPIRED = GL_TIMEOUT_EXPIRED;
+const ATD::Gl::Enum ATD::Gl::CONDITION_SATISFIED = GL_CONDITION_SATISFIED;
+const ATD::Gl::Enum ATD::Gl::WAIT_FAILED = GL_WAIT_FAILED;
+
+/* OpenGL 3.3 (ARB_vertex_type_2_10_10_10_rev) */
+const ATD::Gl::Enum ATD::Gl::INT_2_10_10_10_REV = GL_INT_2_10_10_10_REV;
+
+/* EXT_texture_filter_anisotropic */
+const ATD::Gl::Enum ATD::Gl::TEXTURE_MAX_ANISOTROPY = 
+	GL_TEXTURE_MAX_ANISOTROPY_EXT;
+const ATD::Gl::Enum ATD::Gl::MAX_TEXTURE_MAX_ANISOTROPY = 
+	GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT;
+
+/* OpenGL 4.1 (ARB_get_program_binary) */
+const ATD::Gl::Enum ATD::Gl::PROGRAM_BINARY_RETRIEVABLE_HINT = 
+	GL_PROGRAM_BINARY_RETRIEVABLE_HINT;
+const ATD::Gl::Enum ATD::Gl::PROGRAM_BINARY_LENGTH = 
+	GL_PROGRAM_BINARY_LENGTH;
+const ATD::Gl::Enum ATD::Gl::NUM_PROGRAM_BINARY_FORMATS = 
+	GL_NUM_PROGRAM_BINARY_FORMATS;
+
+
+/* ATD::Gl::State auxiliary: */
+
+static const std::map<ATD::Gl::Enum, ATD::Gl::Enum> _BUFFER_BINDINGS = {
+	{ GL_ARRAY_BUFFER, GL_ARRAY_BUFFER_BINDING }, 
+	{ GL_ELEMENT_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER_BINDING }, 
+	{ GL_PIXEL_PACK_BUFFER, GL_PIXEL_PACK_BUFFER_BINDING }, 
+	{ GL_PIXEL_UNPACK_BUFFER, GL_PIXEL_UNPACK_BUFFER_BINDING }
+};
+
+static const std::map<ATD::Gl::Enum, ATD::Gl::Enum> _TEXTURE_BINDINGS = {
+	{ GL_TEXTURE_2D, GL_TEXTURE_BINDING_2D }, 
+	{ GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BINDING_CUBE_MAP }
+};
+
+
+/* ATD::Gl::State: */
+
+ATD::Gl::State::State(ATD::Gl &owner)
+	: m_owner(owner)
+	, m_program(0)
+	, m_vertexArray(0)
+	, m_activeTextureUnit(GL_TEXTURE0)
+	, m_readFramebuffer(0)
+	, m_drawFramebuffer(0)
+	, m_readScratchFramebuffer(0)
+	, m_drawScratchFramebuffer(0)
+	, m_viewport{0, 0, 0, 0}
+	, m_buffers()
+	, m_elementBuffers()
+	, m_textures()
+	, m_capabilities()
+{}
+
+void ATD::Gl::State::reset()
+{
+	Int value = 0;
+
+	m_owner.getIntegerv(GL_CURRENT_PROGRAM, &value);
+	m_program = static_cast<Uint>(value);
+	m_owner.getIntegerv(GL_VERTEX_ARRAY_BINDING, &value);
+	m_vertexArray = static_cast<Uint>(value);
+	m_owner.getIntegerv(GL_ACTIVE_TEXTURE, &value);
+	m_activeTextureUnit = static_cast<Enum>(value);
+	m_owner.getIntegerv(GL_READ_FRAMEBUFFER_BINDING, &value);
+	m_readFramebuffer = static_cast<Uint>(value);
+	m_owner.getIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &value);
+	m_drawFramebuffer = static_cast<Uint>(value);
+	m_owner.getIntegerv(GL_VIEWPORT, m_viewport);
+	m_readScratchFramebuffer = 0;
+	m_drawScratchFramebuffer = 0;
+
+	m_buffers.clear();
+	m_elementBuffers.clear();
+	m_textures.clear();
+	m_capabilities.clear();
+}
+
+void ATD::Gl::State::release()
+{
+	if (m_readScratchFramebuffer) {
+		deleteFramebuffers(1, &m_readScratchFramebuffer);
+		m_readScratchFramebuffer = 0;
+	}
+	if (m_drawScratchFramebuffer) {
+		deleteFramebuffers(1, &m_drawScratchFramebuffer);
+		m_drawScratchFramebuffer = 0;
+	}
+}
+
+void ATD::Gl::State::useProgram(ATD::Gl::Uint program)
+{
+	if (program != m_program) {
+		m_owner.useProgram(program);
+		m_program = program;
+	}
+}
+
+void ATD::Gl::State::deleteProgram(ATD::Gl::Uint program)
+{
+	/* Current program is not deleted by OpenGL until unbound. */
+	if (program == m_program) { useProgram(0); }
+	m_owner.deleteProgram(program);
+}
+
+ATD::Gl::Uint ATD::Gl::State::buffer(ATD::Gl::Enum target) const
+{
+	auto bindingIt = _BUFFER_BINDINGS.find(target);
+	if (bindingIt == _BUFFER_BINDINGS.end()) {
+		throw std::runtime_error(Aux::printf(
+					"buffer target 0x%x is not tracked", 
+					static_cast<unsigned>(target)));
+	}
+
+	/* Element array buffer is a part of the vertex array state. */
+	std::map<Uint, Uint> &buffers = target == GL_ELEMENT_ARRAY_BUFFER ? 
+		m_elementBuffers : m_buffers;
+	Uint key = target == GL_ELEMENT_ARRAY_BUFFER ? m_vertexArray : target;
+
+	auto bufferIt = buffers.find(key);
+	if (bufferIt == buffers.end()) {
+		Int value = 0;
+		m_owner.getIntegerv(bindingIt->second, &value);
+		bufferIt = buffers.insert(
+				std::make_pair(key, static_cast<Uint>(value))).first;
+	}
+	return bufferIt->second;
+}
+
+void ATD::Gl::State::bindBuffer(ATD::Gl::Enum target, ATD::Gl::Uint buffer)
+{
+	if (_BUFFER_BINDINGS.find(target) == _BUFFER_BINDINGS.end()) {
+		/* Not tracked: just pass through. */
+		m_owner.bindBuffer(target, buffer);
+		return;
+	}
+
+	if (this->buffer(target) != buffer) {
+		m_owner.bindBuffer(target, buffer);
+		if (target == GL_ELEMENT_ARRAY_BUFFER) {
+			m_elementBuffers[m_vertexArray] = buffer;
+		} else {
+			m_buffers[target] = buffer;
+		}
+	}
+}
+
+void ATD::Gl::State::deleteBuffers(ATD::Gl::Sizei n, 
+		const ATD::Gl::Uint *buffers)
+{
+	m_owner.deleteBuffers(n, buffers);
+
+	/* Deleted buffers are unbound from the targets and from the current 
+	 * vertex array. Other vertex arrays are queried again, when bound. */
+	for (Sizei bIndex = 0; bIndex < n; bIndex++) {
+		for (auto &bufferPair : m_buffers) {
+			if (bufferPair.second == buffers[bIndex]) {
+				bufferPair.second = 0;
+			}
+		}
+
+		for (auto bufferIt = m_elementBuffers.begin(); 
+				bufferIt != m_elementBuffers.end(); ) {
+			if (bufferIt->second == buffers[bIndex]) {
+				if (bufferIt->first == m_vertexArray) {
+					bufferIt->second = 0;
+					bufferIt++;
+				} else {
+					bufferIt = m_elementBuffers.erase(bufferIt);
+				}
+			} else {
+				bufferIt++;
+			}
+		}
+	}
+}
+
+void ATD::Gl::State::bindVertexArray(ATD::Gl::Uint array)
+{
+	if (array != m_vertexArray) {
+		m_owner.bindVertexArray(array);
+		m_vertexArray = array;
+	}
+}
+
+void ATD::Gl::State::deleteVertexArrays(ATD::Gl::Sizei n, 
+		const ATD::Gl::Uint *arrays)
+{
+	m_owner.deleteVertexArrays(n, arrays);
+
+	for (Sizei aIndex = 0; aIndex < n; aIndex++) {
+		if (arrays[aIndex] == m_vertexArray) { m_vertexArray = 0; }
+		m_elementBuffers.erase(arrays[aIndex]);
+	}
+}
+
+void ATD::Gl::State::activeTexture(ATD::Gl::Enum unit)
+{
+	if (unit != m_activeTextureUnit) {
+		m_owner.activeTexture(unit);
+		m_activeTextureUnit = unit;
+	}
+}
+
+ATD::Gl::Uint ATD::Gl::State::texture(ATD::Gl::Enum target) const
+{
+	auto key = std::make_pair(m_activeTextureUnit, target);
+	auto textureIt = m_textures.find(key);
+	if (textureIt == m_textures.end()) {
+		auto bindingIt = _TEXTURE_BINDINGS.find(target);
+		if (bindingIt == _TEXTURE_BINDINGS.end()) {
+			throw std::runtime_error(Aux::printf(
+						"texture target 0x%x is not tracked", 
+						static_cast<unsigned>(target)));
+		}
+
+		Int value = 0;
+		m_owner.getIntegerv(bindingIt->second, &value);
+		textureIt = m_textures.insert(
+				std::make_pair(key, static_cast<Uint>(value))).first;
+	}
+	return textureIt->second;
+}
+
+void ATD::Gl::State::bindTexture(ATD::Gl::Enum target, 
+		ATD::Gl::Uint texture)
+{
+	if (this->texture(target) != texture) {
+		m_owner.bindTexture(target, texture);
+		m_textures[std::make_pair(m_activeTextureUnit, target)] = texture;
+	}
+}
+
+void ATD::Gl::State::deleteTextures(ATD::Gl::Sizei n, 
+		const ATD::Gl::Uint *textures)
+{
+	m_owner.deleteTextures(n, textures);
+
+	/* Deleted textures are unbound from all the units. */
+	for (Sizei tIndex = 0; tIndex < n; tIndex++) {
+		for (auto &texturePair : m_textures) {
+			if (texturePair.second == textures[tIndex]) {
+				texturePair.second = 0;
+			}
+		}
+	}
+}
+
+ATD::Gl::Uint ATD::Gl::State::framebuffer(ATD::Gl::Enum target) const
+{
+	return target == GL_READ_FRAMEBUFFER ? 
+		m_readFramebuffer : m_drawFramebuffer;
+}
+
+void ATD::Gl::State::bindFramebuffer(ATD::Gl::Enum target, 
+		ATD::Gl::Uint framebuffer)
+{
+	if (target == GL_FRAMEBUFFER) {
+		if (m_readFramebuffer != framebuffer || 
+				m_drawFramebuffer != framebuffer) {
+			m_owner.bindFramebuffer(target, framebuffer);
+			m_readFramebuffer = framebuffer;
+			m_drawFramebuffer = framebuffer;
+		}
+	} else {
+		Uint &current = target == GL_READ_FRAMEBUFFER ? 
+			m_readFramebuffer : m_drawFramebuffer;
+		if (current != framebuffer) {
+			m_owner.bindFramebuffer(target, framebuffer);
+			current = framebuffer;
+		}
+	}
+}
+
+void ATD::Gl::State::deleteFramebuffers(ATD::Gl::Sizei n, 
+		const ATD::Gl::Uint *framebuffers)
+{
+	m_owner.deleteFramebuffers(n, framebuffers);
+
+	for (Sizei fIndex = 0; fIndex < n; fIndex++) {
+		if (m_readFramebuffer == framebuffers[fIndex]) {
+			m_readFramebuffer = 0;
+		}
+		if (m_drawFramebuffer == framebuffers[fIndex]) {
+			m_drawFramebuffer = 0;
+		}
+	}
+}
+
+ATD::Gl::Uint ATD::Gl::State::scratchFramebuffer(ATD::Gl::Enum target)
+{
+	Uint &scratch = target == GL_READ_FRAMEBUFFER ? 
+		m_readScratchFramebuffer : m_drawScratchFramebuffer;
+	if (!scratch) {
+		m_owner.genFramebuffers(1, &scratch);
+	}
+	return scratch;
+}
+
+void ATD::Gl::State::viewport(ATD::Gl::Int x, ATD::Gl::Int y, 
+		ATD::Gl::Sizei width, ATD::Gl::Sizei height)
+{
+	if (m_viewport[0] != x || m_viewport[1] != y || 
+			m_viewport[2] != width || m_viewport[3] != height) {
+		m_owner.viewport(x, y, width, height);
+		m_viewport[0] = x;
+		m_viewport[1] = y;
+		m_viewport[2] = width;
+		m_viewport[3] = height;
+	}
+}
+
+bool ATD::Gl::State::isEnabled(ATD::Gl::Enum capability) const
+{
+	auto capabilityIt = m_capabilities.find(capability);
+	if (capabilityIt == m_capabilities.end()) {
+		Boolean value = GL_FALSE;
+		m_owner.getBooleanv(capability, &value);
+		capabilityIt = m_capabilities.insert(
+				std::make_pair(capability, value != GL_FALSE)).first;
+	}
+	return capabilityIt->second;
+}
+
+void ATD::Gl::State::enable(ATD::Gl::Enum capability)
+{
+	if (!isEnabled(capability)) {
+		m_owner.enable(capability);
+		m_capabilities[capability] = true;
+	}
+}
+
+void ATD::Gl::State::disable(ATD::Gl::Enum capability)
+{
+	if (isEnabled(capability)) {
+		m_owner.disable(capability);
+		m_capabilities[capability] = false;
+	}
+}
+
 
 /* ATD::Gl */
 
@@ -1500,6 +1900,8 @@ ATD::Gl::Gl()
 				"glGetFloatv", failures));
 	getIntegerv = reinterpret_cast<GetIntegervFunc *>(_loadFunction(
 				"glGetIntegerv", failures));
+	getString = reinterpret_cast<GetStringFunc *>(_loadFunction(
+				"glGetString", failures));
 
 	genBuffers = reinterpret_cast<GenBuffersFunc *>(_loadFunction(
 				"glGenBuffers", failures));
@@ -1509,6 +1911,8 @@ ATD::Gl::Gl()
 				"glBindBuffer", failures));
 	bufferData = reinterpret_cast<BufferDataFunc *>(_loadFunction(
 				"glBufferData", failures));
+	bufferSubData = reinterpret_cast<BufferSubDataFunc *>(_loadFunction(
+				"glBufferSubData", failures));
 	mapBuffer = reinterpret_cast<MapBufferFunc *>(_loadFunction(
 				"glMapBuffer", failures));
 	unmapBuffer = reinterpret_cast<UnmapBufferFunc *>(_loadFunction(
@@ -1526,6 +1930,37 @@ ATD::Gl::Gl()
 				"glDrawArrays", failures));
 	drawElements = reinterpret_cast<DrawElementsFunc *>(_loadFunction(
 				"glDrawElements", failures));
+	drawArraysInstanced = 
+		reinterpret_cast<DrawArraysInstancedFunc *>(_loadFunction(
+					"glDrawArraysInstanced", failures));
+	drawElementsInstanced = 
+		reinterpret_cast<DrawElementsInstancedFunc *>(_loadFunction(
+					"glDrawElementsInstanced", failures));
+	{
+		/* Core since OpenGL 3.3 only, ARB_instanced_arrays before. */
+		std::vector<std::string> coreFailures;
+		vertexAttribDivisor = 
+			reinterpret_cast<VertexAttribDivisorFunc *>(_loadFunction(
+						"glVertexAttribDivisor", coreFailures));
+		if (!vertexAttribDivisor) {
+			vertexAttribDivisor = 
+				reinterpret_cast<VertexAttribDivisorFunc *>(_loadFunction(
+							"glVertexAttribDivisorARB", failures));
+		}
+	}
+	genVertexArrays = reinterpret_cast<GenVertexArraysFunc *>(_loadFunction(
+				"glGenVertexArrays", failures));
+	deleteVertexArrays = 
+		reinterpret_cast<DeleteVertexArraysFunc *>(_loadFunction(
+					"glDeleteVertexArrays", failures));
+	bindVertexArray = reinterpret_cast<BindVertexArrayFunc *>(_loadFunction(
+				"glBindVertexArray", failures));
+	fenceSync = reinterpret_cast<FenceSyncFunc *>(_loadFunction(
+				"glFenceSync", failures));
+	deleteSync = reinterpret_cast<DeleteSyncFunc *>(_loadFunction(
+				"glDeleteSync", failures));
+	clientWaitSync = reinterpret_cast<ClientWaitSyncFunc *>(_loadFunction(
+				"glClientWaitSync", failures));
 
 	createShader = reinterpret_cast<CreateShaderFunc *>(_loadFunction(
 				"glCreateShader", failures));
@@ -1558,10 +1993,50 @@ ATD::Gl::Gl()
 	getProgramInfoLog = 
 		reinterpret_cast<GetProgramInfoLogFunc *>(_loadFunction(
 					"glGetProgramInfoLog", failures));
+	{
+		/* Optional, failures are not fatal. */
+		std::vector<std::string> optionalFailures;
+		programParameteri = 
+			reinterpret_cast<ProgramParameteriFunc *>(_loadFunction(
+						"glProgramParameteri", optionalFailures));
+		getProgramBinary = 
+			reinterpret_cast<GetProgramBinaryFunc *>(_loadFunction(
+						"glGetProgramBinary", optionalFailures));
+		programBinary = 
+			reinterpret_cast<ProgramBinaryFunc *>(_loadFunction(
+						"glProgramBinary", optionalFailures));
+		if (optionalFailures.size()) {
+			programParameteri = nullptr;
+			getProgramBinary = nullptr;
+			programBinary = nullptr;
+		}
+	}
+	{
+		/* Optional, failures are not fatal. Loaded does not mean 
+		 * supported, see hasUniformBuffers(). */
+		std::vector<std::string> optionalFailures;
+		getUniformBlockIndex = 
+			reinterpret_cast<GetUniformBlockIndexFunc *>(_loadFunction(
+						"glGetUniformBlockIndex", optionalFailures));
+		uniformBlockBinding = 
+			reinterpret_cast<UniformBlockBindingFunc *>(_loadFunction(
+						"glUniformBlockBinding", optionalFailures));
+		bindBufferBase = 
+			reinterpret_cast<BindBufferBaseFunc *>(_loadFunction(
+						"glBindBufferBase", optionalFailures));
+		if (optionalFailures.size()) {
+			getUniformBlockIndex = nullptr;
+			uniformBlockBinding = nullptr;
+			bindBufferBase = nullptr;
+		}
+	}
 
 	getUniformLocation = 
 		reinterpret_cast<GetUniformLocationFunc *>(_loadFunction(
 					"glGetUniformLocation", failures));
+	getAttribLocation = 
+		reinterpret_cast<GetAttribLocationFunc *>(_loadFunction(
+					"glGetAttribLocation", failures));
 	getActiveUniform = 
 		reinterpret_cast<GetActiveUniformFunc *>(_loadFunction(
 					"glGetActiveUniform", failures));
@@ -1618,6 +2093,12 @@ ATD::Gl::Gl()
 				"glBindTexture", failures));
 	texImage2D = reinterpret_cast<TexImage2DFunc *>(_loadFunction(
 				"glTexImage2D", failures));
+	texSubImage2D = reinterpret_cast<TexSubImage2DFunc *>(_loadFunction(
+				"glTexSubImage2D", failures));
+	pixelStorei = reinterpret_cast<PixelStoreiFunc *>(_loadFunction(
+				"glPixelStorei", failures));
+	generateMipmap = reinterpret_cast<GenerateMipmapFunc *>(_loadFunction(
+				"glGenerateMipmap", failures));
 	texParameterf = reinterpret_cast<TexParameterfFunc *>(_loadFunction(
 				"glTexParameterf", failures));
 	texParameteri = reinterpret_cast<TexParameteriFunc *>(_loadFunction(
@@ -1645,11 +2126,22 @@ ATD::Gl::Gl()
 	readPixels = 
 		reinterpret_cast<ReadPixelsFunc *>(_loadFunction(
 					"glReadPixels", failures));
+	blitFramebuffer = 
+		reinterpret_cast<BlitFramebufferFunc *>(_loadFunction(
+					"glBlitFramebuffer", failures));
+	drawBuffer = reinterpret_cast<DrawBufferFunc *>(_loadFunction(
+				"glDrawBuffer", failures));
+	readBuffer = reinterpret_cast<ReadBufferFunc *>(_loadFunction(
+				"glReadBuffer", failures));
 
 	frontFace = reinterpret_cast<FrontFaceFunc *>(_loadFunction(
 				"glFrontFace", failures));
 	cullFace = reinterpret_cast<CullFaceFunc *>(_loadFunction(
 				"glCullFace", failures));
+	blendFunc = reinterpret_cast<BlendFuncFunc *>(_loadFunction(
+				"glBlendFunc", failures));
+	depthMask = reinterpret_cast<DepthMaskFunc *>(_loadFunction(
+				"glDepthMask", failures));
 	enable = reinterpret_cast<EnableFunc *>(_loadFunction(
 				"glEnable", failures));
 	disable = reinterpret_cast<DisableFunc *>(_loadFunction(
@@ -1670,9 +2162,34 @@ ATD::Gl::Gl()
 	}
 }
 
+bool ATD::Gl::hasUniformBuffers() const
+{
+	int support = _uniformBuffersSupport.load();
+	if (support < 0) {
+		bool isSupported = getUniformBlockIndex && 
+			uniformBlockBinding && 
+			bindBufferBase;
+		if (isSupported && !_isVersionAtLeast(
+					reinterpret_cast<const char *>(getString(GL_VERSION)), 
+					3, 1)) {
+			/* Below 3.1 there is no core profile, so the extensions 
+			 * string is available. */
+			isSupported = _hasExtension(
+					reinterpret_cast<const char *>(getString(GL_EXTENSIONS)), 
+					"GL_ARB_uniform_buffer_object");
+		}
+
+		support = isSupported ? 1 : 0;
+		_uniformBuffersSupport.store(support);
+	}
+	return support > 0;
+}
+
 
 /* One more global variable */
 
 ATD::Gl ATD::gl;
 
+thread_local ATD::Gl::State ATD::Gl::state(ATD::gl);
+
 
@@ -0,0 +1,191 @@
+/**
+ * @file      
+ * @brief     OpenGL context without a window.
+ * @details   ...
+ * @author    ArthurTheDigital (arthurthedigital@gmail.com)
+ * @copyright GPL v3.
+ * @since     $Id: $ */
+
+#include <ATD/Graphics/HeadlessContext.hpp>
+
+#include <ATD/Core/Printf.hpp>
+#include <ATD/Graphics/Gl.hpp>
+
+#define EGL_NO_X11
+#define MESA_EGL_NO_X11_HEADERS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <string.h>
+
+#include <stdexcept>
+
+
+/* ATD::HeadlessContext auxiliary: */
+
+/* Whether the space-separated extension list has the extension. */
+static bool _hasExtension(const char *extensions, const char *extension)
+{
+	if (!extensions) {
+		return false;
+	}
+
+	size_t length = ::strlen(extension);
+	for (const char *found = ::strstr(extensions, extension); found; 
+			found = ::strstr(found + length, extension)) {
+		if ((found == extensions || found[-1] == ' ') && 
+				(found[length] == ' ' || found[length] == '\0')) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/* Surfaceless Mesa display, if supported, otherwise the default one. */
+static EGLDisplay _getDisplay()
+{
+	const char *clientExtensions = 
+		eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+
+	if (_hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+		PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = 
+			reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+					eglGetProcAddress("eglGetPlatformDisplayEXT"));
+		if (getPlatformDisplay) {
+			EGLDisplay display = getPlatformDisplay(
+					EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, 
+					nullptr);
+			if (display != EGL_NO_DISPLAY) {
+				return display;
+			}
+		}
+	}
+
+	return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+
+/* ATD::HeadlessContext: */
+
+ATD::HeadlessContext::HeadlessContext()
+	: m_display(EGL_NO_DISPLAY)
+	, m_surface(EGL_NO_SURFACE)
+	, m_context(EGL_NO_CONTEXT)
+{
+	EGLDisplay display = _getDisplay();
+	if (display == EGL_NO_DISPLAY) {
+		throw std::runtime_error("'eglGetDisplay(..)' failure");
+	}
+
+	EGLint versionMajor = 0;
+	EGLint versionMinor = 0;
+	if (!eglInitialize(display, &versionMajor, &versionMinor)) {
+		throw std::runtime_error(
+				Aux::printf("'eglInitialize(..)' failure: 0x%04x", 
+					eglGetError()));
+	}
+	m_display = display;
+
+	/* Desktop OpenGL, same as the GLX window context. */
+	if (!eglBindAPI(EGL_OPENGL_API)) {
+		eglTerminate(display);
+		throw std::runtime_error("'eglBindAPI(..)' failure");
+	}
+
+	bool isSurfaceless = _hasExtension(
+			eglQueryString(display, EGL_EXTENSIONS), 
+			"EGL_KHR_surfaceless_context");
+
+	/* All the drawing goes into FrameBuffers, the surface (if any) is a 
+	 * placeholder. */
+	const EGLint configAttributes[] = {
+		EGL_SURFACE_TYPE, isSurfaceless ? 0 : EGL_PBUFFER_BIT, 
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, 
+		EGL_RED_SIZE, 8, 
+		EGL_GREEN_SIZE, 8, 
+		EGL_BLUE_SIZE, 8, 
+		EGL_DEPTH_SIZE, 24, 
+		EGL_NONE
+	};
+
+	EGLConfig config = nullptr;
+	EGLint configsNum = 0;
+	if (!eglChooseConfig(display, configAttributes, &config, 1, 
+				&configsNum) || configsNum < 1) {
+		eglTerminate(display);
+		throw std::runtime_error("'eglChooseConfig(..)' failure");
+	}
+
+	EGLContext context = eglCreateContext(display, config, 
+			EGL_NO_CONTEXT, nullptr);
+	if (context == EGL_NO_CONTEXT) {
+		eglTerminate(display);
+		throw std::runtime_error(
+				Aux::printf("'eglCreateContext(..)' failure: 0x%04x", 
+					eglGetError()));
+	}
+	m_context = context;
+
+	if (!isSurfaceless) {
+		const EGLint pbufferAttributes[] = {
+			EGL_WIDTH, 1, 
+			EGL_HEIGHT, 1, 
+			EGL_NONE
+		};
+
+		EGLSurface surface = eglCreatePbufferSurface(display, config, 
+				pbufferAttributes);
+		if (surface == EGL_NO_SURFACE) {
+			eglDestroyContext(display, context);
+			eglTerminate(display);
+			throw std::runtime_error(
+					"'eglCreatePbufferSurface(..)' failure");
+		}
+		m_surface = surface;
+	}
+
+	try {
+		makeCurrent();
+	} catch (...) {
+		if (m_surface != EGL_NO_SURFACE) {
+			eglDestroySurface(display, m_surface);
+		}
+		eglDestroyContext(display, context);
+		eglTerminate(display);
+		throw;
+	}
+}
+
+ATD::HeadlessContext::~HeadlessContext()
+{
+	if (eglGetCurrentContext() == m_context) {
+		gl.state.release();
+		eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, 
+				EGL_NO_CONTEXT);
+	}
+	if (m_surface != EGL_NO_SURFACE) {
+		eglDestroySurface(m_display, m_surface);
+	}
+	eglDestroyContext(m_display, m_context);
+	eglTerminate(m_display);
+}
+
+void ATD::HeadlessContext::makeCurrent()
+{
+	if (!eglMakeCurrent(m_display, m_surface, m_surface, m_context)) {
+		throw std::runtime_error(
+				Aux::printf("'eglMakeCurrent(..)' failure: 0x%04x", 
+					eglGetError()));
+	}
+
+	/* Fresh context: the shadow state may be left from the previous one. */
+	gl.state.reset();
+	gl.state.enable(Gl::TEXTURE_2D);
+}
+
+const char *ATD::HeadlessContext::renderer() const
+{
+	return reinterpret_cast<const char *>(gl.getString(Gl::RENDERER));
+}
+
+
@@ -0,0 +1,253 @@
+/**
+ * @file      
+ * @brief     Wrap around OpenGL element (index) buffer.
+ * @details   ...
+ * @author    ArthurTheDigital (arthurthedigital@gmail.com)
+ * @copyright GPL v3.
+ * @since     $Id: $ */
+
+#include <ATD/Graphics/IndexBuffer.hpp>
+
+#include <ATD/Core/Debug.hpp>
+#include <ATD/Core/Printf.hpp>
+
+#include <math.h>
+
+#include <stdexcept>
+
+
+/* ATD::IndexBuffer::Usage: */
+
+ATD::IndexBuffer::Usage::Usage(const ATD::IndexBuffer &buffer)
+	: m_prevBuffer(0)
+	, m_activated(false)
+{
+	m_prevBuffer = gl.state.buffer(Gl::ELEMENT_ARRAY_BUFFER);
+
+	if (m_prevBuffer != buffer.glId()) {
+		gl.state.bindBuffer(Gl::ELEMENT_ARRAY_BUFFER, buffer.glId());
+		m_activated = true;
+	}
+}
+
+ATD::IndexBuffer::Usage::~Usage()
+{
+	if (m_activated) {
+		gl.state.bindBuffer(Gl::ELEMENT_ARRAY_BUFFER, m_prevBuffer);
+	}
+}
+
+
+/* ATD::IndexBuffer auxiliary: */
+
+static const size_t _CACHE_SIZE = 32;
+
+static const float _CACHE_DECAY_POWER = 1.5f;
+static const float _LAST_TRIANGLE_SCORE = 0.75f;
+static const float _VALENCE_BOOST_SCALE = 2.f;
+static const float _VALENCE_BOOST_POWER = 0.5f;
+
+static float _vertexScore(int cachePosition, size_t remainingValence)
+{
+	if (!remainingValence) {
+		/* The vertex is not used by any triangle left. */
+		return -1.f;
+	}
+
+	float score = 0.f;
+	if (cachePosition >= 0) {
+		if (cachePosition < 3) {
+			/* Used by the last triangle: fixed score, so that the
+			 * algorithm does not prefer the strip-like order too much. */
+			score = _LAST_TRIANGLE_SCORE;
+		} else {
+			const float scaler = 1.f / static_cast<float>(_CACHE_SIZE - 3);
+			score = 1.f - static_cast<float>(cachePosition - 3) * scaler;
+			score = ::powf(score, _CACHE_DECAY_POWER);
+		}
+	}
+
+	/* Boost the vertices with few triangles left to get rid of them. */
+	score += _VALENCE_BOOST_SCALE * ::powf(
+			static_cast<float>(remainingValence), -_VALENCE_BOOST_POWER);
+
+	return score;
+}
+
+
+/* ATD::IndexBuffer: */
+
+ATD::IndexBuffer::IndexBuffer(const std::vector<uint16_t> &indices)
+	: m_bufferId(0)
+	, m_size(indices.size())
+	, m_type(INDEX_16)
+{
+	gl.genBuffers(1, &m_bufferId);
+	Usage use(*this);
+	gl.bufferData(Gl::ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * m_size, 
+			indices.data(), Gl::STATIC_DRAW);
+}
+
+ATD::IndexBuffer::IndexBuffer(const std::vector<uint32_t> &indices, 
+		bool compact)
+	: m_bufferId(0)
+	, m_size(indices.size())
+	, m_type(INDEX_32)
+{
+	if (compact) {
+		bool fits = true;
+		for (auto &index : indices) {
+			if (index > 0xFFFF) { fits = false; break; }
+		}
+
+		if (fits) { m_type = INDEX_16; }
+	}
+
+	gl.genBuffers(1, &m_bufferId);
+	Usage use(*this);
+
+	if (m_type == INDEX_16) {
+		std::vector<uint16_t> indices16(indices.begin(), indices.end());
+		gl.bufferData(Gl::ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * m_size, 
+				indices16.data(), Gl::STATIC_DRAW);
+	} else {
+		gl.bufferData(Gl::ELEMENT_ARRAY_BUFFER, sizeof(uint32_t) * m_size, 
+				indices.data(), Gl::STATIC_DRAW);
+	}
+}
+
+ATD::IndexBuffer::~IndexBuffer()
+{
+	gl.state.deleteBuffers(1, &m_bufferId);
+}
+
+ATD::Gl::Enum ATD::IndexBuffer::glType() const
+{
+	return m_type == INDEX_16 ? Gl::UNSIGNED_SHORT : Gl::UNSIGNED_INT;
+}
+
+std::vector<uint32_t> ATD::IndexBuffer::cacheOptimized(
+		const std::vector<uint32_t> &indices, 
+		size_t verticesNum)
+{
+	if (indices.size() % 3) {
+		throw std::runtime_error(Aux::printf(
+					"%lu indices do not make a triangle list", 
+					indices.size()));
+	}
+
+	const size_t trianglesNum = indices.size() / 3;
+
+	/* Vertex -> triangles adjacency, packed into a single array. */
+	std::vector<size_t> remainingValences(verticesNum, 0);
+	for (auto &index : indices) {
+		if (index >= verticesNum) {
+			throw std::runtime_error(Aux::printf(
+						"index %u out of %lu vertices", 
+						index, verticesNum));
+		}
+		remainingValences[index]++;
+	}
+
+	std::vector<size_t> adjacencyOffsets(verticesNum + 1, 0);
+	for (size_t vIndex = 0; vIndex < verticesNum; vIndex++) {
+		adjacencyOffsets[vIndex + 1] = 
+			adjacencyOffsets[vIndex] + remainingValences[vIndex];
+	}
+
+	std::vector<size_t> adjacency(indices.size(), 0);
+	{
+		std::vector<size_t> cursors(adjacencyOffsets.begin(), 
+				adjacencyOffsets.end() - 1);
+		for (size_t iIndex = 0; iIndex < indices.size(); iIndex++) {
+			adjacency[cursors[indices[iIndex]]++] = iIndex / 3;
+		}
+	}
+
+	std::vector<int> cachePositions(verticesNum, -1);
+	std::vector<float> vertexScores(verticesNum, 0.f);
+	for (size_t vIndex = 0; vIndex < verticesNum; vIndex++) {
+		vertexScores[vIndex] = _vertexScore(-1, remainingValences[vIndex]);
+	}
+
+	std::vector<float> triangleScores(trianglesNum, 0.f);
+	std::vector<bool> trianglesAdded(trianglesNum, false);
+	for (size_t tIndex = 0; tIndex < trianglesNum; tIndex++) {
+		for (size_t corner = 0; corner < 3; corner++) {
+			triangleScores[tIndex] += 
+				vertexScores[indices[tIndex * 3 + corner]];
+		}
+	}
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+
+	std::vector<uint32_t> cache;
+	std::vector<uint32_t> newCache;
+	cache.reserve(_CACHE_SIZE + 3);
+	newCache.reserve(_CACHE_SIZE + 3);
+
+	size_t scanCursor = 0;
+	for (size_t step = 0; step < trianglesNum; step++) {
+		/* Best triangle, adjacent to the cached vertices. */
+		size_t bestTriangle = trianglesNum;
+		float bestScore = -1.f;
+		for (auto &vIndex : cache) {
+			for (size_t aIndex = adjacencyOffsets[vIndex];
+					aIndex < adjacencyOffsets[vIndex + 1]; aIndex++) {
+				size_t tIndex = adjacency[aIndex];
+				if (!trianglesAdded[tIndex] && 
+						triangleScores[tIndex] > bestScore) {
+					bestTriangle = tIndex;
+					bestScore = triangleScores[tIndex];
+				}
+			}
+		}
+
+		/* Nothing adjacent: take the next triangle in the original order. */
+		if (bestTriangle == trianglesNum) {
+			while (trianglesAdded[scanCursor]) { scanCursor++; }
+			bestTriangle = scanCursor;
+		}
+
+		trianglesAdded[bestTriangle] = true;
+
+		/* Put the triangle vertices in front of the cache. */
+		newCache.clear();
+		for (size_t corner = 0; corner < 3; corner++) {
+			uint32_t vIndex = indices[bestTriangle * 3 + corner];
+			result.push_back(vIndex);
+			remainingValences[vIndex]--;
+			newCache.push_back(vIndex);
+		}
+		for (auto &vIndex : cache) {
+			if (vIndex != newCache[0] && 
+					vIndex != newCache[1] && 
+					vIndex != newCache[2]) {
+				newCache.push_back(vIndex);
+			}
+		}
+
+		/* Update scores of the vertices, which moved in the cache. */
+		for (size_t cIndex = 0; cIndex < newCache.size(); cIndex++) {
+			uint32_t vIndex = newCache[cIndex];
+			cachePositions[vIndex] = cIndex < _CACHE_SIZE ? 
+				static_cast<int>(cIndex) : -1;
+			float scoreDelta = _vertexScore(cachePositions[vIndex], 
+					remainingValences[vIndex]) - vertexScores[vIndex];
+			vertexScores[vIndex] += scoreDelta;
+
+			for (size_t aIndex = adjacencyOffsets[vIndex];
+					aIndex < adjacencyOffsets[vIndex + 1]; aIndex++) {
+				triangleScores[adjacency[aIndex]] += scoreDelta;
+			}
+		}
+
+		if (newCache.size() > _CACHE_SIZE) { newCache.resize(_CACHE_SIZE); }
+		cache.swap(newCache);
+	}
+
+	return result;
+}
+
+
@@ -0,0 +1,145 @@
+/**
+ * @file      
+ * @brief     Wrap around OpenGL vertex buffer (2D per-instance data).
+ * @details   ...
+ * @author    ArthurTheDigital (arthurthedigital@gmail.com)
+ * @copyright GPL v3.
+ * @since     $Id: $ */
+
+#include <ATD/Graphics/InstanceBuffer2D.hpp>
+
+
+/* ATD::InstanceBuffer2D::Usage: */
+
+ATD::InstanceBuffer2D::Usage::Usage(const ATD::InstanceBuffer2D &buffer)
+	: m_prevBuffer(0)
+	, m_activated(false)
+{
+	m_prevBuffer = gl.state.buffer(Gl::ARRAY_BUFFER);
+
+	if (m_prevBuffer != buffer.glId()) {
+		gl.state.bindBuffer(Gl::ARRAY_BUFFER, buffer.glId());
+		m_activated = true;
+	}
+}
+
+ATD::InstanceBuffer2D::Usage::~Usage()
+{
+	if (m_activated) {
+		gl.state.bindBuffer(Gl::ARRAY_BUFFER, m_prevBuffer);
+	}
+}
+
+
+/* ATD::InstanceBuffer2D::GlInstance: */
+
+ATD::InstanceBuffer2D::GlInstance::GlInstance(
+		const ATD::InstanceBuffer2D::Instance &instance)
+	: transformColumns()
+	, color(instance.color.glColor())
+{
+	for (int cIndex = 0; cIndex < 3; cIndex++) {
+		transformColumns[cIndex] = Vector3F(
+				instance.transform[0][cIndex], 
+				instance.transform[1][cIndex], 
+				instance.transform[2][cIndex]);
+	}
+}
+
+
+/* ATD::InstanceBuffer2D auxiliary: */
+
+static std::vector<ATD::InstanceBuffer2D::GlInstance> _glInstances(
+		const std::vector<ATD::InstanceBuffer2D::Instance> &instances)
+{
+	std::vector<ATD::InstanceBuffer2D::GlInstance> glInstances;
+	glInstances.reserve(instances.size());
+	for (auto &instance : instances) {
+		glInstances.push_back(
+				ATD::InstanceBuffer2D::GlInstance(instance));
+	}
+	return glInstances;
+}
+
+
+/* ATD::InstanceBuffer2D: */
+
+ATD::InstanceBuffer2D::InstanceBuffer2D(
+		const std::vector<ATD::InstanceBuffer2D::Instance> &instances)
+	: m_bufferId(0)
+	, m_size(instances.size())
+{
+	std::vector<GlInstance> glInstances = _glInstances(instances);
+
+	gl.genBuffers(1, &m_bufferId);
+	Usage use(*this);
+	gl.bufferData(Gl::ARRAY_BUFFER, sizeof(GlInstance) * m_size, 
+			glInstances.data(), Gl::DYNAMIC_DRAW);
+}
+
+ATD::InstanceBuffer2D::~InstanceBuffer2D()
+{
+	gl.state.deleteBuffers(1, &m_bufferId);
+}
+
+void ATD::InstanceBuffer2D::update(
+		const std::vector<ATD::InstanceBuffer2D::Instance> &instances)
+{
+	std::vector<GlInstance> glInstances = _glInstances(instances);
+	m_size = instances.size();
+
+	Usage use(*this);
+	/* Orphan the old storage, so that the draws, still using it, do not 
+	 * stall the upload. */
+	gl.bufferData(Gl::ARRAY_BUFFER, sizeof(GlInstance) * m_size, 
+			nullptr, Gl::DYNAMIC_DRAW);
+	gl.bufferSubData(Gl::ARRAY_BUFFER, 0, sizeof(GlInstance) * m_size, 
+			glInstances.data());
+}
+
+void ATD::InstanceBuffer2D::enableAttributes(ATD::Gl::Uint transformIndex, 
+		bool colorIsRequired, 
+		ATD::Gl::Uint colorIndex) const
+{
+	Usage use(*this);
+
+	/* mat3 attribute takes 3 consecutive locations, one per column. */
+	for (Gl::Uint cIndex = 0; cIndex < 3; cIndex++) {
+		gl.enableVertexAttribArray(transformIndex + cIndex);
+		gl.vertexAttribPointer(transformIndex + cIndex, 
+				static_cast<Gl::Int>(sizeof(Vector3F) / sizeof(float)), 
+				Gl::FLOAT, 
+				Gl::FALSE, 
+				static_cast<Gl::Sizei>(sizeof(GlInstance)), 
+				reinterpret_cast<const void *>(sizeof(Vector3F) * cIndex));
+		gl.vertexAttribDivisor(transformIndex + cIndex, 1);
+	}
+
+	if (colorIsRequired) {
+		gl.enableVertexAttribArray(colorIndex);
+		gl.vertexAttribPointer(colorIndex, 
+				static_cast<Gl::Int>(sizeof(Vector4F) / sizeof(float)), 
+				Gl::FLOAT, 
+				Gl::FALSE, 
+				static_cast<Gl::Sizei>(sizeof(GlInstance)), 
+				reinterpret_cast<const void *>(sizeof(Vector3F) * 3));
+		gl.vertexAttribDivisor(colorIndex, 1);
+	}
+}
+
+void ATD::InstanceBuffer2D::disableAttributes(ATD::Gl::Uint transformIndex, 
+		bool colorIsRequired, 
+		ATD::Gl::Uint colorIndex)
+{
+	for (Gl::Uint cIndex = 0; cIndex < 3; cIndex++) {
+		gl.vertexAttribDivisor(transformIndex + cIndex, 0);
+		gl.disableVertexAttribArray(transformIndex + cIndex);
+	}
+
+	if (colorIsRequired) {
+		gl.vertexAttribDivisor(colorIndex, 0);
+		gl.disableVertexAttribArray(colorIndex);
+	}
+}
+
+
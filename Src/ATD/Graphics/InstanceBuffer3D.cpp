@@ -0,0 +1,146 @@
+/**
+ * @file      
+ * @brief     Wrap around OpenGL vertex buffer (3D per-instance data).
+ * @details   ...
+ * @author    ArthurTheDigital (arthurthedigital@gmail.com)
+ * @copyright GPL v3.
+ * @since     $Id: $ */
+
+#include <ATD/Graphics/InstanceBuffer3D.hpp>
+
+
+/* ATD::InstanceBuffer3D::Usage: */
+
+ATD::InstanceBuffer3D::Usage::Usage(const ATD::InstanceBuffer3D &buffer)
+	: m_prevBuffer(0)
+	, m_activated(false)
+{
+	m_prevBuffer = gl.state.buffer(Gl::ARRAY_BUFFER);
+
+	if (m_prevBuffer != buffer.glId()) {
+		gl.state.bindBuffer(Gl::ARRAY_BUFFER, buffer.glId());
+		m_activated = true;
+	}
+}
+
+ATD::InstanceBuffer3D::Usage::~Usage()
+{
+	if (m_activated) {
+		gl.state.bindBuffer(Gl::ARRAY_BUFFER, m_prevBuffer);
+	}
+}
+
+
+/* ATD::InstanceBuffer3D::GlInstance: */
+
+ATD::InstanceBuffer3D::GlInstance::GlInstance(
+		const ATD::InstanceBuffer3D::Instance &instance)
+	: transformColumns()
+	, color(instance.color.glColor())
+{
+	for (int cIndex = 0; cIndex < 4; cIndex++) {
+		transformColumns[cIndex] = Vector4F(
+				instance.transform[0][cIndex], 
+				instance.transform[1][cIndex], 
+				instance.transform[2][cIndex], 
+				instance.transform[3][cIndex]);
+	}
+}
+
+
+/* ATD::InstanceBuffer3D auxiliary: */
+
+static std::vector<ATD::InstanceBuffer3D::GlInstance> _glInstances(
+		const std::vector<ATD::InstanceBuffer3D::Instance> &instances)
+{
+	std::vector<ATD::InstanceBuffer3D::GlInstance> glInstances;
+	glInstances.reserve(instances.size());
+	for (auto &instance : instances) {
+		glInstances.push_back(
+				ATD::InstanceBuffer3D::GlInstance(instance));
+	}
+	return glInstances;
+}
+
+
+/* ATD::InstanceBuffer3D: */
+
+ATD::InstanceBuffer3D::InstanceBuffer3D(
+		const std::vector<ATD::InstanceBuffer3D::Instance> &instances)
+	: m_bufferId(0)
+	, m_size(instances.size())
+{
+	std::vector<GlInstance> glInstances = _glInstances(instances);
+
+	gl.genBuffers(1, &m_bufferId);
+	Usage use(*this);
+	gl.bufferData(Gl::ARRAY_BUFFER, sizeof(GlInstance) * m_size, 
+			glInstances.data(), Gl::DYNAMIC_DRAW);
+}
+
+ATD::InstanceBuffer3D::~InstanceBuffer3D()
+{
+	gl.state.deleteBuffers(1, &m_bufferId);
+}
+
+void ATD::InstanceBuffer3D::update(
+		const std::vector<ATD::InstanceBuffer3D::Instance> &instances)
+{
+	std::vector<GlInstance> glInstances = _glInstances(instances);
+	m_size = instances.size();
+
+	Usage use(*this);
+	/* Orphan the old storage, so that the draws, still using it, do not 
+	 * stall the upload. */
+	gl.bufferData(Gl::ARRAY_BUFFER, sizeof(GlInstance) * m_size, 
+			nullptr, Gl::DYNAMIC_DRAW);
+	gl.bufferSubData(Gl::ARRAY_BUFFER, 0, sizeof(GlInstance) * m_size, 
+			glInstances.data());
+}
+
+void ATD::InstanceBuffer3D::enableAttributes(ATD::Gl::Uint transformIndex, 
+		bool colorIsRequired, 
+		ATD::Gl::Uint colorIndex) const
+{
+	Usage use(*this);
+
+	/* mat4 attribute takes 4 consecutive locations, one per column. */
+	for (Gl::Uint cIndex = 0; cIndex < 4; cIndex++) {
+		gl.enableVertexAttribArray(transformIndex + cIndex);
+		gl.vertexAttribPointer(transformIndex + cIndex, 
+				static_cast<Gl::Int>(sizeof(Vector4F) / sizeof(float)), 
+				Gl::FLOAT, 
+				Gl::FALSE, 
+				static_cast<Gl::Sizei>(sizeof(GlInstance)), 
+				reinterpret_cast<const void *>(sizeof(Vector4F) * cIndex));
+		gl.vertexAttribDivisor(transformIndex + cIndex, 1);
+	}
+
+	if (colorIsRequired) {
+		gl.enableVertexAttribArray(colorIndex);
+		gl.vertexAttribPointer(colorIndex, 
+				static_cast<Gl::Int>(sizeof(Vector4F) / sizeof(float)), 
+				Gl::FLOAT, 
+				Gl::FALSE, 
+				static_cast<Gl::Sizei>(sizeof(GlInstance)), 
+				reinterpret_cast<const void *>(sizeof(Vector4F) * 4));
+		gl.vertexAttribDivisor(colorIndex, 1);
+	}
+}
+
+void ATD::InstanceBuffer3D::disableAttributes(ATD::Gl::Uint transformIndex, 
+		bool colorIsRequired, 
+		ATD::Gl::Uint colorIndex)
+{
+	for (Gl::Uint cIndex = 0; cIndex < 4; cIndex++) {
+		gl.vertexAttribDivisor(transformIndex + cIndex, 0);
+		gl.disableVertexAttribArray(transformIndex + cIndex);
+	}
+
+	if (colorIsRequired) {
+		gl.vertexAttribDivisor(colorIndex, 0);
+		gl.disableVertexAttribArray(colorIndex);
+	}
+}
+
+
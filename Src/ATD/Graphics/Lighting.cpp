@@ -0,0 +1,241 @@
+/**
+ * @file      
+ * @brief     Light sources for the lighting Shader3D.
+ * @details   ...
+ * @author    ArthurTheDigital (arthurthedigital@gmail.com)
+ * @copyright GPL v3.
+ * @since     $Id: $ */
+
+#include <ATD/Graphics/Lighting.hpp>
+
+
+/* ATD::Lighting::Usage: */
+
+ATD::Lighting::Usage::Usage(const ATD::Lighting &lighting)
+	: m_prevTexture(0)
+	, m_prevUnit(Gl::TEXTURE0)
+	, m_isTexture(lighting.storage() == Shader3D::LightVariant::TEXTURE)
+	, m_activated(false)
+{
+	if (m_isTexture) {
+		m_prevUnit = gl.state.activeTextureUnit();
+		gl.state.activeTexture(static_cast<Gl::Enum>(
+					Gl::TEXTURE0 + Shader3D::LIGHT_TEXTURE_UNIT));
+
+		m_prevTexture = gl.state.texture(Gl::TEXTURE_2D);
+		if (m_prevTexture != lighting.m_textureId) {
+			gl.state.bindTexture(Gl::TEXTURE_2D, lighting.m_textureId);
+			m_activated = true;
+		}
+	} else {
+		/* The binding point is reserved for the lights, so it is not
+		 * restored. */
+		gl.bindBufferBase(Gl::UNIFORM_BUFFER, 
+				Shader3D::LIGHT_BUFFER_BINDING, 
+				lighting.m_bufferId);
+	}
+}
+
+ATD::Lighting::Usage::~Usage()
+{
+	if (m_isTexture) {
+		if (m_activated) {
+			gl.state.bindTexture(Gl::TEXTURE_2D, m_prevTexture);
+		}
+		gl.state.activeTexture(m_prevUnit);
+	}
+}
+
+
+/* ATD::Lighting auxiliary: */
+
+/* Light texture rows, the shader gets the width by textureSize(). */
+static const size_t _TEXTURE_WIDTH = 256;
+
+static size_t _maxBufferTexels()
+{
+	ATD::Gl::Int maxBlockSize = 0;
+	ATD::gl.getIntegerv(ATD::Gl::MAX_UNIFORM_BLOCK_SIZE, &maxBlockSize);
+	return static_cast<size_t>(maxBlockSize) / sizeof(ATD::Vector4F);
+}
+
+
+/* ATD::Lighting: */
+
+ATD::Lighting::Lighting(bool instanced)
+	: m_storage(Shader3D::LightVariant::TEXTURE)
+	, m_bufferId(0)
+	, m_textureId(0)
+	, m_variants(instanced)
+	, m_dirLights()
+	, m_pointLights()
+	, m_spotLights()
+	, m_specularPower(1.f)
+	, m_cameraPosition()
+	, m_texels()
+	, m_isChanged(true)
+{
+	if (gl.hasUniformBuffers()) {
+		m_storage = Shader3D::LightVariant::UNIFORM_BUFFER;
+		gl.genBuffers(1, &m_bufferId);
+	} else {
+		gl.genTextures(1, &m_textureId);
+	}
+
+	update();
+}
+
+ATD::Lighting::~Lighting()
+{
+	if (m_bufferId) {
+		gl.state.deleteBuffers(1, &m_bufferId);
+	}
+	if (m_textureId) {
+		gl.state.deleteTextures(1, &m_textureId);
+	}
+}
+
+void ATD::Lighting::setDirLights(
+		const std::vector<ATD::Lighting::DirLight> &dirLights)
+{
+	m_dirLights = dirLights;
+	m_isChanged = true;
+}
+
+void ATD::Lighting::setPointLights(
+		const std::vector<ATD::Lighting::PointLight> &pointLights)
+{
+	m_pointLights = pointLights;
+	m_isChanged = true;
+}
+
+void ATD::Lighting::setSpotLights(
+		const std::vector<ATD::Lighting::SpotLight> &spotLights)
+{
+	m_spotLights = spotLights;
+	m_isChanged = true;
+}
+
+void ATD::Lighting::setSpecularPower(float specularPower)
+{
+	m_specularPower = specularPower;
+	m_isChanged = true;
+}
+
+void ATD::Lighting::setCameraPosition(const ATD::Vector3F &cameraPosition)
+{
+	m_cameraPosition = cameraPosition;
+	m_isChanged = true;
+}
+
+void ATD::Lighting::update()
+{
+	if (!m_isChanged) {
+		return;
+	}
+
+	pack();
+
+	/* Too many lights for a uniform block: switch to the texture. */
+	if (m_storage == Shader3D::LightVariant::UNIFORM_BUFFER && 
+			m_texels.size() > _maxBufferTexels()) {
+		gl.state.deleteBuffers(1, &m_bufferId);
+		m_bufferId = 0;
+		gl.genTextures(1, &m_textureId);
+		m_storage = Shader3D::LightVariant::TEXTURE;
+	}
+
+	if (m_storage == Shader3D::LightVariant::UNIFORM_BUFFER) {
+		Usage use(*this);
+		gl.bufferData(Gl::UNIFORM_BUFFER, 
+				sizeof(Vector4F) * m_texels.size(), 
+				m_texels.data(), Gl::DYNAMIC_DRAW);
+	} else {
+		size_t width = m_texels.size() < _TEXTURE_WIDTH ? 
+			m_texels.size() : _TEXTURE_WIDTH;
+		size_t height = (m_texels.size() + width - 1) / width;
+		m_texels.resize(width * height, Vector4F());
+
+		Usage use(*this);
+		gl.texParameteri(Gl::TEXTURE_2D, Gl::TEXTURE_MIN_FILTER, 
+				static_cast<Gl::Int>(Gl::NEAREST));
+		gl.texParameteri(Gl::TEXTURE_2D, Gl::TEXTURE_MAG_FILTER, 
+				static_cast<Gl::Int>(Gl::NEAREST));
+		gl.texImage2D(Gl::TEXTURE_2D, 0, 
+				static_cast<Gl::Int>(Gl::RGBA32F), 
+				static_cast<Gl::Sizei>(width), 
+				static_cast<Gl::Sizei>(height), 
+				0, Gl::RGBA, Gl::FLOAT, m_texels.data());
+	}
+
+	m_isChanged = false;
+}
+
+ATD::Shader3D::Ptr ATD::Lighting::shader(bool specular, bool vertexColor)
+{
+	return m_variants.get(Shader3D::LightVariant(
+				static_cast<unsigned>(m_dirLights.size()), 
+				static_cast<unsigned>(m_pointLights.size()), 
+				static_cast<unsigned>(m_spotLights.size()), 
+				specular, 
+				vertexColor, 
+				m_storage));
+}
+
+void ATD::Lighting::pack()
+{
+	/* Layout is described in Shader3D::LIGHT_FRAGMENT_SOURCE_TEMPLATE. */
+	m_texels.clear();
+	m_texels.push_back(Vector4F(
+				static_cast<float>(m_dirLights.size()), 
+				static_cast<float>(m_pointLights.size()), 
+				static_cast<float>(m_spotLights.size()), 
+				m_specularPower));
+	m_texels.push_back(Vector4F(m_cameraPosition.x, 
+				m_cameraPosition.y, 
+				m_cameraPosition.z, 
+				0.f));
+
+	auto packLight = [this](const Light &lt, 
+			const Vector3F &position, 
+			const Vector3F &direction, 
+			const Vector3F &attenuation, 
+			float cutoff) {
+		Vector3F color = lt.color.glColor3();
+		m_texels.push_back(Vector4F(color.x, color.y, color.z, 
+					lt.ambient));
+		m_texels.push_back(Vector4F(position.x, position.y, position.z, 
+					lt.diffuse));
+		m_texels.push_back(Vector4F(direction.x, direction.y, direction.z, 
+					lt.specular));
+		m_texels.push_back(Vector4F(attenuation.x, 
+					attenuation.y, 
+					attenuation.z, 
+					cutoff));
+	};
+
+	for (auto &dirLight : m_dirLights) {
+		packLight(dirLight.lt, Vector3F(), dirLight.direction, 
+				Vector3F(), 0.f);
+	}
+	for (auto &pointLight : m_pointLights) {
+		packLight(pointLight.lt, pointLight.position, Vector3F(), 
+				pointLight.attenuation, 0.f);
+	}
+	for (auto &spotLight : m_spotLights) {
+		packLight(spotLight.plt.lt, spotLight.plt.position, 
+				spotLight.direction, spotLight.plt.attenuation, 
+				spotLight.cutoff);
+	}
+
+	/* The uniform block of the shader variant may be larger, than the
+	 * lights take, while the buffer shall not be smaller. */
+	size_t texelsNum = Shader3D::LightVariants::covering(
+			Shader3D::LightVariant(
+				static_cast<unsigned>(m_dirLights.size()), 
+				static_cast<unsigned>(m_pointLights.size()), 
+				static_cast<unsigned>(m_spotLights.size()))).texelsNum();
+	m_texels.resize(texelsNum, Vector4F());
+}
+
+
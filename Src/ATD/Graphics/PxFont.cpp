@@ -8,12 +8,11 @@
 
 #include <ATD/Graphics/PxFont.hpp>
 
-#include <ATD/Core/Printf.hpp>
+#include <ATD/Core/JsonDataInternal.hpp>
+#include <ATD/Core/MinMax.hpp>
+#include <ATD/Graphics/VertexBuffer2D.hpp>
 
-#include <nlohmann/json.hpp>
-
-#include <fstream>
-#include <stdexcept>
+#include <algorithm>
 
 
 /* ATD::PxFont::Glyph: */
@@ -30,6 +29,19 @@ ATD::PxFont::Glyph::Glyph(const ATD::RectL &textureRect,
 {}
 
 
+/* ATD::PxFont constants: */
+
+const ATD::Unicode::Glyph ATD::PxFont::DENSE_GLYPHS_MAX_NUM = 0x10000;
+
+const size_t ATD::PxFont::LAYOUT_CACHE_MAX_SIZE = 256;
+
+
+/* ATD::PxFont auxiliary: */
+
+/* Two triangles per glyph. */
+static const size_t _VERTICES_PER_GLYPH = 6;
+
+
 /* ATD::PxFont: */
 
 ATD::PxFont::PxFont()
@@ -37,6 +49,11 @@ ATD::PxFont::PxFont()
 	, m_dftGlyph(RectL(Vector2L(1, 1)), Vector2L(1, 1))
 	, m_glyphs()
 	, m_texturePtr(nullptr)
+	, m_tableGlyphs()
+	, m_denseIndices()
+	, m_sparseIndices()
+	, m_layouts()
+	, m_layoutsMtx()
 	, m_imagePtr(new Image(Vector2S(1, 1)))
 {
 	Loadable::addDependency(static_cast<Loadable *>(m_imagePtr.get()));
@@ -48,39 +65,115 @@ ATD::PxFont::PxFont()
 	 * segmentation fault. */
 }
 
+ATD::PxFont::PxFont(const ATD::PxFont &other)
+	: Loadable(other)
+	, m_dftGlyph(other.m_dftGlyph)
+	, m_glyphs(other.m_glyphs)
+	, m_texturePtr(other.m_texturePtr)
+	, m_tableGlyphs(other.m_tableGlyphs)
+	, m_denseIndices(other.m_denseIndices)
+	, m_sparseIndices(other.m_sparseIndices)
+	, m_layouts()
+	, m_layoutsMtx()
+	, m_imagePtr(other.m_imagePtr)
+{}
+
+ATD::PxFont &ATD::PxFont::operator=(const ATD::PxFont &other)
+{
+	if (this != &other) {
+		Loadable::operator=(other);
+		m_dftGlyph = other.m_dftGlyph;
+		m_glyphs = other.m_glyphs;
+		m_texturePtr = other.m_texturePtr;
+		m_tableGlyphs = other.m_tableGlyphs;
+		m_denseIndices = other.m_denseIndices;
+		m_sparseIndices = other.m_sparseIndices;
+		m_imagePtr = other.m_imagePtr;
+
+		/* The cached layouts belong to the old glyphs. */
+		std::lock_guard<std::mutex> lock(m_layoutsMtx);
+		m_layouts.clear();
+	}
+	return *this;
+}
+
 const ATD::PxFont::Glyph &ATD::PxFont::getGlyph(
 		const ATD::Unicode::Glyph &glyph) const
 {
-	auto gIter = m_glyphs.find(glyph);
-	if (gIter != m_glyphs.end()) {
-		return gIter->second;
+	if (glyph < m_denseIndices.size()) {
+		return m_tableGlyphs[m_denseIndices[glyph]];
+	}
+
+	auto gIter = std::lower_bound(m_sparseIndices.begin(), 
+			m_sparseIndices.end(), glyph, 
+			[](const std::pair<Unicode::Glyph, uint32_t> &entry, 
+				const Unicode::Glyph &key) -> bool {
+				return entry.first < key;
+			});
+	if (gIter != m_sparseIndices.end() && gIter->first == glyph) {
+		return m_tableGlyphs[gIter->second];
 	} else {
 		return m_dftGlyph;
 	}
 }
 
-void ATD::PxFont::onLoad(const ATD::Fs::Path &filename)
+ATD::PxFont::Layout::CPtr ATD::PxFont::layout(
+		const ATD::Unicode &unicode) const
 {
-	/* Open .json file, containing PxFont data. */
-	std::ifstream file(filename.native());
-	if (!file.is_open()) {
-		throw std::runtime_error(
-				Aux::printf(
-					"Failed to open %s for reading as PxFont", 
-					filename.native().c_str()));
+	{
+		std::lock_guard<std::mutex> lock(m_layoutsMtx);
+		auto layoutIter = m_layouts.find(unicode);
+		if (layoutIter != m_layouts.end()) {
+			return layoutIter->second;
+		}
+	}
+
+	/* Built unlocked: the same string, laid out concurrently, is just 
+	 * built twice. */
+	std::shared_ptr<Layout> newLayoutPtr(new Layout());
+	Layout &newLayout = *newLayoutPtr;
+
+	/* Obtain all the positions, assuming joint (0, 0). */
+	newLayout.positions.reserve(unicode.size());
+	Vector2L joint;
+	for (size_t uIndex = 0; uIndex < unicode.size(); uIndex++) {
+		const Glyph &glyph = getGlyph(unicode[uIndex]);
+		Vector2L position = joint - glyph.leftJoint();
+		joint = position + glyph.rightJoint();
+
+		newLayout.topLeft.x = min<long>(position.x, newLayout.topLeft.x);
+		newLayout.topLeft.y = min<long>(position.y, newLayout.topLeft.y);
+		newLayout.positions.push_back(position);
 	}
 
-	/* Obtain the size of the file. */
-	file.seekg(0, std::ios_base::end);
-	size_t fileSize = static_cast<size_t>(file.tellg());
-	file.seekg(0, std::ios_base::beg);
+	/* Offset all the glyphs, so the top left corner will become (0, 0) */
+	VertexBuffer2D::Builder builder(m_texturePtr->size(), 
+			unicode.size() * _VERTICES_PER_GLYPH);
+	Vector2L bottomRight;
+	for (size_t uIndex = 0; uIndex < unicode.size(); uIndex++) {
+		const RectL &textureRect = getGlyph(unicode[uIndex]).textureRect();
+		Vector2L position = newLayout.positions[uIndex] - newLayout.topLeft;
 
-	/* Read the whole .json file into jsonBuf. */
-	std::string jDataBuf(fileSize, '\0');
-	file.read(&jDataBuf[0], jDataBuf.size());
-	file.close();
+		builder.addRect(static_cast<Vector2F>(position), textureRect);
+
+		bottomRight.x = max<long>(position.x + textureRect.w, bottomRight.x);
+		bottomRight.y = max<long>(position.y + textureRect.h, bottomRight.y);
+	}
+	newLayout.bounds = RectL(bottomRight);
+	newLayout.glVertices = builder.glVertices();
 
-	auto jData = nlohmann::json::parse(&jDataBuf[0]);
+	std::lock_guard<std::mutex> lock(m_layoutsMtx);
+	if (m_layouts.size() >= LAYOUT_CACHE_MAX_SIZE) {
+		m_layouts.clear();
+	}
+	m_layouts[unicode] = newLayoutPtr;
+	return newLayoutPtr;
+}
+
+void ATD::PxFont::onLoad(const ATD::Fs::Path &filename)
+{
+	/* PxFont data is JSON, CBOR or MessagePack. */
+	auto jData = JsonDataInternal::load(filename);
 
 	/* Order is optional (and is not used in PxFont now). */
 	/*
@@ -161,6 +254,7 @@ void ATD::PxFont::onLoad(const ATD::Fs::Path &filename)
 void ATD::PxFont::onLoadFinished()
 {
 	updateTextureFromImage();
+	updateGlyphTable();
 }
 
 void ATD::PxFont::onSave(const ATD::Fs::Path &filename) const
@@ -230,19 +324,11 @@ void ATD::PxFont::onSave(const ATD::Fs::Path &filename) const
 		jGlyphs.push_back(jGlyph);
 	}
 
-	std::string jDataBuf = jData.dump();
-
-	/* Rewrite the json file, containing PxFont data. */
-	std::ofstream file(filename.native());
-	if (!file.is_open()) {
-		throw std::runtime_error(
-				Aux::printf(
-					"Failed to open %s for writing as PxFont", 
-					filename.native().c_str()));
-	}
+	jData["glyphs"] = jGlyphs;
 
-	file.write(&jDataBuf[0], jDataBuf.size());
-	file.close();
+	/* Rewrite the file, containing PxFont data, in the format of its 
+	 * extension. */
+	JsonDataInternal::save(filename, jData);
 }
 
 void ATD::PxFont::updateTextureFromImage()
@@ -252,4 +338,31 @@ void ATD::PxFont::updateTextureFromImage()
 	}
 }
 
+void ATD::PxFont::updateGlyphTable()
+{
+	m_tableGlyphs.clear();
+	m_denseIndices.clear();
+	m_sparseIndices.clear();
+
+	m_tableGlyphs.reserve(m_glyphs.size() + 1);
+	m_tableGlyphs.push_back(m_dftGlyph);
+
+	/* m_glyphs is sorted, so the dense keys come first. */
+	for (auto &glyphPair : m_glyphs) {
+		uint32_t index = static_cast<uint32_t>(m_tableGlyphs.size());
+		m_tableGlyphs.push_back(glyphPair.second);
+
+		if (glyphPair.first < DENSE_GLYPHS_MAX_NUM) {
+			m_denseIndices.resize(glyphPair.first + 1, 0);
+			m_denseIndices[glyphPair.first] = index;
+		} else {
+			m_sparseIndices.push_back(std::make_pair(glyphPair.first, index));
+		}
+	}
+
+	/* Layouts depend on the glyphs and the texture size. */
+	std::lock_guard<std::mutex> lock(m_layoutsMtx);
+	m_layouts.clear();
+}
+
 
@@ -13,77 +13,8 @@
 
 /* PxText auxiliary: */
 
-static std::vector<ATD::Vertex2D> _verticesFromGlyph(
-		const ATD::PxFont::Glyph &glyph, 
-		ATD::Vector2L &joint)
-{
-	ATD::Vector2L size(glyph.textureRect().w, glyph.textureRect().h);
-	ATD::Vector2L position = joint - glyph.leftJoint();
-	joint = position + glyph.rightJoint();
-
-	std::vector<ATD::Vector2L> positions = 
-		ATD::RectL(position, size).vertices();
-
-	std::vector<ATD::Vector2L> texCoords = 
-		glyph.textureRect().vertices();
-
-	const std::vector<ATD::Vertex2D> vtxSamples = {
-		ATD::Vertex2D(static_cast<ATD::Vector2D>(positions[0]), texCoords[0]), 
-		ATD::Vertex2D(static_cast<ATD::Vector2D>(positions[1]), texCoords[1]), 
-		ATD::Vertex2D(static_cast<ATD::Vector2D>(positions[2]), texCoords[2]), 
-		ATD::Vertex2D(static_cast<ATD::Vector2D>(positions[3]), texCoords[3])
-	};
-
-	const std::vector<ATD::Vertex2D> vertices = {
-		vtxSamples[3], 
-		vtxSamples[0], 
-		vtxSamples[2], 
-
-		vtxSamples[1], 
-		vtxSamples[2], 
-		vtxSamples[0]
-	};
-
-	return vertices;
-}
-
-static std::vector<ATD::Vertex2D> _verticesFromUnicode(
-		const ATD::Unicode &unicode, 
-		const ATD::PxFont &pxFont)
-{
-	std::vector<ATD::Vertex2D> vertices;
-
-	/* Obtain all the vertices, assuming joint (0, 0). */
-	ATD::Vector2L topLeft;
-	ATD::Vector2L joint;
-	for (size_t uIndex = 0; uIndex < unicode.size(); uIndex++) {
-		std::vector<ATD::Vertex2D> verticesNew = 
-			_verticesFromGlyph(pxFont.getGlyph(unicode[uIndex]), joint);
-
-		for (auto &vertex : verticesNew) {
-			topLeft.x = 
-				ATD::min<long>(
-						static_cast<ATD::Vector2L>(vertex.position).x, 
-						topLeft.x);
-
-			topLeft.y = 
-				ATD::min<long>(
-						static_cast<ATD::Vector2L>(vertex.position).y, 
-						topLeft.y);
-		}
-
-		vertices.insert(vertices.end(), 
-				verticesNew.begin(), 
-				verticesNew.end());
-	}
-
-	/* Offset all the vertices, so the top left corner will become (0, 0) */
-	for (auto &vertex : vertices) {
-		vertex.position -= topLeft;
-	}
-
-	return vertices;
-}
+/* Two triangles per glyph. */
+static const size_t _VERTICES_PER_GLYPH = 6;
 
 
 /* ATD::PxText: */
@@ -92,10 +23,30 @@ ATD::PxText::PxText(ATD::PxFont::CPtr pxFontPtr, const ATD::Unicode &unicode)
 	: FrameBuffer::Drawable2D()
 	, m_unicode(unicode)
 	, m_pxFontPtr(pxFontPtr)
-	, m_vertices(_verticesFromUnicode(m_unicode, *m_pxFontPtr), 
-			m_pxFontPtr->texturePtr()->size())
+	, m_positions()
+	, m_topLeft()
+	, m_builder(m_pxFontPtr->texturePtr()->size())
+	, m_vertices(std::vector<Vertex2D::GlVertex>())
+{
+	relayout(0);
+}
+
+void ATD::PxText::setText(const ATD::Unicode &unicode)
+{
+	size_t first = 0;
+	while (first < m_unicode.size() && 
+			first < unicode.size() && 
+			m_unicode[first] == unicode[first]) {
+		first++;
+	}
+
+	if (first == m_unicode.size() && first == unicode.size()) {
+		return;
+	}
 
-{}
+	m_unicode = unicode;
+	relayout(first);
+}
 
 void ATD::PxText::drawSelf(ATD::FrameBuffer &target) const
 {
@@ -103,4 +54,54 @@ void ATD::PxText::drawSelf(ATD::FrameBuffer &target) const
 	target.draw(m_vertices, m_transform);
 }
 
+void ATD::PxText::relayout(size_t first)
+{
+	if (first == 0) {
+		/* Whole text: repeated strings are laid out by the font once. */
+		PxFont::Layout::CPtr layoutPtr = m_pxFontPtr->layout(m_unicode);
+		m_positions = layoutPtr->positions;
+		m_topLeft = layoutPtr->topLeft;
+
+		m_builder.clear();
+		m_builder.append(layoutPtr->glVertices);
+		m_vertices.update(m_builder.glVertices());
+		return;
+	}
+
+	/* The glyphs before the first changed one keep their positions. */
+	m_positions.resize(m_unicode.size());
+	Vector2L joint;
+	if (first > 0) {
+		joint = m_positions[first - 1] + 
+			m_pxFontPtr->getGlyph(m_unicode[first - 1]).rightJoint();
+	}
+	for (size_t uIndex = first; uIndex < m_unicode.size(); uIndex++) {
+		const PxFont::Glyph &glyph = m_pxFontPtr->getGlyph(m_unicode[uIndex]);
+		m_positions[uIndex] = joint - glyph.leftJoint();
+		joint = m_positions[uIndex] + glyph.rightJoint();
+	}
+
+	/* The top left corner shall become (0, 0). If it moves, all the glyphs
+	 * are shifted. */
+	Vector2L topLeft;
+	for (auto &position : m_positions) {
+		topLeft.x = min<long>(position.x, topLeft.x);
+		topLeft.y = min<long>(position.y, topLeft.y);
+	}
+	if (topLeft != m_topLeft) {
+		m_topLeft = topLeft;
+		first = 0;
+	}
+
+	m_builder.truncate(first * _VERTICES_PER_GLYPH);
+	m_builder.reserve(m_unicode.size() * _VERTICES_PER_GLYPH);
+	for (size_t uIndex = first; uIndex < m_unicode.size(); uIndex++) {
+		m_builder.addRect(
+				static_cast<Vector2F>(m_positions[uIndex] - m_topLeft), 
+				m_pxFontPtr->getGlyph(m_unicode[uIndex]).textureRect());
+	}
+
+	m_vertices.update(m_builder.glVertices(), first * _VERTICES_PER_GLYPH);
+}
+
 
@@ -0,0 +1,277 @@
+/**
+ * @file      
+ * @brief     Deferred, state-sorted drawing to frame buffers.
+ * @details   ...
+ * @author    ArthurTheDigital (arthurthedigital@gmail.com)
+ * @copyright GPL v3.
+ * @since     $Id: $ */
+
+#include <ATD/Graphics/RenderQueue.hpp>
+
+#include <ATD/Core/Printf.hpp>
+
+#include <string.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+
+/* ATD::RenderQueue auxiliary: */
+
+/* Key layout, from the most significant bits:
+ * - opaque:      target:8 | 0:1 | shader:15 | texture:16 | order:24
+ * - translucent: target:8 | 1:1 | order:24  | shader:15 | texture:16 */
+static const uint64_t _TARGETS_MAX_NUM = 1 << 8;
+static const uint64_t _SHADERS_MAX_NUM = 1 << 15;
+static const uint64_t _TEXTURES_MAX_NUM = 1 << 16;
+static const uint32_t _ORDER_MASK = 0xFFFFFF;
+
+/* Non-negative floats compare same, as their bit patterns. The sign bit
+ * and low mantissa bits are dropped to fit 24 bits. */
+static uint32_t _depthOrder(float depth)
+{
+	if (!(depth > 0.f)) {
+		return 0;
+	}
+
+	uint32_t bits = 0;
+	::memcpy(&bits, &depth, sizeof(bits));
+	return (bits >> 7) & _ORDER_MASK;
+}
+
+
+/* ATD::RenderQueue: */
+
+ATD::RenderQueue::RenderQueue()
+	: m_commands()
+	, m_targetIndices()
+	, m_shaderIndices()
+	, m_textureIndices()
+{}
+
+void ATD::RenderQueue::draw(ATD::FrameBuffer &target, 
+		const ATD::VertexBuffer2D &vertices2D, 
+		const ATD::Transform2D &transform, 
+		ATD::Texture::CPtr texturePtr, 
+		bool translucent)
+{
+	Command command;
+	command.target = &target;
+	command.shaderPtr = target.currentShader2D();
+	command.texturePtr = texturePtr;
+	command.translucent = translucent;
+	command.vertices2D = &vertices2D;
+	command.transform2D = transform;
+	command.vertices3D = nullptr;
+
+	/* Painter's order for the translucent, any for the opaque. */
+	uint32_t order = translucent ? 
+		static_cast<uint32_t>(m_commands.size()) & _ORDER_MASK : 0;
+
+	push(command, order);
+}
+
+void ATD::RenderQueue::draw(ATD::FrameBuffer &target, 
+		const ATD::VertexBuffer3D &vertices3D, 
+		const ATD::Transform3D &transform, 
+		ATD::Texture::CPtr texturePtr, 
+		bool translucent)
+{
+	Command command;
+	command.target = &target;
+	command.shaderPtr = target.currentShader3D();
+	command.texturePtr = texturePtr;
+	command.translucent = translucent;
+	command.vertices2D = nullptr;
+	command.vertices3D = &vertices3D;
+	command.transform3D = transform;
+
+	/* Projection3D puts the distance along the view axis into w. */
+	const Vector3D &offset = transform.offset();
+	Vector4F viewPos = target.projection3D().matrix() * Vector4F(
+			static_cast<float>(offset.x), 
+			static_cast<float>(offset.y), 
+			static_cast<float>(offset.z), 
+			1.f);
+
+	/* Front-to-back for the opaque, back-to-front for the translucent. */
+	uint32_t order = _depthOrder(viewPos.w);
+	if (translucent) {
+		order = _ORDER_MASK - order;
+	}
+
+	push(command, order);
+}
+
+void ATD::RenderQueue::submit()
+{
+	/* Stable: equal keys keep the call order. */
+	std::stable_sort(m_commands.begin(), m_commands.end(), 
+			[](const Command &lhs, const Command &rhs) -> bool {
+				return lhs.key < rhs.key;
+			});
+
+	/* Usages are nested the same way, as in FrameBuffer::draw(), so
+	 * that the ones there find everything bound and do nothing. */
+	std::unique_ptr<FrameBuffer::Usage> useTargetPtr;
+	std::unique_ptr<Shader::Usage> useShaderPtr;
+	std::unique_ptr<Texture::Usage> useTexturePtr;
+
+	Shader2D::Ptr prevShader2DPtr;
+	Shader3D::Ptr prevShader3DPtr;
+
+	bool prevBlend = gl.state.isEnabled(Gl::BLEND);
+	Gl::Int prevBlendSrc = 0;
+	Gl::Int prevBlendDst = 0;
+	Gl::Boolean prevDepthMask = Gl::TRUE;
+	bool blendIsSet = false;
+
+	const Command *prevCommand = nullptr;
+	for (auto &command : m_commands) {
+		bool targetChanged = !prevCommand || 
+			command.target != prevCommand->target;
+		bool shaderChanged = targetChanged || 
+			command.shaderPtr != prevCommand->shaderPtr;
+		bool textureChanged = shaderChanged || 
+			command.texturePtr != prevCommand->texturePtr;
+
+		if (textureChanged) { useTexturePtr.reset(); }
+		if (shaderChanged) { useShaderPtr.reset(); }
+
+		if (targetChanged) {
+			if (prevCommand) {
+				prevCommand->target->setShader2D(prevShader2DPtr);
+				prevCommand->target->setShader3D(prevShader3DPtr);
+			}
+
+			useTargetPtr.reset();
+			useTargetPtr.reset(new FrameBuffer::Usage(*command.target));
+
+			prevShader2DPtr = command.target->currentShader2D();
+			prevShader3DPtr = command.target->currentShader3D();
+		}
+
+		if (shaderChanged) {
+			if (command.vertices2D) {
+				command.target->setShader2D(
+						std::static_pointer_cast<Shader2D>(
+							command.shaderPtr));
+			} else {
+				command.target->setShader3D(
+						std::static_pointer_cast<Shader3D>(
+							command.shaderPtr));
+			}
+			useShaderPtr.reset(new Shader::Usage(*command.shaderPtr));
+		}
+
+		if (textureChanged && command.texturePtr) {
+			useTexturePtr.reset(new Texture::Usage(*command.texturePtr));
+		}
+
+		if (command.translucent && !blendIsSet) {
+			gl.getIntegerv(Gl::BLEND_SRC, &prevBlendSrc);
+			gl.getIntegerv(Gl::BLEND_DST, &prevBlendDst);
+			gl.getBooleanv(Gl::DEPTH_WRITEMASK, &prevDepthMask);
+
+			gl.state.enable(Gl::BLEND);
+			gl.blendFunc(Gl::SRC_ALPHA, Gl::ONE_MINUS_SRC_ALPHA);
+			gl.depthMask(Gl::FALSE);
+			blendIsSet = true;
+		} else if (!command.translucent && blendIsSet) {
+			/* Opaque after translucent only happens on a new target. */
+			if (!prevBlend) { gl.state.disable(Gl::BLEND); }
+			gl.blendFunc(static_cast<Gl::Enum>(prevBlendSrc), 
+					static_cast<Gl::Enum>(prevBlendDst));
+			gl.depthMask(prevDepthMask);
+			blendIsSet = false;
+		}
+
+		execute(command);
+		prevCommand = &command;
+	}
+
+	useTexturePtr.reset();
+	useShaderPtr.reset();
+	useTargetPtr.reset();
+
+	if (prevCommand) {
+		prevCommand->target->setShader2D(prevShader2DPtr);
+		prevCommand->target->setShader3D(prevShader3DPtr);
+	}
+
+	if (blendIsSet) {
+		if (!prevBlend) { gl.state.disable(Gl::BLEND); }
+		gl.blendFunc(static_cast<Gl::Enum>(prevBlendSrc), 
+				static_cast<Gl::Enum>(prevBlendDst));
+		gl.depthMask(prevDepthMask);
+	}
+
+	clear();
+}
+
+void ATD::RenderQueue::clear()
+{
+	m_commands.clear();
+	m_targetIndices.clear();
+	m_shaderIndices.clear();
+	m_textureIndices.clear();
+}
+
+void ATD::RenderQueue::push(ATD::RenderQueue::Command &command, 
+		uint32_t order)
+{
+	uint64_t targetIndex = getIndex(m_targetIndices, 
+			command.target, _TARGETS_MAX_NUM);
+	uint64_t shaderIndex = getIndex(m_shaderIndices, 
+			command.shaderPtr.get(), _SHADERS_MAX_NUM);
+	/* No texture is index 0. */
+	uint64_t textureIndex = command.texturePtr ? getIndex(m_textureIndices, 
+			command.texturePtr.get(), _TEXTURES_MAX_NUM - 1) + 1 : 0;
+
+	if (command.translucent) {
+		command.key = (targetIndex << 56) | (1ull << 55) | 
+			(static_cast<uint64_t>(order) << 31) | 
+			(shaderIndex << 16) | 
+			textureIndex;
+	} else {
+		command.key = (targetIndex << 56) | 
+			(shaderIndex << 40) | 
+			(textureIndex << 24) | 
+			static_cast<uint64_t>(order);
+	}
+
+	m_commands.push_back(command);
+}
+
+uint64_t ATD::RenderQueue::getIndex(
+		std::map<const void *, uint64_t> &indices, 
+		const void *object, 
+		uint64_t maxNum)
+{
+	auto indexIt = indices.find(object);
+	if (indexIt != indices.end()) {
+		return indexIt->second;
+	}
+
+	if (indices.size() >= maxNum) {
+		throw std::runtime_error(Aux::printf(
+					"more than %lu distinct objects of a kind in render "
+					"queue", 
+					static_cast<size_t>(maxNum)));
+	}
+
+	uint64_t index = static_cast<uint64_t>(indices.size());
+	indices.insert(std::make_pair(object, index));
+	return index;
+}
+
+void ATD::RenderQueue::execute(const ATD::RenderQueue::Command &command)
+{
+	if (command.vertices2D) {
+		command.target->draw(*command.vertices2D, command.transform2D);
+	} else {
+		command.target->draw(*command.vertices3D, command.transform3D);
+	}
+}
+
+
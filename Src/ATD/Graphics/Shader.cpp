@@ -11,6 +11,13 @@
 #include <ATD/Graphics/GlCheck.hpp>
 #include <ATD/Graphics/Shader.hpp>
 
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <memory>
+#include <mutex>
 #include <set>
 #include <stdexcept>
 
@@ -66,6 +73,44 @@ static std::string _uniformToStr(const std::string &unfmName,
 }
 
 
+/* OpenGL uniform type for ATD::Shader::UniformHandle template argument. */
+template<typename T>
+struct _UniformType
+{};
+
+template<> struct _UniformType<float>
+{ static const ATD::Gl::Enum &TYPE; };
+template<> struct _UniformType<int>
+{ static const ATD::Gl::Enum &TYPE; };
+template<> struct _UniformType<ATD::Vector2F>
+{ static const ATD::Gl::Enum &TYPE; };
+template<> struct _UniformType<ATD::Vector2I>
+{ static const ATD::Gl::Enum &TYPE; };
+template<> struct _UniformType<ATD::Vector3F>
+{ static const ATD::Gl::Enum &TYPE; };
+template<> struct _UniformType<ATD::Vector3I>
+{ static const ATD::Gl::Enum &TYPE; };
+template<> struct _UniformType<ATD::Vector4F>
+{ static const ATD::Gl::Enum &TYPE; };
+template<> struct _UniformType<ATD::Vector4I>
+{ static const ATD::Gl::Enum &TYPE; };
+template<> struct _UniformType<ATD::Matrix3F>
+{ static const ATD::Gl::Enum &TYPE; };
+template<> struct _UniformType<ATD::Matrix4F>
+{ static const ATD::Gl::Enum &TYPE; };
+
+const ATD::Gl::Enum &_UniformType<float>::TYPE = ATD::Gl::FLOAT;
+const ATD::Gl::Enum &_UniformType<int>::TYPE = ATD::Gl::INT;
+const ATD::Gl::Enum &_UniformType<ATD::Vector2F>::TYPE = ATD::Gl::FLOAT_VEC2;
+const ATD::Gl::Enum &_UniformType<ATD::Vector2I>::TYPE = ATD::Gl::INT_VEC2;
+const ATD::Gl::Enum &_UniformType<ATD::Vector3F>::TYPE = ATD::Gl::FLOAT_VEC3;
+const ATD::Gl::Enum &_UniformType<ATD::Vector3I>::TYPE = ATD::Gl::INT_VEC3;
+const ATD::Gl::Enum &_UniformType<ATD::Vector4F>::TYPE = ATD::Gl::FLOAT_VEC4;
+const ATD::Gl::Enum &_UniformType<ATD::Vector4I>::TYPE = ATD::Gl::INT_VEC4;
+const ATD::Gl::Enum &_UniformType<ATD::Matrix3F>::TYPE = ATD::Gl::FLOAT_MAT3;
+const ATD::Gl::Enum &_UniformType<ATD::Matrix4F>::TYPE = ATD::Gl::FLOAT_MAT4;
+
+
 typedef std::pair<std::string, ATD::Gl::Enum> AttrDesc;
 typedef std::map<AttrDesc, ATD::Gl::Uint> AttrIndexMap;
 
@@ -96,7 +141,16 @@ static void _fillAttrIndexMap(const ATD::Shader &shader,
 		std::string attrName = attrNameBuffer.substr(0, attrNameLength);
 		AttrDesc attrDesc(attrName, attrType);
 
-		indexMap[attrDesc] = attrIndex;
+		/* Active attribute index is not its location: they differ as soon 
+		 * as some attribute (mat3, mat4) takes several locations. */
+		ATD::Gl::Int attrLocation = ATD::gl.getAttribLocation(shader.glId(), 
+				reinterpret_cast<const ATD::Gl::Char *>(attrName.c_str()));
+		if (attrLocation < 0) {
+			/* Built-in attribute (like gl_InstanceID). */
+			continue;
+		}
+
+		indexMap[attrDesc] = static_cast<ATD::Gl::Uint>(attrLocation);
 	}
 }
 
@@ -120,24 +174,195 @@ static std::string _attrDescToStr(const AttrDesc &attrDesc)
 }
 
 
+/* Program binary cache directory, nullptr if the cache is disabled. 
+ * Shaders may be created on the loader thread, hence the mutex. */
+static std::unique_ptr<ATD::Fs::Path> _binaryCacheDirPtr;
+static std::mutex _binaryCacheDirMtx;
+
+/* Tells cache files from anything else, bump on format change. */
+static const uint32_t _BINARY_MAGIC = 0x31425041; /* "APB1" */
+
+struct _BinaryHeader
+{
+	uint32_t magic;
+	uint32_t format;
+	uint64_t hash;
+};
+
+static void _fnv1a(uint64_t &hash, const void *r_data, size_t size)
+{
+	const unsigned char *data = 
+		reinterpret_cast<const unsigned char *>(r_data);
+	for (size_t bIndex = 0; bIndex < size; bIndex++) {
+		hash ^= static_cast<uint64_t>(data[bIndex]);
+		hash *= 0x100000001B3ull;
+	}
+}
+
+/* Binaries are only valid for the same driver, so it is hashed too. */
+static uint64_t _binaryHash(const std::vector<std::string> &vertexModules, 
+		const std::vector<std::string> &fragmentModules)
+{
+	uint64_t hash = 0xCBF29CE484222325ull;
+
+	const ATD::Gl::Enum driverStrings[] = {
+		ATD::Gl::VENDOR, ATD::Gl::RENDERER, ATD::Gl::VERSION
+	};
+	for (auto &name : driverStrings) {
+		const char *str = 
+			reinterpret_cast<const char *>(ATD::gl.getString(name));
+		if (str) {
+			_fnv1a(hash, str, ::strlen(str) + 1);
+		}
+	}
+
+	for (auto &module : vertexModules) {
+		_fnv1a(hash, module.data(), module.size() + 1);
+	}
+	/* Stage separator, so that modules cannot move between stages. */
+	_fnv1a(hash, "\n", 1);
+	for (auto &module : fragmentModules) {
+		_fnv1a(hash, module.data(), module.size() + 1);
+	}
+	return hash;
+}
+
+/* Copies the directory, so that the cache may be disabled meanwhile. */
+static bool _binaryCacheIsUsable(ATD::Fs::Path &dir)
+{
+	{
+		std::lock_guard<std::mutex> lock(_binaryCacheDirMtx);
+		if (!_binaryCacheDirPtr || !ATD::gl.programBinary) {
+			return false;
+		}
+		dir = *_binaryCacheDirPtr;
+	}
+
+	ATD::Gl::Int formatsNum = 0;
+	ATD::gl.getIntegerv(ATD::Gl::NUM_PROGRAM_BINARY_FORMATS, &formatsNum);
+	return formatsNum > 0;
+}
+
+
+/* Compiled objects, alive while any program uses them. Shared by the 
+ * window and the loader contexts, so guarded by the mutex. */
+typedef std::pair<ATD::Gl::Enum, uint64_t> ObjectKey;
+static std::map<ObjectKey, std::weak_ptr<ATD::Shader::Object>> _objectCache;
+static std::mutex _objectCacheMtx;
+
+
+/* ATD::Shader::Object */
+
+ATD::Shader::Object::Object(const std::string &source, ATD::Gl::Enum type)
+	: m_shaderId(0)
+	, m_type(type)
+	, m_source(source)
+{
+	m_shaderId = gl.createShader(m_type);
+	if (m_shaderId == 0) {
+		throw std::runtime_error(
+				Aux::printf(
+					"Cannot create new %s shader", 
+					m_type == Gl::VERTEX_SHADER ? "vertex" : 
+					m_type == Gl::FRAGMENT_SHADER ? "fragment" : 
+					"unknown type"
+					)
+				);
+	}
+
+	const Gl::Char *shaderSourceStr = 
+		reinterpret_cast<const Gl::Char *>(m_source.data());
+
+	Gl::Int shaderSourceLen = static_cast<Gl::Int>(m_source.size());
+	gl.shaderSource(m_shaderId, 1, &shaderSourceStr, &shaderSourceLen);
+
+	Gl::Int success = 0;
+	const size_t errorLogSize = 1024;
+	std::string errorLog(errorLogSize, '\0');
+
+	gl.compileShader(m_shaderId);
+	gl.getShaderiv(m_shaderId, Gl::COMPILE_STATUS, &success);
+	if (!success) {
+		gl.getShaderInfoLog(m_shaderId, errorLogSize, nullptr, 
+				reinterpret_cast<Gl::Char *>(&errorLog[0]));
+		gl.deleteShader(m_shaderId);
+
+		throw std::runtime_error(Aux::printf(
+					"Cannot compile shader %u\n%s\n", 
+					m_shaderId, errorLog.c_str()));
+	}
+}
+
+ATD::Shader::Object::~Object()
+{
+	/* Programs, it is attached to, keep it until they are deleted. */
+	gl.deleteShader(m_shaderId);
+}
+
+ATD::Shader::Object::Ptr ATD::Shader::Object::get(
+		const std::string &source, 
+		ATD::Gl::Enum type)
+{
+	uint64_t hash = 0xCBF29CE484222325ull;
+	_fnv1a(hash, source.data(), source.size());
+	ObjectKey key(type, hash);
+
+	bool isCollision = false;
+	{
+		std::lock_guard<std::mutex> lock(_objectCacheMtx);
+		auto objectIt = _objectCache.find(key);
+		if (objectIt != _objectCache.end()) {
+			Ptr objectPtr = objectIt->second.lock();
+			if (objectPtr && objectPtr->source() == source) {
+				return objectPtr;
+			}
+			isCollision = static_cast<bool>(objectPtr);
+		}
+	}
+
+	/* Compiled unlocked: the same source, compiled concurrently, is just 
+	 * compiled twice. */
+	Ptr objectPtr(new Object(source, type));
+
+	/* On hash collision the cached one is kept. */
+	if (!isCollision) {
+		std::lock_guard<std::mutex> lock(_objectCacheMtx);
+
+		/* Drop the entries of the objects, deleted meanwhile, so that 
+		 * transient shaders do not grow the cache. */
+		for (auto objectIt = _objectCache.begin(); 
+				objectIt != _objectCache.end(); ) {
+			if (objectIt->second.expired()) {
+				objectIt = _objectCache.erase(objectIt);
+			} else {
+				objectIt++;
+			}
+		}
+		_objectCache[key] = objectPtr;
+	}
+	return objectPtr;
+}
+
+
 /* ATD::Shader::Usage */
 
 ATD::Shader::Usage::Usage(const ATD::Shader &shader)
 	: m_prevProgram(0)
 	, m_activated(false)
 {
-	gl.getIntegerv(Gl::CURRENT_PROGRAM, 
-			reinterpret_cast<Gl::Int *>(&m_prevProgram));
+	m_prevProgram = gl.state.program();
 
 	if (m_prevProgram != shader.glId()) {
-		gl.useProgram(shader.glId());
+		gl.state.useProgram(shader.glId());
 		m_activated = true;
 	}
+
+	shader.uploadPendingUniforms();
 }
 
 ATD::Shader::Usage::~Usage()
 {
-	if (m_activated) { gl.useProgram(m_prevProgram); }
+	if (m_activated) { gl.state.useProgram(m_prevProgram); }
 }
 
 
@@ -145,10 +370,17 @@ ATD::Shader::Usage::~Usage()
 
 ATD::Shader::Shader(const std::string &vertexSource, 
 		const std::string &fragmentSource)
+	: Shader(std::vector<std::string>(1, vertexSource), 
+			std::vector<std::string>(1, fragmentSource))
+{}
+
+ATD::Shader::Shader(const std::vector<std::string> &vertexModules, 
+		const std::vector<std::string> &fragmentModules)
 	: m_program(0)
-	, m_vertexShaderId(0)
-	, m_fragmentShaderId(0)
+	, m_objects()
 	, m_uniformLocationMap()
+	, m_uniforms()
+	, m_pendingUniforms()
 	, m_isCanvasRequired(false)
 {
 	m_program = gl.createProgram();
@@ -158,9 +390,28 @@ ATD::Shader::Shader(const std::string &vertexSource,
 	}
 	/* IPRINTF("", "created new shader program %u", m_program); // DEBUG */
 
+	Fs::Path binaryDir;
+	bool useBinaryCache = _binaryCacheIsUsable(binaryDir);
+	uint64_t binaryHash = 0;
+	Fs::Path binaryPath;
+	if (useBinaryCache) {
+		binaryHash = _binaryHash(vertexModules, fragmentModules);
+		binaryPath = binaryDir.joined(Fs::Path(Aux::printf(
+						"%016llx.bin", 
+						static_cast<unsigned long long>(binaryHash))));
+
+		if (loadBinary(binaryPath, binaryHash)) {
+			/* It was validated, before it was stored. */
+			initUniforms();
+			return;
+		}
+
+		gl.programParameteri(m_program, 
+				Gl::PROGRAM_BINARY_RETRIEVABLE_HINT, Gl::TRUE);
+	}
 
-	compileShader(vertexSource, Gl::VERTEX_SHADER, m_vertexShaderId);
-	compileShader(fragmentSource, Gl::FRAGMENT_SHADER, m_fragmentShaderId);
+	attachModules(vertexModules, Gl::VERTEX_SHADER);
+	attachModules(fragmentModules, Gl::FRAGMENT_SHADER);
 
 	Gl::Int success = 0;
 	const size_t errorLogSize = 1024;
@@ -188,294 +439,282 @@ ATD::Shader::Shader(const std::string &vertexSource,
 					m_program, errorLog.c_str()));
 	}
 
+	if (useBinaryCache) {
+		saveBinary(binaryPath, binaryHash);
+	}
+
 	initUniforms();
 }
 
 ATD::Shader::~Shader()
 {
-	if (m_program) { gl.deleteProgram(m_program); }
-	if (m_vertexShaderId) { gl.deleteShader(m_vertexShaderId); }
-	if (m_fragmentShaderId) { gl.deleteShader(m_fragmentShaderId); }
+	if (m_program) { gl.state.deleteProgram(m_program); }
 }
 
-void ATD::Shader::setUniform(const std::string &name, float value)
+void ATD::Shader::enableBinaryCache(const ATD::Fs::Path &dir)
 {
-	const Gl::Enum type = Gl::FLOAT;
-	auto unfmLDIter = m_uniformLocationMap.find(name);
-	if (unfmLDIter != m_uniformLocationMap.end()) {
-		if (unfmLDIter->second.type == type) {
-			Usage use(*this);
-			gl.uniform1f(unfmLDIter->second.location, 
-					static_cast<Gl::Float>(value));
-
-			unfmLDIter->second.isSet = true;
-		} else {
-			throw std::runtime_error(Aux::printf("no '%s' in shader %u", 
-						_uniformToStr(name, type).c_str(), m_program));
-		}
-	} else {
-		throw std::runtime_error(Aux::printf("no '%s' in shader %u", 
-					_uniformToStr(name, type).c_str(), m_program));
+	if (!dir.exists()) {
+		dir.mkDir();
 	}
+
+	std::lock_guard<std::mutex> lock(_binaryCacheDirMtx);
+	_binaryCacheDirPtr.reset(new Fs::Path(dir));
 }
 
-void ATD::Shader::setUniform(const std::string &name, int value)
+void ATD::Shader::disableBinaryCache()
 {
-	const Gl::Enum type = Gl::INT;
-	auto unfmLDIter = m_uniformLocationMap.find(name);
-	if (unfmLDIter != m_uniformLocationMap.end()) {
-		if (unfmLDIter->second.type == type) {
-			Usage use(*this);
-			gl.uniform1i(unfmLDIter->second.location, 
-					static_cast<Gl::Int>(value));
+	std::lock_guard<std::mutex> lock(_binaryCacheDirMtx);
+	_binaryCacheDirPtr.reset();
+}
 
-			unfmLDIter->second.isSet = true;
-		} else {
-			throw std::runtime_error(Aux::printf("no '%s' in shader %u", 
-						_uniformToStr(name, type).c_str(), m_program));
-		}
-	} else {
-		throw std::runtime_error(Aux::printf("no '%s' in shader %u", 
-					_uniformToStr(name, type).c_str(), m_program));
-	}
+void ATD::Shader::setUniform(const std::string &name, float value)
+{
+	setUniform(UniformHandle<float>(m_program, 
+				getUniformIndex(name, Gl::FLOAT)), value);
+}
+
+void ATD::Shader::setUniform(const std::string &name, int value)
+{
+	setUniform(UniformHandle<int>(m_program, 
+				getUniformIndex(name, Gl::INT)), value);
 }
 
 void ATD::Shader::setUniform(const std::string &name, 
 		const ATD::Vector2F &value)
 {
-	const Gl::Enum type = Gl::FLOAT_VEC2;
-	auto unfmLDIter = m_uniformLocationMap.find(name);
-	if (unfmLDIter != m_uniformLocationMap.end()) {
-		if (unfmLDIter->second.type == type) {
-			Usage use(*this);
-			gl.uniform2f(unfmLDIter->second.location, 
-					static_cast<Gl::Float>(value.x), 
-					static_cast<Gl::Float>(value.y));
-
-			unfmLDIter->second.isSet = true;
-		} else {
-			throw std::runtime_error(Aux::printf("no '%s' in shader %u", 
-						_uniformToStr(name, type).c_str(), m_program));
-		}
-	} else {
-		throw std::runtime_error(Aux::printf("no '%s' in shader %u", 
-					_uniformToStr(name, type).c_str(), m_program));
-	}
+	setUniform(UniformHandle<Vector2F>(m_program, 
+				getUniformIndex(name, Gl::FLOAT_VEC2)), value);
 }
 
 void ATD::Shader::setUniform(const std::string &name, 
 		const ATD::Vector2I &value)
 {
-	const Gl::Enum type = Gl::INT_VEC2;
-	auto unfmLDIter = m_uniformLocationMap.find(name);
-	if (unfmLDIter != m_uniformLocationMap.end()) {
-		if (unfmLDIter->second.type == type) {
-			Usage use(*this);
-			gl.uniform2i(unfmLDIter->second.location, 
-					static_cast<Gl::Int>(value.x), 
-					static_cast<Gl::Int>(value.y));
-
-			unfmLDIter->second.isSet = true;
-		} else {
-			throw std::runtime_error(Aux::printf("no '%s' in shader %u", 
-						_uniformToStr(name, type).c_str(), m_program));
-		}
-	} else {
-		throw std::runtime_error(Aux::printf("no '%s' in shader %u", 
-					_uniformToStr(name, type).c_str(), m_program));
-	}
+	setUniform(UniformHandle<Vector2I>(m_program, 
+				getUniformIndex(name, Gl::INT_VEC2)), value);
 }
 
 void ATD::Shader::setUniform(const std::string &name, 
 		const ATD::Vector3F &value)
 {
-	const Gl::Enum type = Gl::FLOAT_VEC3;
-	auto unfmLDIter = m_uniformLocationMap.find(name);
-	if (unfmLDIter != m_uniformLocationMap.end()) {
-		if (unfmLDIter->second.type == type) {
-			Usage use(*this);
-			gl.uniform3f(unfmLDIter->second.location, 
-					static_cast<Gl::Float>(value.x), 
-					static_cast<Gl::Float>(value.y), 
-					static_cast<Gl::Float>(value.z));
-
-			unfmLDIter->second.isSet = true;
-		} else {
-			throw std::runtime_error(Aux::printf("no '%s' in shader %u", 
-						_uniformToStr(name, type).c_str(), m_program));
-		}
-	} else {
-		throw std::runtime_error(Aux::printf("no '%s' in shader %u", 
-					_uniformToStr(name, type).c_str(), m_program));
-	}
+	setUniform(UniformHandle<Vector3F>(m_program, 
+				getUniformIndex(name, Gl::FLOAT_VEC3)), value);
 }
 
 void ATD::Shader::setUniform(const std::string &name, 
 		const ATD::Vector3I &value)
 {
-	const Gl::Enum type = Gl::INT_VEC3;
-	auto unfmLDIter = m_uniformLocationMap.find(name);
-	if (unfmLDIter != m_uniformLocationMap.end()) {
-		if (unfmLDIter->second.type == type) {
-			Usage use(*this);
-			gl.uniform3i(unfmLDIter->second.location, 
-					static_cast<Gl::Int>(value.x), 
-					static_cast<Gl::Int>(value.y), 
-					static_cast<Gl::Int>(value.z));
-
-			unfmLDIter->second.isSet = true;
-		} else {
-			throw std::runtime_error(Aux::printf("no '%s' in shader %u", 
-						_uniformToStr(name, type).c_str(), m_program));
-		}
-	} else {
-		throw std::runtime_error(Aux::printf("no '%s' in shader %u", 
-					_uniformToStr(name, type).c_str(), m_program));
-	}
+	setUniform(UniformHandle<Vector3I>(m_program, 
+				getUniformIndex(name, Gl::INT_VEC3)), value);
 }
 
 void ATD::Shader::setUniform(const std::string &name, 
 		const ATD::Vector4F &value)
 {
-	const Gl::Enum type = Gl::FLOAT_VEC4;
-	auto unfmLDIter = m_uniformLocationMap.find(name);
-	if (unfmLDIter != m_uniformLocationMap.end()) {
-		if (unfmLDIter->second.type == type) {
-			Usage use(*this);
-			gl.uniform4f(unfmLDIter->second.location, 
-					static_cast<Gl::Float>(value.x), 
-					static_cast<Gl::Float>(value.y), 
-					static_cast<Gl::Float>(value.z), 
-					static_cast<Gl::Float>(value.w));
-
-			unfmLDIter->second.isSet = true;
-		} else {
-			throw std::runtime_error(Aux::printf("no '%s' in shader %u", 
-						_uniformToStr(name, type).c_str(), m_program));
-		}
-	} else {
-		throw std::runtime_error(Aux::printf("no '%s' in shader %u", 
-					_uniformToStr(name, type).c_str(), m_program));
-	}
+	setUniform(UniformHandle<Vector4F>(m_program, 
+				getUniformIndex(name, Gl::FLOAT_VEC4)), value);
 }
 
 void ATD::Shader::setUniform(const std::string &name, 
 		const ATD::Vector4I &value)
 {
-	const Gl::Enum type = Gl::INT_VEC4;
-	auto unfmLDIter = m_uniformLocationMap.find(name);
-	if (unfmLDIter != m_uniformLocationMap.end()) {
-		if (unfmLDIter->second.type == type) {
-			Usage use(*this);
-			gl.uniform4i(unfmLDIter->second.location, 
-					static_cast<Gl::Int>(value.x), 
-					static_cast<Gl::Int>(value.y), 
-					static_cast<Gl::Int>(value.z), 
-					static_cast<Gl::Int>(value.w));
-
-			unfmLDIter->second.isSet = true;
-		} else {
-			throw std::runtime_error(Aux::printf("no '%s' in shader %u", 
-						_uniformToStr(name, type).c_str(), m_program));
-		}
-	} else {
-		throw std::runtime_error(Aux::printf("no '%s' in shader %u", 
-					_uniformToStr(name, type).c_str(), m_program));
-	}
+	setUniform(UniformHandle<Vector4I>(m_program, 
+				getUniformIndex(name, Gl::INT_VEC4)), value);
 }
 
 void ATD::Shader::setUniform(const std::string &name, 
 		const ATD::Matrix3F &value)
 {
-	const Gl::Enum type = Gl::FLOAT_MAT3;
-	auto unfmLDIter = m_uniformLocationMap.find(name);
-	if (unfmLDIter != m_uniformLocationMap.end()) {
-		if (unfmLDIter->second.type == type) {
-			Usage use(*this);
-			gl.uniformMatrix3fv(unfmLDIter->second.location, 1, Gl::TRUE, 
-					reinterpret_cast<const Gl::Float *>(&value));
-
-			unfmLDIter->second.isSet = true;
-		} else {
-			throw std::runtime_error(Aux::printf("no '%s' in shader %u", 
-						_uniformToStr(name, type).c_str(), m_program));
-		}
-	} else {
-		throw std::runtime_error(Aux::printf("no '%s' in shader %u", 
-					_uniformToStr(name, type).c_str(), m_program));
-	}
+	setUniform(UniformHandle<Matrix3F>(m_program, 
+				getUniformIndex(name, Gl::FLOAT_MAT3)), value);
 }
 
 void ATD::Shader::setUniform(const std::string &name, 
 		const ATD::Matrix4F &value)
 {
-	const Gl::Enum type = Gl::FLOAT_MAT4;
-	auto unfmLDIter = m_uniformLocationMap.find(name);
-	if (unfmLDIter != m_uniformLocationMap.end()) {
-		if (unfmLDIter->second.type == type) {
-			Usage use(*this);
-			gl.uniformMatrix4fv(unfmLDIter->second.location, 1, Gl::TRUE, 
-					reinterpret_cast<const Gl::Float *>(&value));
-
-			unfmLDIter->second.isSet = true;
-		} else {
-			throw std::runtime_error(Aux::printf("no '%s' in shader %u", 
-						_uniformToStr(name, type).c_str(), m_program));
-		}
-	} else {
-		throw std::runtime_error(Aux::printf("no '%s' in shader %u", 
-					_uniformToStr(name, type).c_str(), m_program));
-	}
+	setUniform(UniformHandle<Matrix4F>(m_program, 
+				getUniformIndex(name, Gl::FLOAT_MAT4)), value);
 }
 
 void ATD::Shader::setUniformSampler2DUnit(const std::string &name, 
 		const ATD::Texture::Unit &unit)
 {
-	const Gl::Enum type = Gl::SAMPLER_2D;
-	auto unfmLDIter = m_uniformLocationMap.find(name);
-	if (unfmLDIter != m_uniformLocationMap.end()) {
-		if (unfmLDIter->second.type == type) {
-			Usage use(*this);
-			/* Yes, that's right. Int. */
-			gl.uniform1i(
-					unfmLDIter->second.location, 
-					static_cast<Gl::Int>(
-						static_cast<unsigned>(unit)));
-
-			unfmLDIter->second.isSet = true;
-		} else {
-			throw std::runtime_error(Aux::printf("no '%s' in shader %u", 
-						_uniformToStr(name, type).c_str(), m_program));
-		}
-	} else {
-		throw std::runtime_error(Aux::printf("no '%s' in shader %u", 
-					_uniformToStr(name, type).c_str(), m_program));
-	}
+	setUniform(UniformHandle<Texture::Unit>(m_program, 
+				getUniformIndex(name, Gl::SAMPLER_2D)), unit);
 }
 
 void ATD::Shader::setUniformSamplerCubeUnit(const std::string &name, 
 		const ATD::Texture::Unit &unit)
 {
-	const Gl::Enum type = Gl::SAMPLER_CUBE;
+	setUniform(UniformHandle<Texture::Unit>(m_program, 
+				getUniformIndex(name, Gl::SAMPLER_CUBE)), unit);
+}
+
+template<typename T>
+ATD::Shader::UniformHandle<T> ATD::Shader::getUniformHandle(
+		const std::string &name) const
+{
+	return UniformHandle<T>(m_program, 
+			getUniformIndex(name, _UniformType<T>::TYPE));
+}
+
+template<>
+ATD::Shader::UniformHandle<ATD::Texture::Unit> 
+ATD::Shader::getUniformHandle<ATD::Texture::Unit>(
+		const std::string &name) const
+{
+	/* Both sampler types are set the same way. */
 	auto unfmLDIter = m_uniformLocationMap.find(name);
-	if (unfmLDIter != m_uniformLocationMap.end()) {
-		if (unfmLDIter->second.type == type) {
-			Usage use(*this);
-			/* Yes, that's right. Int. */
-			gl.uniform1i(
-					unfmLDIter->second.location, 
-					static_cast<Gl::Int>(
-						static_cast<unsigned>(unit)));
-
-			unfmLDIter->second.isSet = true;
-		} else {
-			throw std::runtime_error(Aux::printf("no '%s' in shader %u", 
-						_uniformToStr(name, type).c_str(), m_program));
-		}
-	} else {
-		throw std::runtime_error(Aux::printf("no '%s' in shader %u", 
-					_uniformToStr(name, type).c_str(), m_program));
+	if (unfmLDIter != m_uniformLocationMap.end() && 
+			m_uniforms[unfmLDIter->second].type == Gl::SAMPLER_CUBE) {
+		return UniformHandle<Texture::Unit>(m_program, 
+				getUniformIndex(name, Gl::SAMPLER_CUBE));
 	}
+	return UniformHandle<Texture::Unit>(m_program, 
+			getUniformIndex(name, Gl::SAMPLER_2D));
+}
+
+template ATD::Shader::UniformHandle<float> 
+ATD::Shader::getUniformHandle<float>(const std::string &name) const;
+template ATD::Shader::UniformHandle<int> 
+ATD::Shader::getUniformHandle<int>(const std::string &name) const;
+template ATD::Shader::UniformHandle<ATD::Vector2F> 
+ATD::Shader::getUniformHandle<ATD::Vector2F>(const std::string &name) const;
+template ATD::Shader::UniformHandle<ATD::Vector2I> 
+ATD::Shader::getUniformHandle<ATD::Vector2I>(const std::string &name) const;
+template ATD::Shader::UniformHandle<ATD::Vector3F> 
+ATD::Shader::getUniformHandle<ATD::Vector3F>(const std::string &name) const;
+template ATD::Shader::UniformHandle<ATD::Vector3I> 
+ATD::Shader::getUniformHandle<ATD::Vector3I>(const std::string &name) const;
+template ATD::Shader::UniformHandle<ATD::Vector4F> 
+ATD::Shader::getUniformHandle<ATD::Vector4F>(const std::string &name) const;
+template ATD::Shader::UniformHandle<ATD::Vector4I> 
+ATD::Shader::getUniformHandle<ATD::Vector4I>(const std::string &name) const;
+template ATD::Shader::UniformHandle<ATD::Matrix3F> 
+ATD::Shader::getUniformHandle<ATD::Matrix3F>(const std::string &name) const;
+template ATD::Shader::UniformHandle<ATD::Matrix4F> 
+ATD::Shader::getUniformHandle<ATD::Matrix4F>(const std::string &name) const;
+
+void ATD::Shader::setUniform(
+		const ATD::Shader::UniformHandle<float> &handle, 
+		float value)
+{
+	const Gl::Float glValue = static_cast<Gl::Float>(value);
+	setUniformValue(handle.m_program, handle.m_index, 
+			&glValue, sizeof(glValue));
+}
+
+void ATD::Shader::setUniform(
+		const ATD::Shader::UniformHandle<int> &handle, 
+		int value)
+{
+	const Gl::Int glValue = static_cast<Gl::Int>(value);
+	setUniformValue(handle.m_program, handle.m_index, 
+			&glValue, sizeof(glValue));
+}
+
+void ATD::Shader::setUniform(
+		const ATD::Shader::UniformHandle<ATD::Vector2F> &handle, 
+		const ATD::Vector2F &value)
+{
+	const Gl::Float glValue[2] = {
+		static_cast<Gl::Float>(value.x), 
+		static_cast<Gl::Float>(value.y)
+	};
+	setUniformValue(handle.m_program, handle.m_index, 
+			glValue, sizeof(glValue));
+}
+
+void ATD::Shader::setUniform(
+		const ATD::Shader::UniformHandle<ATD::Vector2I> &handle, 
+		const ATD::Vector2I &value)
+{
+	const Gl::Int glValue[2] = {
+		static_cast<Gl::Int>(value.x), 
+		static_cast<Gl::Int>(value.y)
+	};
+	setUniformValue(handle.m_program, handle.m_index, 
+			glValue, sizeof(glValue));
+}
+
+void ATD::Shader::setUniform(
+		const ATD::Shader::UniformHandle<ATD::Vector3F> &handle, 
+		const ATD::Vector3F &value)
+{
+	const Gl::Float glValue[3] = {
+		static_cast<Gl::Float>(value.x), 
+		static_cast<Gl::Float>(value.y), 
+		static_cast<Gl::Float>(value.z)
+	};
+	setUniformValue(handle.m_program, handle.m_index, 
+			glValue, sizeof(glValue));
+}
+
+void ATD::Shader::setUniform(
+		const ATD::Shader::UniformHandle<ATD::Vector3I> &handle, 
+		const ATD::Vector3I &value)
+{
+	const Gl::Int glValue[3] = {
+		static_cast<Gl::Int>(value.x), 
+		static_cast<Gl::Int>(value.y), 
+		static_cast<Gl::Int>(value.z)
+	};
+	setUniformValue(handle.m_program, handle.m_index, 
+			glValue, sizeof(glValue));
+}
+
+void ATD::Shader::setUniform(
+		const ATD::Shader::UniformHandle<ATD::Vector4F> &handle, 
+		const ATD::Vector4F &value)
+{
+	const Gl::Float glValue[4] = {
+		static_cast<Gl::Float>(value.x), 
+		static_cast<Gl::Float>(value.y), 
+		static_cast<Gl::Float>(value.z), 
+		static_cast<Gl::Float>(value.w)
+	};
+	setUniformValue(handle.m_program, handle.m_index, 
+			glValue, sizeof(glValue));
+}
+
+void ATD::Shader::setUniform(
+		const ATD::Shader::UniformHandle<ATD::Vector4I> &handle, 
+		const ATD::Vector4I &value)
+{
+	const Gl::Int glValue[4] = {
+		static_cast<Gl::Int>(value.x), 
+		static_cast<Gl::Int>(value.y), 
+		static_cast<Gl::Int>(value.z), 
+		static_cast<Gl::Int>(value.w)
+	};
+	setUniformValue(handle.m_program, handle.m_index, 
+			glValue, sizeof(glValue));
+}
+
+void ATD::Shader::setUniform(
+		const ATD::Shader::UniformHandle<ATD::Matrix3F> &handle, 
+		const ATD::Matrix3F &value)
+{
+	setUniformValue(handle.m_program, handle.m_index, 
+			&value, sizeof(value));
+}
+
+void ATD::Shader::setUniform(
+		const ATD::Shader::UniformHandle<ATD::Matrix4F> &handle, 
+		const ATD::Matrix4F &value)
+{
+	setUniformValue(handle.m_program, handle.m_index, 
+			&value, sizeof(value));
+}
+
+void ATD::Shader::setUniform(
+		const ATD::Shader::UniformHandle<ATD::Texture::Unit> &handle, 
+		const ATD::Texture::Unit &unit)
+{
+	/* Yes, that's right. Int. */
+	const Gl::Int glValue = static_cast<Gl::Int>(
+			static_cast<unsigned>(unit));
+	setUniformValue(handle.m_program, handle.m_index, 
+			&glValue, sizeof(glValue));
 }
 
 void ATD::Shader::checkIfUniformsSet() const
@@ -484,9 +723,10 @@ void ATD::Shader::checkIfUniformsSet() const
 	for (auto unfmLDIter = m_uniformLocationMap.begin(); 
 			unfmLDIter != m_uniformLocationMap.end(); 
 			unfmLDIter++) {
-		if (!unfmLDIter->second.isSet) {
+		const UniformLocationDesc &desc = m_uniforms[unfmLDIter->second];
+		if (!desc.isSet) {
 			unfmNamesUnset.push_back(_uniformToStr(unfmLDIter->first, 
-						unfmLDIter->second.type));
+						desc.type));
 		}
 	}
 	if (unfmNamesUnset.size()) {
@@ -500,44 +740,93 @@ void ATD::Shader::checkIfUniformsSet() const
 	}
 }
 
-void ATD::Shader::compileShader(const std::string &shaderSource, 
-		ATD::Gl::Enum shaderType, 
-		ATD::Gl::Uint &shaderId)
+void ATD::Shader::attachModules(const std::vector<std::string> &modules, 
+		ATD::Gl::Enum type)
 {
-	shaderId = gl.createShader(shaderType);
-	if (shaderId == 0) {
-		throw std::runtime_error(
-				Aux::printf(
-					"Cannot create new %s shader", 
-					shaderType == Gl::VERTEX_SHADER ? "vertex" : 
-					shaderType == Gl::FRAGMENT_SHADER ? "fragment" : 
-					"unknown type"
-					)
-				);
+	for (auto &module : modules) {
+		Object::Ptr objectPtr = Object::get(module, type);
+		gl.attachShader(m_program, objectPtr->glId());
+		m_objects.push_back(objectPtr);
 	}
+}
 
-	const Gl::Char *shaderSourceStr = 
-		reinterpret_cast<const Gl::Char *>(shaderSource.data());
+bool ATD::Shader::loadBinary(const ATD::Fs::Path &path, uint64_t hash)
+{
+	FILE *file = ::fopen(path.native().c_str(), "rb");
+	if (!file) {
+		/* Not cached yet. */
+		return false;
+	}
+
+	_BinaryHeader header;
+	std::vector<unsigned char> binary;
+	bool isRead = false;
+	if (::fread(&header, sizeof(header), 1, file) == 1 && 
+			header.magic == _BINARY_MAGIC && 
+			header.hash == hash) {
+		::fseek(file, 0, SEEK_END);
+		long fileSize = ::ftell(file);
+		if (fileSize > static_cast<long>(sizeof(header))) {
+			binary.resize(static_cast<size_t>(fileSize) - sizeof(header));
+			::fseek(file, sizeof(header), SEEK_SET);
+			isRead = ::fread(binary.data(), 1, binary.size(), file) == 
+				binary.size();
+		}
+	}
+	::fclose(file);
+
+	if (!isRead) {
+		EPRINTF("", "broken program binary '%s'", path.native().c_str());
+		return false;
+	}
 
-	Gl::Int shaderSourceLen = static_cast<Gl::Int>(shaderSource.size());
-	gl.shaderSource(shaderId, 1, &shaderSourceStr, &shaderSourceLen);
+	gl.programBinary(m_program, header.format, binary.data(), 
+			static_cast<Gl::Sizei>(binary.size()));
 
+	/* Driver may reject the binary (e.g. after an update). */
 	Gl::Int success = 0;
-	const size_t errorLogSize = 1024;
-	std::string errorLog(errorLogSize, '\0');
+	gl.getProgramiv(m_program, Gl::LINK_STATUS, &success);
+	return success != 0;
+}
 
-	gl.compileShader(shaderId);
-	gl.getShaderiv(shaderId, Gl::COMPILE_STATUS, &success);
-	if (!success) {
-		gl.getShaderInfoLog(shaderId, errorLogSize, nullptr, 
-				reinterpret_cast<Gl::Char *>(&errorLog[0]));
+void ATD::Shader::saveBinary(const ATD::Fs::Path &path, 
+		uint64_t hash) const
+{
+	Gl::Int binarySize = 0;
+	gl.getProgramiv(m_program, Gl::PROGRAM_BINARY_LENGTH, &binarySize);
+	if (binarySize <= 0) {
+		return;
+	}
 
-		throw std::runtime_error(Aux::printf(
-					"Cannot compile shader %u\n%s\n", 
-					shaderId, errorLog.c_str()));
+	_BinaryHeader header;
+	header.magic = _BINARY_MAGIC;
+	header.format = 0;
+	header.hash = hash;
+
+	std::vector<unsigned char> binary(static_cast<size_t>(binarySize));
+	Gl::Sizei binaryLength = 0;
+	gl.getProgramBinary(m_program, binarySize, &binaryLength, 
+			&header.format, binary.data());
+
+	FILE *file = ::fopen(path.native().c_str(), "wb");
+	if (!file) {
+		EPRINTF("", "'fopen(%s, \"wb\")' failure: %d %s", 
+				path.native().c_str(), errno, ::strerror(errno));
+		return;
 	}
 
-	gl.attachShader(m_program, shaderId);
+	bool isWritten = 
+		::fwrite(&header, sizeof(header), 1, file) == 1 && 
+		::fwrite(binary.data(), 1, binaryLength, file) == 
+			static_cast<size_t>(binaryLength);
+	::fclose(file);
+
+	if (!isWritten) {
+		/* Half-written binary would be rejected anyway, but takes time. */
+		EPRINTF("", "failed to write program binary '%s'", 
+				path.native().c_str());
+		::remove(path.native().c_str());
+	}
 }
 
 void ATD::Shader::initUniforms()
@@ -571,9 +860,11 @@ void ATD::Shader::initUniforms()
 
 		if (unfmLocation != static_cast<Gl::Int>(-1)) {
 			m_uniformLocationMap.insert(
-					std::pair<std::string, UniformLocationDesc>(
+					std::pair<std::string, size_t>(
 						unfmName, 
-						UniformLocationDesc(unfmLocation, unfmType)));
+						m_uniforms.size()));
+			m_uniforms.push_back(
+					UniformLocationDesc(unfmLocation, unfmType));
 		}
 	}
 
@@ -584,8 +875,9 @@ void ATD::Shader::initUniforms()
 	if (cvSizeLdIter != m_uniformLocationMap.end() && 
 			cvTextureLdIter != m_uniformLocationMap.end()) {
 
-		if (cvSizeLdIter->second.type == Gl::FLOAT_VEC2 && 
-				cvTextureLdIter->second.type == Gl::SAMPLER_2D) {
+		if (m_uniforms[cvSizeLdIter->second].type == Gl::FLOAT_VEC2 && 
+				m_uniforms[cvTextureLdIter->second].type == 
+				Gl::SAMPLER_2D) {
 
 			m_isCanvasRequired = true;
 		}
@@ -594,13 +886,14 @@ void ATD::Shader::initUniforms()
 	/* DEBUG */
 	std::string uniformsStr;
 	for (auto &udPair : m_uniformLocationMap) {
+		const Gl::Enum unfmType = m_uniforms[udPair.second].type;
 		if (uniformsStr.size()) {
 			uniformsStr += 
 				std::string(", ") + 
-				_uniformToStr(udPair.first, udPair.second.type);
+				_uniformToStr(udPair.first, unfmType);
 		} else {
 			uniformsStr = 
-				_uniformToStr(udPair.first, udPair.second.type);
+				_uniformToStr(udPair.first, unfmType);
 		}
 	}
 	IPRINTF("", "%lu uniforms initialized in shader %u: [%s]", 
@@ -610,10 +903,96 @@ void ATD::Shader::initUniforms()
 }
 
 
+size_t ATD::Shader::getUniformIndex(const std::string &name, 
+		ATD::Gl::Enum type) const
+{
+	auto unfmLDIter = m_uniformLocationMap.find(name);
+	if (unfmLDIter == m_uniformLocationMap.end() || 
+			m_uniforms[unfmLDIter->second].type != type) {
+		throw std::runtime_error(Aux::printf("no '%s' in shader %u", 
+					_uniformToStr(name, type).c_str(), m_program));
+	}
+	return unfmLDIter->second;
+}
+
+void ATD::Shader::setUniformValue(ATD::Gl::Uint handleProgram, 
+		size_t index, 
+		const void *r_value, 
+		size_t valueSize)
+{
+	if (handleProgram != m_program || index >= m_uniforms.size()) {
+		throw std::runtime_error(Aux::printf(
+					"invalid uniform handle for shader %u", m_program));
+	}
+
+	UniformLocationDesc &desc = m_uniforms[index];
+	if (desc.isSet && !::memcmp(desc.value.data(), r_value, valueSize)) {
+		/* Same value is already there (or about to be uploaded). */
+		return;
+	}
+
+	::memcpy(desc.value.data(), r_value, valueSize);
+	desc.isSet = true;
+
+	if (gl.state.program() == m_program) {
+		uploadUniform(desc);
+	} else if (!desc.isPending) {
+		/* Batched until the program is bound by Shader::Usage. */
+		desc.isPending = true;
+		m_pendingUniforms.push_back(index);
+	}
+}
+
+void ATD::Shader::uploadPendingUniforms() const
+{
+	for (auto &index : m_pendingUniforms) {
+		UniformLocationDesc &desc = m_uniforms[index];
+		if (desc.isPending) {
+			uploadUniform(desc);
+			desc.isPending = false;
+		}
+	}
+	m_pendingUniforms.clear();
+}
+
+void ATD::Shader::uploadUniform(
+		const ATD::Shader::UniformLocationDesc &desc) const
+{
+	const Gl::Float *floats = 
+		reinterpret_cast<const Gl::Float *>(desc.value.data());
+	const Gl::Int *ints = 
+		reinterpret_cast<const Gl::Int *>(desc.value.data());
+
+	if (desc.type == Gl::FLOAT) {
+		gl.uniform1fv(desc.location, 1, floats);
+	} else if (desc.type == Gl::FLOAT_VEC2) {
+		gl.uniform2fv(desc.location, 1, floats);
+	} else if (desc.type == Gl::FLOAT_VEC3) {
+		gl.uniform3fv(desc.location, 1, floats);
+	} else if (desc.type == Gl::FLOAT_VEC4) {
+		gl.uniform4fv(desc.location, 1, floats);
+	} else if (desc.type == Gl::INT_VEC2) {
+		gl.uniform2iv(desc.location, 1, ints);
+	} else if (desc.type == Gl::INT_VEC3) {
+		gl.uniform3iv(desc.location, 1, ints);
+	} else if (desc.type == Gl::INT_VEC4) {
+		gl.uniform4iv(desc.location, 1, ints);
+	} else if (desc.type == Gl::FLOAT_MAT3) {
+		gl.uniformMatrix3fv(desc.location, 1, Gl::TRUE, floats);
+	} else if (desc.type == Gl::FLOAT_MAT4) {
+		gl.uniformMatrix4fv(desc.location, 1, Gl::TRUE, floats);
+	} else {
+		/* INT and samplers. */
+		gl.uniform1iv(desc.location, 1, ints);
+	}
+}
+
+
 /* ATD::Shader2D constants: */
 
 /* ATD::Shader2d::PLAIN_VERTEX_SOURCE is set in Shader2DSources.cpp. */
 /* ATD::Shader2d::PLAIN_FRAGMENT_SOURCE is set in Shader2DSources.cpp. */
+/* ATD::Shader2d::INSTANCED_VERTEX_SOURCE is set in Shader2DSources.cpp. */
 
 
 /* Default 2D shader: */
@@ -629,10 +1008,23 @@ ATD::Shader2D::PLAIN_FRAGMENT_SOURCE;
 
 ATD::Shader2D::Shader2D(const std::string &vertexSource, 
 		const std::string &fragmentSource)
-	: Shader(vertexSource, fragmentSource)
+	: Shader2D(std::vector<std::string>(1, vertexSource), 
+			std::vector<std::string>(1, fragmentSource))
+{}
+
+ATD::Shader2D::Shader2D(const std::vector<std::string> &vertexModules, 
+		const std::vector<std::string> &fragmentModules)
+	: Shader(vertexModules, fragmentModules)
 	, m_attrIndices()
+	, m_transformUniform()
 {
 	checkAttributes();
+
+	try {
+		m_transformUniform = getUniformHandle<Matrix3F>("unfTransform");
+	} catch (const std::exception &e) {
+		/* Not every shader is transformed. */
+	}
 }
 
 const ATD::VertexBuffer2D::AttrIndices &ATD::Shader2D::getAttrIndices() const
@@ -643,6 +1035,9 @@ void ATD::Shader2D::checkAttributes()
 	const AttrDesc positionADesc("atrPosition", Gl::FLOAT_VEC2);
 	const AttrDesc texCoordsADesc("atrTexCoord", Gl::FLOAT_VEC2);
 	const AttrDesc colorADesc("atrColor", Gl::FLOAT_VEC4);
+	const AttrDesc instanceTransformADesc("atrInstanceTransform", 
+			Gl::FLOAT_MAT3);
+	const AttrDesc instanceColorADesc("atrInstanceColor", Gl::FLOAT_VEC4);
 
 	AttrIndexMap attrIndexMap;
 	_fillAttrIndexMap(*this, attrIndexMap);
@@ -675,6 +1070,31 @@ void ATD::Shader2D::checkAttributes()
 			attrIndexMap.erase(colorAIter);
 		}
 	}
+	{
+		auto instanceTransformAIter = 
+			attrIndexMap.find(instanceTransformADesc);
+		if (instanceTransformAIter != attrIndexMap.end()) {
+			m_attrIndices.instanceTransformIndex = 
+				instanceTransformAIter->second;
+			m_attrIndices.instanceTransformIsRequired = true;
+			attrIndexMap.erase(instanceTransformAIter);
+		}
+	}
+	{
+		auto instanceColorAIter = attrIndexMap.find(instanceColorADesc);
+		if (instanceColorAIter != attrIndexMap.end()) {
+			m_attrIndices.instanceColorIndex = instanceColorAIter->second;
+			m_attrIndices.instanceColorIsRequired = true;
+			attrIndexMap.erase(instanceColorAIter);
+		}
+	}
+	if (m_attrIndices.instanceColorIsRequired && 
+			!m_attrIndices.instanceTransformIsRequired) {
+		throw std::runtime_error(Aux::printf(
+					"cannot create Shader2D with '%s', but without '%s'", 
+					_attrDescToStr(instanceColorADesc).c_str(), 
+					_attrDescToStr(instanceTransformADesc).c_str()));
+	}
 	if (attrIndexMap.size()) {
 		auto attrIter = attrIndexMap.begin();
 		std::string attrStr = _attrDescToStr(attrIter->first);
@@ -696,7 +1116,10 @@ void ATD::Shader2D::checkAttributes()
 /* ATD::Shader3D::PLAIN_FRAGMENT_SOURCE is set in Shader3DSources.cpp */
 
 /* ATD::Shader3D::LIGHT_VERTEX_SOURCE is set in Shader3DSources.cpp */
-/* ATD::Shader3D::LIGHT_FRAGMENT_SOURCE is set in Shader3DSources.cpp */
+
+/* ATD::Shader3D::INSTANCED_VERTEX_SOURCE is set in Shader3DSources.cpp */
+/* ATD::Shader3D::INSTANCED_LIGHT_VERTEX_SOURCE is set in 
+   Shader3DSources.cpp */
 
 /* ATD::Shader3D::LIGHT_FRAGMENT_SOURCE_TEMPLATE is set in 
    Shader3DSources.cpp */
@@ -704,6 +1127,15 @@ void ATD::Shader2D::checkAttributes()
 /* ATD::Shader3D::LIGHT_DFT_MAX_POINT_LIGHTS is set in Shader3DSources.cpp */
 /* ATD::Shader3D::LIGHT_DFT_MAX_SPOT_LIGHTS is set in Shader3DSources.cpp */
 
+/* ATD::Shader3D::LIGHT_BUFFER_FRAGMENT_SOURCE_TEMPLATE is set in 
+   Shader3DSources.cpp */
+/* ATD::Shader3D::LIGHT_TEXTURE_FRAGMENT_SOURCE is set in 
+   Shader3DSources.cpp */
+/* ATD::Shader3D::LIGHT_HEADER_TEXELS is set in Shader3DSources.cpp */
+/* ATD::Shader3D::LIGHT_TEXELS is set in Shader3DSources.cpp */
+/* ATD::Shader3D::LIGHT_BUFFER_BINDING is set in Shader3DSources.cpp */
+/* ATD::Shader3D::LIGHT_TEXTURE_UNIT is set in Shader3DSources.cpp */
+
 
 /* Default 3D shader: */
 
@@ -714,14 +1146,151 @@ const std::string ATD::Shader3D::DFT_FRAGMENT_SOURCE =
 	ATD::Shader3D::PLAIN_FRAGMENT_SOURCE;
 
 
+/* ATD::Shader3D::LightVariant: */
+
+bool ATD::Shader3D::LightVariant::operator<(
+		const ATD::Shader3D::LightVariant &other) const
+{
+	if (dirLightsNum != other.dirLightsNum) {
+		return dirLightsNum < other.dirLightsNum;
+	}
+	if (pointLightsNum != other.pointLightsNum) {
+		return pointLightsNum < other.pointLightsNum;
+	}
+	if (spotLightsNum != other.spotLightsNum) {
+		return spotLightsNum < other.spotLightsNum;
+	}
+	if (specular != other.specular) {
+		return specular < other.specular;
+	}
+	if (vertexColor != other.vertexColor) {
+		return vertexColor < other.vertexColor;
+	}
+	return storage < other.storage;
+}
+
+size_t ATD::Shader3D::LightVariant::texelsNum() const
+{
+	return LIGHT_HEADER_TEXELS + LIGHT_TEXELS * 
+		(dirLightsNum + pointLightsNum + spotLightsNum);
+}
+
+std::vector<std::string> ATD::Shader3D::LightVariant::fragmentModules() 
+	const
+{
+	std::vector<std::string> modules;
+	modules.push_back(Aux::printf(LIGHT_FRAGMENT_SOURCE_TEMPLATE.c_str(), 
+				dirLightsNum, 
+				pointLightsNum, 
+				spotLightsNum, 
+				specular ? 1u : 0u, 
+				vertexColor ? 1u : 0u));
+
+	if (storage == UNIFORM_BUFFER) {
+		modules.push_back(Aux::printf(
+					LIGHT_BUFFER_FRAGMENT_SOURCE_TEMPLATE.c_str(), 
+					static_cast<unsigned>(texelsNum())));
+	} else {
+		modules.push_back(LIGHT_TEXTURE_FRAGMENT_SOURCE);
+	}
+	return modules;
+}
+
+
+/* ATD::Shader3D::LightVariants auxiliary: */
+
+/* 0, 1, 2, 4, 8... */
+static unsigned _coveringLightsNum(unsigned lightsNum)
+{
+	unsigned coveringNum = lightsNum ? 1 : 0;
+	while (coveringNum < lightsNum) {
+		coveringNum <<= 1;
+	}
+	return coveringNum;
+}
+
+
+/* ATD::Shader3D::LightVariants: */
+
+ATD::Shader3D::LightVariants::LightVariants(bool instanced)
+	: m_instanced(instanced)
+	, m_shaders()
+{}
+
+ATD::Shader3D::Ptr ATD::Shader3D::LightVariants::get(
+		const ATD::Shader3D::LightVariant &required)
+{
+	const LightVariant variant = covering(required);
+
+	auto shaderIt = m_shaders.find(variant);
+	if (shaderIt != m_shaders.end()) {
+		return shaderIt->second;
+	}
+
+	if (variant.storage == LightVariant::UNIFORM_BUFFER && 
+			!gl.hasUniformBuffers()) {
+		throw std::runtime_error("uniform buffers are not supported");
+	}
+
+	/* The vertex shader object is shared by all the variants. */
+	Ptr shaderPtr = std::make_shared<Shader3D>(
+			std::vector<std::string>(1, m_instanced ? 
+				INSTANCED_LIGHT_VERTEX_SOURCE : LIGHT_VERTEX_SOURCE), 
+			variant.fragmentModules());
+
+	/* Block binding and sampler unit are not a part of the program
+	 * binary, so they are set here even for the cached ones. */
+	if (variant.storage == LightVariant::UNIFORM_BUFFER) {
+		Gl::Uint blockIndex = gl.getUniformBlockIndex(shaderPtr->glId(), 
+				"unfLights");
+		if (blockIndex == Gl::INVALID_INDEX) {
+			throw std::runtime_error(
+					"lighting shader has no 'unfLights' block");
+		}
+		gl.uniformBlockBinding(shaderPtr->glId(), blockIndex, 
+				LIGHT_BUFFER_BINDING);
+	} else {
+		shaderPtr->setUniformSampler2DUnit("unfLightTexture", 
+				LIGHT_TEXTURE_UNIT);
+	}
+
+	m_shaders.insert(std::make_pair(variant, shaderPtr));
+	return shaderPtr;
+}
+
+ATD::Shader3D::LightVariant ATD::Shader3D::LightVariants::covering(
+		const ATD::Shader3D::LightVariant &required)
+{
+	return LightVariant(_coveringLightsNum(required.dirLightsNum), 
+			_coveringLightsNum(required.pointLightsNum), 
+			_coveringLightsNum(required.spotLightsNum), 
+			required.specular, 
+			required.vertexColor, 
+			required.storage);
+}
+
+
 /* ATD::Shader3D: */
 
 ATD::Shader3D::Shader3D(const std::string &vertexSource, 
 		const std::string &fragmentSource)
-	: Shader(vertexSource, fragmentSource)
+	: Shader3D(std::vector<std::string>(1, vertexSource), 
+			std::vector<std::string>(1, fragmentSource))
+{}
+
+ATD::Shader3D::Shader3D(const std::vector<std::string> &vertexModules, 
+		const std::vector<std::string> &fragmentModules)
+	: Shader(vertexModules, fragmentModules)
 	, m_attrIndices()
+	, m_transformUniform()
 {
 	checkAttributes();
+
+	try {
+		m_transformUniform = getUniformHandle<Matrix4F>("unfTransform");
+	} catch (const std::exception &e) {
+		/* Not every shader is transformed. */
+	}
 }
 
 const ATD::VertexBuffer3D::AttrIndices &ATD::Shader3D::getAttrIndices() const
@@ -733,6 +1302,9 @@ void ATD::Shader3D::checkAttributes()
 	const AttrDesc texCoordsADesc("atrTexCoord", Gl::FLOAT_VEC2);
 	const AttrDesc normalADesc("atrNormal", Gl::FLOAT_VEC3);
 	const AttrDesc colorADesc("atrColor", Gl::FLOAT_VEC4);
+	const AttrDesc instanceTransformADesc("atrInstanceTransform", 
+			Gl::FLOAT_MAT4);
+	const AttrDesc instanceColorADesc("atrInstanceColor", Gl::FLOAT_VEC4);
 
 	AttrIndexMap attrIndexMap;
 	_fillAttrIndexMap(*this, attrIndexMap);
@@ -773,6 +1345,31 @@ void ATD::Shader3D::checkAttributes()
 			attrIndexMap.erase(colorAIter);
 		}
 	}
+	{
+		auto instanceTransformAIter = 
+			attrIndexMap.find(instanceTransformADesc);
+		if (instanceTransformAIter != attrIndexMap.end()) {
+			m_attrIndices.instanceTransformIndex = 
+				instanceTransformAIter->second;
+			m_attrIndices.instanceTransformIsRequired = true;
+			attrIndexMap.erase(instanceTransformAIter);
+		}
+	}
+	{
+		auto instanceColorAIter = attrIndexMap.find(instanceColorADesc);
+		if (instanceColorAIter != attrIndexMap.end()) {
+			m_attrIndices.instanceColorIndex = instanceColorAIter->second;
+			m_attrIndices.instanceColorIsRequired = true;
+			attrIndexMap.erase(instanceColorAIter);
+		}
+	}
+	if (m_attrIndices.instanceColorIsRequired && 
+			!m_attrIndices.instanceTransformIsRequired) {
+		throw std::runtime_error(Aux::printf(
+					"cannot create Shader3D with '%s', but without '%s'", 
+					_attrDescToStr(instanceColorADesc).c_str(), 
+					_attrDescToStr(instanceTransformADesc).c_str()));
+	}
 	if (attrIndexMap.size()) {
 		auto attrIter = attrIndexMap.begin();
 		std::string attrStr = _attrDescToStr(attrIter->first);
@@ -91,3 +91,33 @@ STRINGIFY_SHADER_130(
 );
 
 
+/* Vertex shader for drawing InstanceBuffer2D. */
+
+const std::string ATD::Shader2D::INSTANCED_VERTEX_SOURCE = 
+STRINGIFY_SHADER_130(
+	attribute vec2 atrPosition;
+	attribute vec2 atrTexCoord;
+	attribute vec4 atrColor;
+	attribute mat3 atrInstanceTransform;
+	attribute vec4 atrInstanceColor;
+
+	varying vec2 varTexCoord;
+	varying vec4 varColor;
+
+	uniform mat3 unfProject;
+	uniform mat3 unfTransform;
+
+
+	void main()
+	{
+		vec3 position = unfTransform * atrInstanceTransform * 
+			vec3(atrPosition, 1.f);
+		vec3 projection = unfProject * position;
+
+		varTexCoord = atrTexCoord;
+		varColor = atrColor * atrInstanceColor;
+		gl_Position = vec4(projection.xy, 0.f, 1.f);
+	}
+);
+
+
@@ -6,7 +6,6 @@
  * @copyright GPL v3.
  * @since     $Id: $ */
 
-#include <ATD/Core/Printf.hpp>
 #include <ATD/Graphics/Shader.hpp>
 
 /* '#version 130' Should be added within the macro, 
@@ -14,6 +13,12 @@
 #define STRINGIFY_SHADER_130(code) \
 	std::string("#version 130\n\n") + std::string(#code)
 
+/* Same, for shaders with uniform blocks (core since GLSL 1.40). */
+#define STRINGIFY_SHADER_130_UBO(code) \
+	std::string("#version 130\n" \
+			"#extension GL_ARB_uniform_buffer_object : require\n\n") + \
+	std::string(#code)
+
 
 /* Basic Shader3D for drawing textured model without normals: */
 
@@ -104,7 +109,11 @@ STRINGIFY_SHADER_130(
 /*	uniform sampler2D unfTextureCanvas; */
 /*	uniform sampler2D unfTexture1; */
 
-	uniform vec3 unfCameraPos;
+
+	/* Packed lights (see Lighting), defined in the light storage
+	 * module: LIGHT_BUFFER_FRAGMENT_SOURCE_TEMPLATE or
+	 * LIGHT_TEXTURE_FRAGMENT_SOURCE. */
+	vec4 LightTexel(int index);
 
 
 	/* Lighting types: */
@@ -143,22 +152,60 @@ STRINGIFY_SHADER_130(
 
 	/* Lighting parameters: */
 
-	const int MAX_DIR_LIGHTS = %u; /* Template arg #0. */
-	uniform int unfDirLightsNum;
-	uniform DirLight unfDirLights[MAX_DIR_LIGHTS];
+	/* Header texels: (lights numbers, specular power) and (camera
+	 * position). Then each light takes 4 texels: (color, ambient), 
+	 * (position, diffuse), (direction, specular), (attenuation, cutoff).
+	 * Directional lights go first, then point lights, then spot lights. */
+	const int HEADER_TEXELS = 2;
+	const int LIGHT_TEXELS = 4;
 
+	/* Zero light number is allowed. The loops are bounded by constants, 
+	 * so that the compiler drops the unused ones. */
+	const int MAX_DIR_LIGHTS = %u; /* Template arg #0. */
 	const int MAX_POINT_LIGHTS = %u; /* Template arg #1. */
-	uniform int unfPointLightsNum;
-	uniform PointLight unfPointLights[MAX_POINT_LIGHTS];
-
 	const int MAX_SPOT_LIGHTS = %u; /* Template arg #2. */
-	uniform int unfSpotLightsNum;
-	uniform SpotLight unfSpotLights[MAX_SPOT_LIGHTS];
 
 
-	/* Material parameters: */
+	/* Features: */
+
+	const bool SPECULAR = %u != 0; /* Template arg #3. */
+	const bool VERTEX_COLOR = %u != 0; /* Template arg #4. */
 
-	uniform float unfSpecularPower;
+
+	/* Set from the header in main(). */
+	vec3 cameraPos;
+	float specularPower;
+
+
+	Light LoadLight(int base)
+	{
+		vec4 texel0 = LightTexel(base);
+		return Light(texel0.rgb, texel0.a, 
+			LightTexel(base + 1).a, 
+			LightTexel(base + 2).a);
+	}
+
+	DirLight LoadDirLight(int index)
+	{
+		int base = HEADER_TEXELS + LIGHT_TEXELS * index;
+		return DirLight(LoadLight(base), LightTexel(base + 2).xyz);
+	}
+
+	PointLight LoadPointLight(int index)
+	{
+		int base = HEADER_TEXELS + LIGHT_TEXELS * index;
+		return PointLight(LoadLight(base), 
+			LightTexel(base + 1).xyz, 
+			LightTexel(base + 3).xyz);
+	}
+
+	SpotLight LoadSpotLight(int index)
+	{
+		int base = HEADER_TEXELS + LIGHT_TEXELS * index;
+		return SpotLight(LoadPointLight(index), 
+			LightTexel(base + 2).xyz, 
+			LightTexel(base + 3).w);
+	}
 
 
 	vec3 ApplyLight(vec3 fgPosition, vec3 fgNormal, 
@@ -166,26 +213,31 @@ STRINGIFY_SHADER_130(
 	{
 		vec3 ltDirection1 = normalize(ltDirection);
 		vec3 fgNormal1 = normalize(fgNormal);
-		vec3 cmDirection1 = normalize(unfCameraPos - fgPosition);
 
 		float ftDiffuse = dot(ltDirection1, fgNormal1 * (-1.f));
-		float ftSpecular = pow(
-			max(
-				dot(
-					cmDirection1, 
-					normalize(reflect(ltDirection1, fgNormal1))
-				), 
-				0.f), 
-			unfSpecularPower);
 
 		vec3 ltAmbient = lt.color * lt.ambient * ltIntensity;
 		vec3 ltDiffuse = (ftDiffuse > 0.f) ? 
 			lt.color * lt.diffuse * ltIntensity * ftDiffuse : 
 			vec3(0.f);
-		vec3 ltSpecular = (ftDiffuse > 0.f && ftSpecular > 0.f) ? 
-			lt.color * lt.specular * ltIntensity * ftSpecular * 
-				smoothstep(0.0f, 0.2f, ftDiffuse) : 
-			vec3(0.f);
+
+		vec3 ltSpecular = vec3(0.f);
+		if (SPECULAR && ftDiffuse > 0.f) {
+			vec3 cmDirection1 = normalize(cameraPos - fgPosition);
+			float ftSpecular = pow(
+				max(
+					dot(
+						cmDirection1, 
+						normalize(reflect(ltDirection1, fgNormal1))
+					), 
+					0.f), 
+				specularPower);
+
+			if (ftSpecular > 0.f) {
+				ltSpecular = lt.color * lt.specular * ltIntensity * 
+					ftSpecular * smoothstep(0.0f, 0.2f, ftDiffuse);
+			}
+		}
 
 		vec3 light = ltAmbient + ltDiffuse + ltSpecular;
 		return light;
@@ -232,36 +284,144 @@ STRINGIFY_SHADER_130(
 
 	void main()
 	{
+		/*   Header. */
+		vec4 header = LightTexel(0);
+		int dirLightsNum = int(header.x);
+		int pointLightsNum = int(header.y);
+		int spotLightsNum = int(header.z);
+		specularPower = header.w;
+		cameraPos = LightTexel(1).xyz;
+
 		/*   Light. */
 		vec3 light = vec3(0.f);
-		for(int dltIndex = 0; dltIndex < unfDirLightsNum; dltIndex++) {
+		for(int dltIndex = 0; dltIndex < MAX_DIR_LIGHTS; dltIndex++) {
+			if (dltIndex >= dirLightsNum) { break; }
 			light += ApplyDirLight(varPosition, varNormal, 
-				unfDirLights[dltIndex]);
+				LoadDirLight(dltIndex));
 		}
-		for(int pltIndex = 0; pltIndex < unfPointLightsNum; pltIndex++) {
+		for(int pltIndex = 0; pltIndex < MAX_POINT_LIGHTS; pltIndex++) {
+			if (pltIndex >= pointLightsNum) { break; }
 			light += ApplyPointLight(varPosition, varNormal, 
-				unfPointLights[pltIndex]);
+				LoadPointLight(dirLightsNum + pltIndex));
 		}
-		for(int sltIndex = 0; sltIndex < unfSpotLightsNum; sltIndex++) {
+		for(int sltIndex = 0; sltIndex < MAX_SPOT_LIGHTS; sltIndex++) {
+			if (sltIndex >= spotLightsNum) { break; }
 			light += ApplySpotLight(varPosition, varNormal, 
-				unfSpotLights[sltIndex]);
+				LoadSpotLight(dirLightsNum + pointLightsNum + sltIndex));
 		}
 
 		/*   Texel color. */
 		vec4 txColor = texture2D(unfTexture0, varTexCoord);
+		if (VERTEX_COLOR) {
+			txColor *= varColor;
+		}
+
+		gl_FragColor = txColor * vec4(light, 1.f);
+	}
+);
+
+/* Light storage modules, linked with LIGHT_FRAGMENT_SOURCE_TEMPLATE: */
+
+const std::string ATD::Shader3D::LIGHT_BUFFER_FRAGMENT_SOURCE_TEMPLATE = 
+STRINGIFY_SHADER_130_UBO(
+	layout(std140) uniform unfLights
+	{
+		vec4 unfLightTexels[%u]; /* Template arg #0. */
+	};
+
+	vec4 LightTexel(int index)
+	{
+		return unfLightTexels[index];
+	}
+);
+
+const std::string ATD::Shader3D::LIGHT_TEXTURE_FRAGMENT_SOURCE = 
+STRINGIFY_SHADER_130(
+	uniform sampler2D unfLightTexture;
+
+	vec4 LightTexel(int index)
+	{
+		int width = textureSize(unfLightTexture, 0).x;
+		return texelFetch(unfLightTexture, 
+			ivec2(index % width, index / width), 0);
+	}
+);
+
+/* Vertex shaders for drawing InstanceBuffer3D: */
+
+const std::string ATD::Shader3D::INSTANCED_VERTEX_SOURCE = 
+STRINGIFY_SHADER_130(
+	attribute vec3 atrPosition;
+	attribute vec2 atrTexCoord;
+	attribute vec4 atrColor;
+	attribute mat4 atrInstanceTransform;
+	attribute vec4 atrInstanceColor;
+
+	varying vec2 varTexCoord;
+	varying vec4 varColor;
 
-		gl_FragColor = txColor * varColor * vec4(light, 1.f);
+	uniform mat4 unfTransform;
+	uniform mat4 unfProject;
+
+
+	void main()
+	{
+		vec4 position = unfTransform * atrInstanceTransform * 
+			vec4(atrPosition, 1.f);
+
+		varTexCoord = atrTexCoord;
+		varColor = atrColor * atrInstanceColor;
+		gl_Position = unfProject * position;
 	}
 );
 
+const std::string ATD::Shader3D::INSTANCED_LIGHT_VERTEX_SOURCE = 
+STRINGIFY_SHADER_130(
+	attribute vec3 atrPosition;
+	attribute vec2 atrTexCoord;
+	attribute vec3 atrNormal;
+	attribute vec4 atrColor;
+	attribute mat4 atrInstanceTransform;
+	attribute vec4 atrInstanceColor;
+
+	varying vec3 varPosition;
+	varying vec2 varTexCoord;
+	varying vec3 varNormal;
+	varying vec4 varColor;
+
+	uniform mat4 unfTransform;
+	uniform mat4 unfProject;
+
+
+	void main()
+	{
+		mat4 transform = unfTransform * atrInstanceTransform;
+
+		mat3 vec3Transform;
+		vec3Transform[0] = transform[0].xyz;
+		vec3Transform[1] = transform[1].xyz;
+		vec3Transform[2] = transform[2].xyz;
+
+		vec4 position = transform * vec4(atrPosition, 1.f);
+
+		varPosition = position.xyz;
+		varTexCoord = atrTexCoord;
+		varNormal = normalize(vec3Transform * atrNormal);
+		varColor = atrColor * atrInstanceColor;
+		gl_Position = unfProject * position;
+	}
+);
+
+
 const unsigned ATD::Shader3D::LIGHT_DFT_MAX_DIR_LIGHTS   = 1;
 const unsigned ATD::Shader3D::LIGHT_DFT_MAX_POINT_LIGHTS = 3;
 const unsigned ATD::Shader3D::LIGHT_DFT_MAX_SPOT_LIGHTS  = 1;
 
-const std::string ATD::Shader3D::LIGHT_FRAGMENT_SOURCE = 
-	ATD::Aux::printf(ATD::Shader3D::LIGHT_FRAGMENT_SOURCE_TEMPLATE.c_str(), 
-			ATD::Shader3D::LIGHT_DFT_MAX_DIR_LIGHTS, 
-			ATD::Shader3D::LIGHT_DFT_MAX_POINT_LIGHTS, 
-			ATD::Shader3D::LIGHT_DFT_MAX_SPOT_LIGHTS);
+const unsigned ATD::Shader3D::LIGHT_HEADER_TEXELS = 2;
+const unsigned ATD::Shader3D::LIGHT_TEXELS = 4;
+
+const ATD::Gl::Uint ATD::Shader3D::LIGHT_BUFFER_BINDING = 0;
+const ATD::Texture::Unit ATD::Shader3D::LIGHT_TEXTURE_UNIT = 
+	ATD::Texture::TEX_6;
 
 
@@ -0,0 +1,525 @@
+/**
+ * @file      
+ * @brief     Software rasterizer, drawing into an Image.
+ * @details   ...
+ * @author    ArthurTheDigital (arthurthedigital@gmail.com)
+ * @copyright GPL v3.
+ * @since     $Id: $ */
+
+#include <ATD/Graphics/SoftFrameBuffer.hpp>
+
+#include <ATD/Core/Matrix3.hpp>
+#include <ATD/Core/Matrix4.hpp>
+
+#include <math.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+
+/* ATD::SoftFrameBuffer constants: */
+
+const size_t ATD::SoftFrameBuffer::TILE_SIZE = 64;
+
+
+/* ATD::SoftFrameBuffer auxiliary: */
+
+/* Same as in FrameBuffer.cpp: pixels to OpenGL coordinates. */
+static ATD::Matrix3F _coords2DMatrix(const ATD::Vector2S &size)
+{
+	ATD::Transform2D scale;
+	scale.setScale(ATD::Vector2D(2.f / static_cast<float>(size.x), 
+				2.f / static_cast<float>(size.y)));
+
+	ATD::Transform2D offset;
+	offset.setOffset(ATD::Vector2D(-1., -1.));
+
+	return offset.matrix() * scale.matrix();
+}
+
+/* Same as in FrameBuffer.cpp: 3D objects are drawn Y-flipped. */
+static ATD::Matrix4F _yFlip3D()
+{
+	ATD::Matrix4F yFlip;
+	yFlip[1][1] = -1.f;
+
+	return yFlip;
+}
+
+/* Vertex indices of the triangles, the primitive consists of. */
+static std::vector<size_t> _triangleIndices(size_t verticesNum, 
+		bool isStrip, bool isFan)
+{
+	std::vector<size_t> indices;
+	if (isStrip || isFan) {
+		for (size_t vIndex = 2; vIndex < verticesNum; vIndex++) {
+			indices.push_back(isFan ? 0 : vIndex - 2);
+			indices.push_back(vIndex - 1);
+			indices.push_back(vIndex);
+		}
+	} else {
+		for (size_t vIndex = 0; vIndex + 2 < verticesNum; vIndex += 3) {
+			indices.push_back(vIndex);
+			indices.push_back(vIndex + 1);
+			indices.push_back(vIndex + 2);
+		}
+	}
+	return indices;
+}
+
+/* Distance to the near clipping plane (z == -w), positive inside. */
+static float _nearDistance(const ATD::Vector4F &clipPosition)
+{
+	return clipPosition.z + clipPosition.w;
+}
+
+/* Edge function: twice the signed area of (a, b, (x, y)). */
+static float _edge(float ax, float ay, float bx, float by, float x, float y)
+{
+	return (bx - ax) * (y - ay) - (by - ay) * (x - ax);
+}
+
+/* Whether the pixels exactly on the edge belong to the triangle, for 
+ * counter-clockwise triangles (top-left rule). */
+static bool _isTopLeft(float ax, float ay, float bx, float by)
+{
+	return by < ay || (by == ay && bx < ax);
+}
+
+static uint8_t _unorm8(float value)
+{
+	return static_cast<uint8_t>(
+			std::min(std::max(value, 0.f), 1.f) * 255.f + 0.5f);
+}
+
+/* Texel with NEAREST filter and REPEAT wrap. */
+static ATD::Pixel _sample(const ATD::Image &texture, float u, float v)
+{
+	const ATD::Vector2S &size = texture.size();
+	long x = static_cast<long>(::floorf(u * static_cast<float>(size.x)));
+	long y = static_cast<long>(::floorf(v * static_cast<float>(size.y)));
+
+	x %= static_cast<long>(size.x);
+	y %= static_cast<long>(size.y);
+	if (x < 0) { x += static_cast<long>(size.x); }
+	if (y < 0) { y += static_cast<long>(size.y); }
+
+	return texture.data()[static_cast<size_t>(y) * size.x + 
+		static_cast<size_t>(x)];
+}
+
+
+/* ATD::SoftFrameBuffer: */
+
+ATD::SoftFrameBuffer::SoftFrameBuffer(const ATD::Vector2S &size, 
+		bool hasDepth, 
+		size_t threadsNum)
+	: m_size(size)
+	, m_hasDepth(hasDepth)
+	, m_threadsNum(threadsNum ? threadsNum : 
+			std::max<size_t>(std::thread::hardware_concurrency(), 1))
+	, m_projection2D()
+	, m_projection3D()
+	, m_blend(REPLACE)
+	, m_image(size)
+	, m_depth(hasDepth ? size.x * size.y : 0, 1.f)
+	, m_draws()
+	, m_triangles()
+{
+	m_projection3D.setAspectRatio(aspectRatio());
+	clear();
+}
+
+double ATD::SoftFrameBuffer::aspectRatio() const
+{
+	return static_cast<double>(m_size.x) / static_cast<double>(m_size.y);
+}
+
+void ATD::SoftFrameBuffer::setProjection2D(
+		const ATD::Projection2D &projection2D)
+{
+	m_projection2D = projection2D;
+}
+
+void ATD::SoftFrameBuffer::setProjection3D(
+		const ATD::Projection3D &projection3D)
+{
+	m_projection3D = projection3D;
+}
+
+void ATD::SoftFrameBuffer::clear(const ATD::Pixel &color)
+{
+	/* Everything pending would be overwritten anyway. */
+	m_draws.clear();
+	m_triangles.clear();
+
+	std::fill(m_image.data(), m_image.data() + m_size.x * m_size.y, color);
+	std::fill(m_depth.begin(), m_depth.end(), 1.f);
+}
+
+void ATD::SoftFrameBuffer::draw(
+		const std::vector<ATD::Vertex2D::GlVertex> &glVertices, 
+		const ATD::Image::CPtr &texturePtr, 
+		const ATD::Transform2D &transform, 
+		const ATD::VertexBuffer2D::Primitive &primitive)
+{
+	Draw draw;
+	draw.texturePtr = texturePtr;
+	draw.blend = m_blend;
+	draw.isDepthTested = false;
+	m_draws.push_back(draw);
+
+	Matrix3F matrix = m_projection2D.matrix() * 
+		_coords2DMatrix(m_size) * 
+		transform.matrix();
+
+	std::vector<size_t> indices = _triangleIndices(glVertices.size(), 
+			primitive == VertexBuffer2D::TRIANGLE_STRIP, 
+			primitive == VertexBuffer2D::TRIANGLE_FAN);
+
+	for (size_t iIndex = 0; iIndex < indices.size(); iIndex += 3) {
+		Vector4F clipPositions[3];
+		Vector2F texCoords[3];
+		Vector4F colors[3];
+		for (size_t vIndex = 0; vIndex < 3; vIndex++) {
+			const Vertex2D::GlVertex &glVertex = 
+				glVertices[indices[iIndex + vIndex]];
+
+			Vector3F position = matrix * Vector3F(glVertex.position.x, 
+					glVertex.position.y, 1.f);
+
+			clipPositions[vIndex] = Vector4F(position.x, position.y, 
+					0.f, 1.f);
+			texCoords[vIndex] = glVertex.texCoords;
+			colors[vIndex] = glVertex.color;
+		}
+		addTriangle(clipPositions, texCoords, colors);
+	}
+}
+
+void ATD::SoftFrameBuffer::draw(const ATD::VertexBuffer2D::Builder &builder, 
+		const ATD::Image::CPtr &texturePtr, 
+		const ATD::Transform2D &transform)
+{
+	draw(builder.glVertices(), texturePtr, transform);
+}
+
+void ATD::SoftFrameBuffer::draw(
+		const std::vector<ATD::Vertex3D::GlVertex> &glVertices, 
+		const ATD::Image::CPtr &texturePtr, 
+		const ATD::Transform3D &transform, 
+		const ATD::VertexBuffer3D::Primitive &primitive)
+{
+	Draw draw;
+	draw.texturePtr = texturePtr;
+	draw.blend = m_blend;
+	draw.isDepthTested = m_hasDepth;
+	m_draws.push_back(draw);
+
+	Matrix4F matrix = _yFlip3D() * m_projection3D.matrix() * 
+		transform.matrix();
+
+	std::vector<size_t> indices = _triangleIndices(glVertices.size(), 
+			primitive == VertexBuffer3D::TRIANGLE_STRIP, 
+			primitive == VertexBuffer3D::TRIANGLE_FAN);
+
+	for (size_t iIndex = 0; iIndex < indices.size(); iIndex += 3) {
+		Vector4F clipPositions[3];
+		Vector2F texCoords[3];
+		Vector4F colors[3];
+		for (size_t vIndex = 0; vIndex < 3; vIndex++) {
+			const Vertex3D::GlVertex &glVertex = 
+				glVertices[indices[iIndex + vIndex]];
+
+			clipPositions[vIndex] = matrix * Vector4F(glVertex.position.x, 
+					glVertex.position.y, glVertex.position.z, 1.f);
+			texCoords[vIndex] = glVertex.texCoords;
+			colors[vIndex] = glVertex.color;
+		}
+		addTriangle(clipPositions, texCoords, colors);
+	}
+}
+
+void ATD::SoftFrameBuffer::flush()
+{
+	if (m_triangles.empty()) {
+		m_draws.clear();
+		return;
+	}
+
+	/* Bin the triangles by their bounding boxes. */
+	size_t tilesX = (m_size.x + TILE_SIZE - 1) / TILE_SIZE;
+	size_t tilesY = (m_size.y + TILE_SIZE - 1) / TILE_SIZE;
+	std::vector<std::vector<size_t> > bins(tilesX * tilesY);
+
+	for (size_t tIndex = 0; tIndex < m_triangles.size(); tIndex++) {
+		const RasterVertex *vertices = m_triangles[tIndex].vertices;
+		float minX = std::min(std::min(vertices[0].x, vertices[1].x), 
+				vertices[2].x);
+		float maxX = std::max(std::max(vertices[0].x, vertices[1].x), 
+				vertices[2].x);
+		float minY = std::min(std::min(vertices[0].y, vertices[1].y), 
+				vertices[2].y);
+		float maxY = std::max(std::max(vertices[0].y, vertices[1].y), 
+				vertices[2].y);
+
+		if (maxX < 0.f || maxY < 0.f || 
+				minX >= static_cast<float>(m_size.x) || 
+				minY >= static_cast<float>(m_size.y)) {
+			continue;
+		}
+
+		size_t tileX0 = static_cast<size_t>(std::max(minX, 0.f)) /
+			TILE_SIZE;
+		size_t tileY0 = static_cast<size_t>(std::max(minY, 0.f)) /
+			TILE_SIZE;
+		size_t tileX1 = std::min(static_cast<size_t>(maxX) / TILE_SIZE, 
+				tilesX - 1);
+		size_t tileY1 = std::min(static_cast<size_t>(maxY) / TILE_SIZE, 
+				tilesY - 1);
+
+		for (size_t tileY = tileY0; tileY <= tileY1; tileY++) {
+			for (size_t tileX = tileX0; tileX <= tileX1; tileX++) {
+				bins[tileY * tilesX + tileX].push_back(tIndex);
+			}
+		}
+	}
+
+	/* Each tile is owned by a single thread, so the triangles are drawn 
+	 * in order and no pixel is written concurrently. */
+	std::atomic<size_t> nextTile(0);
+	auto worker = [&]() {
+		for (size_t tileIndex = nextTile++; tileIndex < bins.size();
+				tileIndex = nextTile++) {
+			if (!bins[tileIndex].empty()) {
+				rasterizeTile(tileIndex, bins[tileIndex]);
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	size_t threadsNum = std::min(m_threadsNum, bins.size());
+	for (size_t thIndex = 1; thIndex < threadsNum; thIndex++) {
+		threads.push_back(std::thread(worker));
+	}
+	worker();
+	for (auto &thread : threads) {
+		thread.join();
+	}
+
+	m_draws.clear();
+	m_triangles.clear();
+}
+
+const ATD::Image &ATD::SoftFrameBuffer::image()
+{
+	flush();
+	return m_image;
+}
+
+void ATD::SoftFrameBuffer::addTriangle(
+		const ATD::Vector4F (&clipPositions)[3], 
+		const ATD::Vector2F (&texCoords)[3], 
+		const ATD::Vector4F (&colors)[3])
+{
+	/* Clip against the near plane only: the rest is clipped while 
+	 * binning and rasterizing. */
+	Vector4F polyPositions[4];
+	Vector2F polyTexCoords[4];
+	Vector4F polyColors[4];
+	size_t polySize = 0;
+
+	for (size_t vIndex = 0; vIndex < 3; vIndex++) {
+		size_t vNext = (vIndex + 1) % 3;
+		float distance = _nearDistance(clipPositions[vIndex]);
+		float distanceNext = _nearDistance(clipPositions[vNext]);
+
+		if (distance >= 0.f) {
+			polyPositions[polySize] = clipPositions[vIndex];
+			polyTexCoords[polySize] = texCoords[vIndex];
+			polyColors[polySize] = colors[vIndex];
+			polySize++;
+		}
+		if ((distance >= 0.f) != (distanceNext >= 0.f)) {
+			float t = distance / (distance - distanceNext);
+			polyPositions[polySize] = clipPositions[vIndex] + 
+				(clipPositions[vNext] - clipPositions[vIndex]) * t;
+			polyTexCoords[polySize] = texCoords[vIndex] + 
+				(texCoords[vNext] - texCoords[vIndex]) * t;
+			polyColors[polySize] = colors[vIndex] + 
+				(colors[vNext] - colors[vIndex]) * t;
+			polySize++;
+		}
+	}
+
+	for (size_t pIndex = 2; pIndex < polySize; pIndex++) {
+		Triangle triangle;
+		triangle.vertices[0] = rasterVertex(polyPositions[0], 
+				polyTexCoords[0], polyColors[0]);
+		triangle.vertices[1] = rasterVertex(polyPositions[pIndex - 1], 
+				polyTexCoords[pIndex - 1], polyColors[pIndex - 1]);
+		triangle.vertices[2] = rasterVertex(polyPositions[pIndex], 
+				polyTexCoords[pIndex], polyColors[pIndex]);
+		triangle.drawIndex = m_draws.size() - 1;
+		m_triangles.push_back(triangle);
+	}
+}
+
+ATD::SoftFrameBuffer::RasterVertex ATD::SoftFrameBuffer::rasterVertex(
+		const ATD::Vector4F &clipPosition, 
+		const ATD::Vector2F &texCoords, 
+		const ATD::Vector4F &color) const
+{
+	/* Attributes are divided by W for perspective-correct interpolation, 
+	 * the same way OpenGL does. */
+	float invW = clipPosition.w != 0.f ? 1.f / clipPosition.w : 1.f;
+
+	RasterVertex result;
+	result.x = (clipPosition.x * invW + 1.f) * 0.5f * 
+		static_cast<float>(m_size.x);
+	result.y = (clipPosition.y * invW + 1.f) * 0.5f * 
+		static_cast<float>(m_size.y);
+	result.z = (clipPosition.z * invW + 1.f) * 0.5f;
+	result.invW = invW;
+	result.u = texCoords.x * invW;
+	result.v = texCoords.y * invW;
+	result.color[0] = color.x * invW;
+	result.color[1] = color.y * invW;
+	result.color[2] = color.z * invW;
+	result.color[3] = color.w * invW;
+	return result;
+}
+
+void ATD::SoftFrameBuffer::rasterizeTile(size_t tileIndex, 
+		const std::vector<size_t> &triangleIds)
+{
+	size_t tilesX = (m_size.x + TILE_SIZE - 1) / TILE_SIZE;
+	long tileX = static_cast<long>(tileIndex % tilesX * TILE_SIZE);
+	long tileY = static_cast<long>(tileIndex / tilesX * TILE_SIZE);
+
+	RectL tile(tileX, tileY, 
+			std::min(static_cast<long>(TILE_SIZE), 
+				static_cast<long>(m_size.x) - tileX), 
+			std::min(static_cast<long>(TILE_SIZE), 
+				static_cast<long>(m_size.y) - tileY));
+
+	for (auto &tIndex : triangleIds) {
+		rasterizeTriangle(m_triangles[tIndex], tile);
+	}
+}
+
+void ATD::SoftFrameBuffer::rasterizeTriangle(
+		const ATD::SoftFrameBuffer::Triangle &triangle, 
+		const ATD::RectL &tile)
+{
+	const Draw &draw = m_draws[triangle.drawIndex];
+	const RasterVertex *v0 = &triangle.vertices[0];
+	const RasterVertex *v1 = &triangle.vertices[1];
+	const RasterVertex *v2 = &triangle.vertices[2];
+
+	/* No face culling (same as FrameBuffer), so the winding is made 
+	 * counter-clockwise. */
+	float area = _edge(v0->x, v0->y, v1->x, v1->y, v2->x, v2->y);
+	if (area == 0.f || area != area) {
+		return;
+	}
+	if (area < 0.f) {
+		std::swap(v1, v2);
+		area = -area;
+	}
+
+	long minX = std::max(tile.x, static_cast<long>(::floorf(
+					std::min(std::min(v0->x, v1->x), v2->x))));
+	long maxX = std::min(tile.x + tile.w - 1, static_cast<long>(::ceilf(
+					std::max(std::max(v0->x, v1->x), v2->x))));
+	long minY = std::max(tile.y, static_cast<long>(::floorf(
+					std::min(std::min(v0->y, v1->y), v2->y))));
+	long maxY = std::min(tile.y + tile.h - 1, static_cast<long>(::ceilf(
+					std::max(std::max(v0->y, v1->y), v2->y))));
+
+	bool isTopLeft0 = _isTopLeft(v1->x, v1->y, v2->x, v2->y);
+	bool isTopLeft1 = _isTopLeft(v2->x, v2->y, v0->x, v0->y);
+	bool isTopLeft2 = _isTopLeft(v0->x, v0->y, v1->x, v1->y);
+
+	/* Edge functions change linearly, so they are stepped per pixel. */
+	float stepX0 = v1->y - v2->y;
+	float stepX1 = v2->y - v0->y;
+	float stepX2 = v0->y - v1->y;
+
+	const Image *texturePtr = draw.texturePtr.get();
+	float invArea = 1.f / area;
+
+	for (long y = minY; y <= maxY; y++) {
+		float centerX = static_cast<float>(minX) + 0.5f;
+		float centerY = static_cast<float>(y) + 0.5f;
+		float w0 = _edge(v1->x, v1->y, v2->x, v2->y, centerX, centerY);
+		float w1 = _edge(v2->x, v2->y, v0->x, v0->y, centerX, centerY);
+		float w2 = _edge(v0->x, v0->y, v1->x, v1->y, centerX, centerY);
+
+		for (long x = minX; x <= maxX; x++, 
+				w0 += stepX0, w1 += stepX1, w2 += stepX2) {
+			if (w0 < 0.f || w1 < 0.f || w2 < 0.f || 
+					(w0 == 0.f && !isTopLeft0) || 
+					(w1 == 0.f && !isTopLeft1) || 
+					(w2 == 0.f && !isTopLeft2)) {
+				continue;
+			}
+
+			float b0 = w0 * invArea;
+			float b1 = w1 * invArea;
+			float b2 = w2 * invArea;
+			size_t pixelIndex = static_cast<size_t>(y) * m_size.x + 
+				static_cast<size_t>(x);
+
+			/* Depth is interpolated linearly in screen space. */
+			float z = b0 * v0->z + b1 * v1->z + b2 * v2->z;
+			if (z < 0.f || z > 1.f) {
+				continue;
+			}
+			if (draw.isDepthTested) {
+				if (!(z < m_depth[pixelIndex])) {
+					continue;
+				}
+				m_depth[pixelIndex] = z;
+			}
+
+			float w = 1.f / (b0 * v0->invW + b1 * v1->invW + b2 * v2->invW);
+			float color[4];
+			for (size_t cIndex = 0; cIndex < 4; cIndex++) {
+				color[cIndex] = (b0 * v0->color[cIndex] + 
+						b1 * v1->color[cIndex] + 
+						b2 * v2->color[cIndex]) * w;
+			}
+
+			if (texturePtr) {
+				Pixel texel = _sample(*texturePtr, 
+						(b0 * v0->u + b1 * v1->u + b2 * v2->u) * w, 
+						(b0 * v0->v + b1 * v1->v + b2 * v2->v) * w);
+				color[0] *= static_cast<float>(texel.r) / 255.f;
+				color[1] *= static_cast<float>(texel.g) / 255.f;
+				color[2] *= static_cast<float>(texel.b) / 255.f;
+				color[3] *= static_cast<float>(texel.a) / 255.f;
+			}
+
+			Pixel &pixel = m_image.data()[pixelIndex];
+			if (draw.blend == ALPHA) {
+				float alpha = std::min(std::max(color[3], 0.f), 1.f);
+				float canvasAlpha = static_cast<float>(pixel.a) / 255.f;
+				pixel = Pixel(
+						_unorm8(static_cast<float>(pixel.r) / 255.f * 
+							(1.f - alpha) + color[0] * alpha), 
+						_unorm8(static_cast<float>(pixel.g) / 255.f * 
+							(1.f - alpha) + color[1] * alpha), 
+						_unorm8(static_cast<float>(pixel.b) / 255.f * 
+							(1.f - alpha) + color[2] * alpha), 
+						_unorm8(canvasAlpha + color[3]));
+			} else {
+				pixel = Pixel(_unorm8(color[0]), _unorm8(color[1]), 
+						_unorm8(color[2]), _unorm8(color[3]));
+			}
+		}
+	}
+}
+
+
@@ -9,9 +9,15 @@
 #include <ATD/Graphics/Texture.hpp>
 
 #include <ATD/Core/Debug.hpp>
+#include <ATD/Core/MinMax.hpp>
+#include <ATD/Core/Printf.hpp>
 #include <ATD/Graphics/GlCheck.hpp>
 
+#include <stdint.h>
+#include <string.h>
+
 #include <map>
+#include <stdexcept>
 #include <vector>
 
 
@@ -48,6 +54,12 @@ static const std::map<ATD::Texture::Type, ATD::Gl::Enum> _TEX_TYPES = {
 	{ ATD::Texture::CUBE_MAP, ATD::Gl::TEXTURE_CUBE_MAP }
 };
 
+static const std::map<ATD::Texture::Wrap, ATD::Gl::Enum> _WRAPS = {
+	{ ATD::Texture::CLAMP_TO_EDGE, ATD::Gl::CLAMP_TO_EDGE }, 
+	{ ATD::Texture::REPEAT, ATD::Gl::REPEAT }, 
+	{ ATD::Texture::MIRRORED_REPEAT, ATD::Gl::MIRRORED_REPEAT }
+};
+
 static const std::map<ATD::Texture::Unit, ATD::Gl::Enum> _TEX_UNITS = {
 	{ ATD::Texture::TEX_0, ATD::Gl::TEXTURE0 }, 
 	{ ATD::Texture::TEX_1, ATD::Gl::TEXTURE1 }, 
@@ -59,6 +71,137 @@ static const std::map<ATD::Texture::Unit, ATD::Gl::Enum> _TEX_UNITS = {
 	{ ATD::Texture::TEX_7, ATD::Gl::TEXTURE7 }
 };
 
+static ATD::Gl::Enum _glMinFilter(const ATD::Texture::Filter &filter, 
+		bool hasMipmaps)
+{
+	if (hasMipmaps) {
+		return filter == ATD::Texture::NEAREST ? 
+			ATD::Gl::NEAREST_MIPMAP_NEAREST : 
+			ATD::Gl::LINEAR_MIPMAP_LINEAR;
+	}
+	return filter == ATD::Texture::NEAREST ? 
+		ATD::Gl::NEAREST : 
+		ATD::Gl::LINEAR;
+}
+
+static ATD::Gl::Enum _glMagFilter(const ATD::Texture::Filter &filter)
+{
+	return filter == ATD::Texture::NEAREST ? 
+		ATD::Gl::NEAREST : 
+		ATD::Gl::LINEAR;
+}
+
+static inline uint8_t _average(unsigned v00, unsigned v01, 
+		unsigned v10, unsigned v11)
+{
+	return static_cast<uint8_t>((v00 + v01 + v10 + v11 + 2) / 4);
+}
+
+/* Half size image, each pixel is an average of 2x2 (or less on the odd 
+ * size edges) source pixels. */
+static ATD::Image _boxFiltered(const ATD::Image &image)
+{
+	const ATD::Vector2S &srcSize = image.size();
+	ATD::Vector2S dstSize(srcSize.x > 1 ? srcSize.x / 2 : 1, 
+			srcSize.y > 1 ? srcSize.y / 2 : 1);
+
+	ATD::Image result(dstSize);
+	const ATD::Pixel *src = image.data();
+	ATD::Pixel *dst = result.data();
+
+	for (size_t dstY = 0; dstY < dstSize.y; dstY++) {
+		size_t srcY0 = dstY * 2;
+		size_t srcY1 = srcY0 + 1 < srcSize.y ? srcY0 + 1 : srcY0;
+
+		for (size_t dstX = 0; dstX < dstSize.x; dstX++) {
+			size_t srcX0 = dstX * 2;
+			size_t srcX1 = srcX0 + 1 < srcSize.x ? srcX0 + 1 : srcX0;
+
+			const ATD::Pixel &p00 = src[srcY0 * srcSize.x + srcX0];
+			const ATD::Pixel &p01 = src[srcY0 * srcSize.x + srcX1];
+			const ATD::Pixel &p10 = src[srcY1 * srcSize.x + srcX0];
+			const ATD::Pixel &p11 = src[srcY1 * srcSize.x + srcX1];
+
+			dst[dstY * dstSize.x + dstX] = ATD::Pixel(
+					_average(p00.r, p01.r, p10.r, p11.r), 
+					_average(p00.g, p01.g, p10.g, p11.g), 
+					_average(p00.b, p01.b, p10.b, p11.b), 
+					_average(p00.a, p01.a, p10.a, p11.a));
+		}
+	}
+
+	return result;
+}
+
+/* Anisotropy, supported by the driver, 0.f if not queried yet. */
+static float _maxAnisotropy = 0.f;
+
+/* Ring of pixel buffers, used by Texture::updateAsync(). Three is enough 
+ * for the driver to finish a transfer before its buffer comes again. */
+static const size_t _PIXEL_BUFFERS_NUM = 3;
+
+static ATD::RectL _updateRegion(const ATD::RectL &region, 
+		const ATD::Vector2S &imageSize, 
+		const ATD::Vector2S &textureSize)
+{
+	return region.clamped(
+			ATD::RectL(static_cast<ATD::Vector2L>(imageSize))).clamped(
+			ATD::RectL(static_cast<ATD::Vector2L>(textureSize)));
+}
+
+/* Textures are attached to the scratch framebuffers of the context (see 
+ * Gl::State::scratchFramebuffer()). */
+static ATD::Gl::Uint _attachForReading(const ATD::Texture &texture)
+{
+	ATD::Gl::Uint prevFbId = 
+		ATD::gl.state.framebuffer(ATD::Gl::READ_FRAMEBUFFER);
+	ATD::gl.state.bindFramebuffer(ATD::Gl::READ_FRAMEBUFFER, 
+			ATD::gl.state.scratchFramebuffer(ATD::Gl::READ_FRAMEBUFFER));
+
+	/* Attach the texture being read as color attachment #0. */
+	ATD::gl.framebufferTexture2D(ATD::Gl::READ_FRAMEBUFFER, 
+			ATD::Gl::COLOR_ATTACHMENT0, ATD::Gl::TEXTURE_2D, 
+			texture.glId(), 0);
+
+	return prevFbId;
+}
+
+static void _detachFromReading(ATD::Gl::Uint prevFbId)
+{
+	/* Detached, so that the texture can be freed on deletion. */
+	ATD::gl.framebufferTexture2D(ATD::Gl::READ_FRAMEBUFFER, 
+			ATD::Gl::COLOR_ATTACHMENT0, ATD::Gl::TEXTURE_2D, 0, 0);
+
+	ATD::gl.state.bindFramebuffer(ATD::Gl::READ_FRAMEBUFFER, prevFbId);
+}
+
+/* Attach (or detach, if textureId is 0) texture to the scratch framebuffer, 
+ * bound to target. Depth-only framebuffer shall neither read nor draw 
+ * color, otherwise it is incomplete. */
+static void _attachForCopying(ATD::Gl::Enum target, 
+		const ATD::Texture::Data &data, 
+		ATD::Gl::Uint textureId)
+{
+	if (data == ATD::Texture::DEPTH) {
+		ATD::gl.framebufferTexture2D(target, 
+				ATD::Gl::DEPTH_ATTACHMENT, ATD::Gl::TEXTURE_2D, 
+				textureId, 0);
+
+		ATD::Gl::Enum colorBuffer = textureId ? 
+			ATD::Gl::NONE : 
+			ATD::Gl::COLOR_ATTACHMENT0;
+		if (target == ATD::Gl::READ_FRAMEBUFFER) {
+			ATD::gl.readBuffer(colorBuffer);
+		} else {
+			ATD::gl.drawBuffer(colorBuffer);
+		}
+	} else {
+		ATD::gl.framebufferTexture2D(target, 
+				ATD::Gl::COLOR_ATTACHMENT0, ATD::Gl::TEXTURE_2D, 
+				textureId, 0);
+	}
+}
+
 
 /* ATD::Texture::Usage: */
 
@@ -70,19 +213,15 @@ ATD::Texture::Usage::Usage(const ATD::Texture &texture,
 	, m_type(_TEX_TYPES.at(texture.type()))
 	, m_activated(false)
 {
-	gl.getIntegerv(Gl::ACTIVE_TEXTURE, 
-			reinterpret_cast<Gl::Int *>(&m_prevUnit));
+	m_prevUnit = gl.state.activeTextureUnit();
 
 	/* gl.activeTexture(m_currUnit); */
-	gl.activeTexture(_TEX_UNITS.at(unit));
+	gl.state.activeTexture(_TEX_UNITS.at(unit));
 
-	gl.getIntegerv((m_type == Gl::TEXTURE_2D ? 
-				Gl::TEXTURE_BINDING_2D : 
-				Gl::TEXTURE_BINDING_CUBE_MAP), 
-			reinterpret_cast<Gl::Int *>(&m_prevTexture));
+	m_prevTexture = gl.state.texture(m_type);
 
 	if (m_prevTexture != texture.glId()) {
-		gl.bindTexture(m_type, texture.glId());
+		gl.state.bindTexture(m_type, texture.glId());
 		m_activated = true;
 		//IPRINTF("", "texture %u bound", texture.glId());
 	}
@@ -95,12 +234,106 @@ ATD::Texture::Usage::~Usage()
 	if (m_activated) {
 		/* gl.activeTexture(m_currUnit); */
 
-		gl.bindTexture(m_type, m_prevTexture);
+		gl.state.bindTexture(m_type, m_prevTexture);
 		//IPRINTF("", "texture unbound");
 
 		/* gl.activeTexture(ATD::Gl::TEXTURE0); */
 	}
-	gl.activeTexture(m_prevUnit);
+	gl.state.activeTexture(m_prevUnit);
+}
+
+
+/* ATD::Texture::Readback: */
+
+ATD::Texture::Readback::Readback(size_t buffersNum)
+	: m_slots(buffersNum ? buffersNum : 1)
+	, m_head(0)
+	, m_pendingNum(0)
+{
+	for (auto &slot : m_slots) {
+		gl.genBuffers(1, &slot.buffer);
+		slot.fence = nullptr;
+	}
+}
+
+ATD::Texture::Readback::~Readback()
+{
+	for (auto &slot : m_slots) {
+		if (slot.fence) {
+			gl.deleteSync(slot.fence);
+		}
+		gl.state.deleteBuffers(1, &slot.buffer);
+	}
+}
+
+bool ATD::Texture::Readback::request(const ATD::Texture &texture)
+{
+	if (m_pendingNum == m_slots.size()) {
+		return false;
+	}
+
+	Slot &slot = m_slots[(m_head + m_pendingNum) % m_slots.size()];
+	slot.size = texture.size();
+
+	Gl::Uint prevBuffer = gl.state.buffer(Gl::PIXEL_PACK_BUFFER);
+	gl.state.bindBuffer(Gl::PIXEL_PACK_BUFFER, slot.buffer);
+	gl.bufferData(Gl::PIXEL_PACK_BUFFER, 
+			sizeof(Pixel) * slot.size.x * slot.size.y, nullptr, 
+			Gl::STREAM_READ);
+
+	Gl::Uint prevFbId = _attachForReading(texture);
+
+	/* Returns at once: the pixels go to the bound pixel buffer. */
+	gl.readPixels(0, 0, slot.size.x, slot.size.y, 
+			Gl::RGBA, Gl::UNSIGNED_BYTE, 
+			reinterpret_cast<Gl::Void *>(0)); /* Buffer offset. */
+
+	_detachFromReading(prevFbId);
+	gl.state.bindBuffer(Gl::PIXEL_PACK_BUFFER, prevBuffer);
+
+	slot.fence = gl.fenceSync(Gl::SYNC_GPU_COMMANDS_COMPLETE, 0);
+	m_pendingNum++;
+	return true;
+}
+
+ATD::Image::Ptr ATD::Texture::Readback::poll()
+{
+	if (!m_pendingNum) {
+		return nullptr;
+	}
+
+	Slot &slot = m_slots[m_head];
+
+	/* Zero timeout: only check the fence. */
+	Gl::Enum status = gl.clientWaitSync(slot.fence, 
+			Gl::SYNC_FLUSH_COMMANDS_BIT, 0);
+	if (status == Gl::TIMEOUT_EXPIRED) {
+		return nullptr;
+	}
+	/* On WAIT_FAILED mapping will synchronize anyway. */
+
+	gl.deleteSync(slot.fence);
+	slot.fence = nullptr;
+
+	Image::Ptr imagePtr(new Image(slot.size));
+
+	Gl::Uint prevBuffer = gl.state.buffer(Gl::PIXEL_PACK_BUFFER);
+	gl.state.bindBuffer(Gl::PIXEL_PACK_BUFFER, slot.buffer);
+
+	const void *mapped = gl.mapBuffer(Gl::PIXEL_PACK_BUFFER, Gl::READ_ONLY);
+	if (mapped) {
+		::memcpy(reinterpret_cast<void *>(imagePtr->data()), mapped, 
+				sizeof(Pixel) * slot.size.x * slot.size.y);
+		gl.unmapBuffer(Gl::PIXEL_PACK_BUFFER);
+	} else {
+		EPRINTF("", "failed to map pixel buffer %u", slot.buffer);
+	}
+
+	gl.state.bindBuffer(Gl::PIXEL_PACK_BUFFER, prevBuffer);
+
+	m_head = (m_head + 1) % m_slots.size();
+	m_pendingNum--;
+	return imagePtr;
 }
 
 
@@ -113,6 +346,11 @@ ATD::Texture::Texture(const ATD::Image &image,
 	, m_data(data)
 	, m_type(type)
 	, m_size(image.size())
+	, m_minFilter(NEAREST)
+	, m_magFilter(NEAREST)
+	, m_hasMipmaps(false)
+	, m_pixelBuffers()
+	, m_pixelBufferIndex(0)
 {
 	gl.genTextures(1, &m_texture);
 
@@ -133,10 +371,10 @@ ATD::Texture::Texture(const ATD::Image &image,
 			image.data()); /* Ah, finally! */
 
 	/* Set filters */
-	gl.texParameterf(_TEX_TYPES.at(m_type), Gl::TEXTURE_MIN_FILTER, 
-			Gl::NEAREST);
-	gl.texParameterf(_TEX_TYPES.at(m_type), Gl::TEXTURE_MAG_FILTER, 
-			Gl::NEAREST);
+	gl.texParameteri(_TEX_TYPES.at(m_type), Gl::TEXTURE_MIN_FILTER, 
+			_glMinFilter(m_minFilter, m_hasMipmaps));
+	gl.texParameteri(_TEX_TYPES.at(m_type), Gl::TEXTURE_MAG_FILTER, 
+			_glMagFilter(m_magFilter));
 }
 
 ATD::Texture::Texture(const ATD::Vector2S &size, 
@@ -146,56 +384,331 @@ ATD::Texture::Texture(const ATD::Vector2S &size,
 	: Texture(Image(size, color), data, type)
 {}
 
-/* TODO: How to create a decent copy constructor?
- * https://stackoverflow.com/questions/23981016/best-method-to-copy-texture-to-texture
- * The discussion here concludes, that the fastest way to copy a texture is to 
- * draw it to a FrameBuffer and then take texture from it.
- *
- * Will it be fast if I create FrameBuffer every time, when copying occurs?
- *
- * If I have a single cached FrameBuffer, then, I'll need a mutex. 
- * Taking mutex may take a while. Can this method be fast?
- * */
+ATD::Texture::Texture(const ATD::Texture &other)
+	: m_texture(0)
+	, m_data(other.m_data)
+	, m_type(other.m_type)
+	, m_size(other.m_size)
+	, m_minFilter(other.m_minFilter)
+	, m_magFilter(other.m_magFilter)
+	, m_hasMipmaps(false)
+	, m_pixelBuffers()
+	, m_pixelBufferIndex(0)
+{
+	gl.genTextures(1, &m_texture);
+
+	{
+		Usage use(*this);
+
+		/* Storage only, the contents are copied below. */
+		gl.texImage2D(_TEX_TYPES.at(m_type), 
+				0, 
+				_DATA_TYPES.at(m_data).internal, 
+				static_cast<Gl::Sizei>(m_size.x), 
+				static_cast<Gl::Sizei>(m_size.y), 
+				0, 
+				_DATA_TYPES.at(m_data).format, 
+				_DATA_TYPES.at(m_data).type, 
+				nullptr);
+
+		gl.texParameteri(_TEX_TYPES.at(m_type), Gl::TEXTURE_MIN_FILTER, 
+				_glMinFilter(m_minFilter, m_hasMipmaps));
+		gl.texParameteri(_TEX_TYPES.at(m_type), Gl::TEXTURE_MAG_FILTER, 
+				_glMagFilter(m_magFilter));
+	}
+
+	copy(other, RectL(static_cast<Vector2L>(m_size)), *this, Vector2L());
+
+	if (other.m_hasMipmaps) {
+		generateMipmaps();
+	}
+}
 
 ATD::Texture::~Texture()
 {
-	gl.deleteTextures(1, &m_texture);
+	if (m_pixelBuffers.size()) {
+		gl.state.deleteBuffers(static_cast<Gl::Sizei>(m_pixelBuffers.size()), 
+				m_pixelBuffers.data());
+	}
+	gl.state.deleteTextures(1, &m_texture);
 
 	/* IPRINTF("", "deleted texture %u", 
 			static_cast<unsigned>(m_texture)); // DEBUG */
 }
 
+void ATD::Texture::setFilter(const ATD::Texture::Filter &minFilter, 
+		const ATD::Texture::Filter &magFilter)
+{
+	m_minFilter = minFilter;
+	m_magFilter = magFilter;
+
+	Usage use(*this);
+	gl.texParameteri(_TEX_TYPES.at(m_type), Gl::TEXTURE_MIN_FILTER, 
+			_glMinFilter(m_minFilter, m_hasMipmaps));
+	gl.texParameteri(_TEX_TYPES.at(m_type), Gl::TEXTURE_MAG_FILTER, 
+			_glMagFilter(m_magFilter));
+}
+
+void ATD::Texture::setWrap(const ATD::Texture::Wrap &wrapS, 
+		const ATD::Texture::Wrap &wrapT)
+{
+	Usage use(*this);
+	gl.texParameteri(_TEX_TYPES.at(m_type), Gl::TEXTURE_WRAP_S, 
+			_WRAPS.at(wrapS));
+	gl.texParameteri(_TEX_TYPES.at(m_type), Gl::TEXTURE_WRAP_T, 
+			_WRAPS.at(wrapT));
+}
+
+float ATD::Texture::setAnisotropy(float anisotropy)
+{
+	if (_maxAnisotropy == 0.f) {
+		/* Unsupported enum leaves the value untouched and sets an error, 
+		 * which is taken here, so that it does not confuse others. */
+		Gl::Float maxAnisotropy = 1.f;
+		gl.getFloatv(Gl::MAX_TEXTURE_MAX_ANISOTROPY, &maxAnisotropy);
+		gl.getError();
+		_maxAnisotropy = maxAnisotropy > 1.f ? maxAnisotropy : 1.f;
+	}
+
+	if (_maxAnisotropy == 1.f) {
+		return 1.f;
+	}
+
+	float applied = clamp<float>(anisotropy, 1.f, _maxAnisotropy);
+
+	Usage use(*this);
+	gl.texParameterf(_TEX_TYPES.at(m_type), Gl::TEXTURE_MAX_ANISOTROPY, 
+			applied);
+	return applied;
+}
+
+void ATD::Texture::generateMipmaps()
+{
+	Usage use(*this);
+	gl.generateMipmap(_TEX_TYPES.at(m_type));
+
+	m_hasMipmaps = true;
+	gl.texParameteri(_TEX_TYPES.at(m_type), Gl::TEXTURE_MIN_FILTER, 
+			_glMinFilter(m_minFilter, m_hasMipmaps));
+}
+
+void ATD::Texture::generateMipmaps(const ATD::Image &image)
+{
+	if (m_data != COLOR) {
+		throw std::runtime_error(
+				"cannot generate mipmaps for non-color texture");
+	}
+	if (image.size() != m_size) {
+		throw std::runtime_error(Aux::printf(
+					"cannot generate mipmaps for %lux%lu texture from "
+					"%lux%lu image", 
+					m_size.x, m_size.y, image.size().x, image.size().y));
+	}
+
+	Gl::Uint prevBuffer = gl.state.buffer(Gl::PIXEL_UNPACK_BUFFER);
+	gl.state.bindBuffer(Gl::PIXEL_UNPACK_BUFFER, 0);
+
+	Usage use(*this);
+
+	if (m_size.x > 1 || m_size.y > 1) {
+		/* Each level is filtered from the previous one. */
+		Image level = _boxFiltered(image);
+		Gl::Int levelIndex = 1;
+		while (1) {
+			gl.texImage2D(_TEX_TYPES.at(m_type), 
+					levelIndex, 
+					_DATA_TYPES.at(m_data).internal, 
+					static_cast<Gl::Sizei>(level.size().x), 
+					static_cast<Gl::Sizei>(level.size().y), 
+					0, 
+					_DATA_TYPES.at(m_data).format, 
+					_DATA_TYPES.at(m_data).type, 
+					level.data());
+
+			if (level.size().x == 1 && level.size().y == 1) {
+				break;
+			}
+			level = _boxFiltered(level);
+			levelIndex++;
+		}
+	}
+
+	gl.state.bindBuffer(Gl::PIXEL_UNPACK_BUFFER, prevBuffer);
+
+	m_hasMipmaps = true;
+	gl.texParameteri(_TEX_TYPES.at(m_type), Gl::TEXTURE_MIN_FILTER, 
+			_glMinFilter(m_minFilter, m_hasMipmaps));
+}
+
 ATD::Image::Ptr ATD::Texture::getImage() const
 {
 	Image::Ptr imagePtr(new Image(m_size));
 	Pixel *pixels = imagePtr->data();
 
-	/* Create a temporary FrameBuffer for this operation 
-	 * (low-level access needed only). */
-	Gl::Uint tempFbId = 0;
-	gl.genFramebuffers(1, &tempFbId);
-	if (tempFbId) {
-		/* Memorize previous FrameBuffer and bind the newly created. */
-		Gl::Uint prevFbId;
-		gl.getIntegerv(Gl::FRAMEBUFFER_BINDING, 
-				reinterpret_cast<Gl::Int *>(&prevFbId));
-		gl.bindFramebuffer(Gl::FRAMEBUFFER, tempFbId);
+	/* Pointer is treated as an offset, while pixel buffer is bound. */
+	Gl::Uint prevBuffer = gl.state.buffer(Gl::PIXEL_PACK_BUFFER);
+	gl.state.bindBuffer(Gl::PIXEL_PACK_BUFFER, 0);
 
-		/* Attach the texture being read as color attachment #0. */
-		gl.framebufferTexture2D(Gl::FRAMEBUFFER, Gl::COLOR_ATTACHMENT0, 
-				Gl::TEXTURE_2D, m_texture, 0);
+	Gl::Uint prevFbId = _attachForReading(*this);
 
-		/* Read pixels from FrameBuffer. */
-		gl.readPixels(0, 0, m_size.x, m_size.y, /* Rectangle to read. */
-				Gl::RGBA, Gl::UNSIGNED_BYTE, /* Format & type. */
-				reinterpret_cast<Gl::Void *>(pixels)); /* Target ptr. */
+	/* Read pixels from FrameBuffer. */
+	gl.readPixels(0, 0, m_size.x, m_size.y, /* Rectangle to read. */
+			Gl::RGBA, Gl::UNSIGNED_BYTE, /* Format & type. */
+			reinterpret_cast<Gl::Void *>(pixels)); /* Target ptr. */
 
-		/* Restore the previous FrameBuffer and destroy the temporary one. */
-		gl.bindFramebuffer(Gl::FRAMEBUFFER, prevFbId);
-		gl.deleteFramebuffers(1, &tempFbId);
-	}
+	_detachFromReading(prevFbId);
+	gl.state.bindBuffer(Gl::PIXEL_PACK_BUFFER, prevBuffer);
 
 	return imagePtr;
 }
 
+void ATD::Texture::update(const ATD::Image &image, 
+		const ATD::RectL &region)
+{
+	RectL updRegion = _updateRegion(region, image.size(), m_size);
+	if (!updRegion.w || !updRegion.h) {
+		return;
+	}
+
+	/* Pointer is treated as an offset, while pixel buffer is bound. */
+	Gl::Uint prevBuffer = gl.state.buffer(Gl::PIXEL_UNPACK_BUFFER);
+	gl.state.bindBuffer(Gl::PIXEL_UNPACK_BUFFER, 0);
+
+	Usage use(*this);
+
+	/* Region rows are picked right from the image, without a copy. */
+	gl.pixelStorei(Gl::UNPACK_ROW_LENGTH, 
+			static_cast<Gl::Int>(image.size().x));
+	gl.texSubImage2D(_TEX_TYPES.at(m_type), 
+			0, /* Level of detail */
+			static_cast<Gl::Int>(updRegion.x), 
+			static_cast<Gl::Int>(updRegion.y), 
+			static_cast<Gl::Sizei>(updRegion.w), 
+			static_cast<Gl::Sizei>(updRegion.h), 
+			_DATA_TYPES.at(m_data).format, 
+			_DATA_TYPES.at(m_data).type, 
+			image.data() + updRegion.y * image.size().x + updRegion.x);
+	gl.pixelStorei(Gl::UNPACK_ROW_LENGTH, 0);
+
+	gl.state.bindBuffer(Gl::PIXEL_UNPACK_BUFFER, prevBuffer);
+}
+
+void ATD::Texture::updateAsync(const ATD::Image &image, 
+		const ATD::RectL &region)
+{
+	RectL updRegion = _updateRegion(region, image.size(), m_size);
+	if (!updRegion.w || !updRegion.h) {
+		return;
+	}
+
+	if (!m_pixelBuffers.size()) {
+		m_pixelBuffers.resize(_PIXEL_BUFFERS_NUM, 0);
+		gl.genBuffers(static_cast<Gl::Sizei>(m_pixelBuffers.size()), 
+				m_pixelBuffers.data());
+	}
+	Gl::Uint pixelBuffer = m_pixelBuffers[m_pixelBufferIndex];
+	m_pixelBufferIndex = (m_pixelBufferIndex + 1) % m_pixelBuffers.size();
+
+	const size_t rowSize = sizeof(Pixel) * static_cast<size_t>(updRegion.w);
+	const size_t bufferSize = rowSize * static_cast<size_t>(updRegion.h);
+
+	Gl::Uint prevBuffer = gl.state.buffer(Gl::PIXEL_UNPACK_BUFFER);
+	gl.state.bindBuffer(Gl::PIXEL_UNPACK_BUFFER, pixelBuffer);
+
+	/* Orphan the previous storage: if the driver still reads from it, 
+	 * it allocates a new one instead of blocking on mapping. */
+	gl.bufferData(Gl::PIXEL_UNPACK_BUFFER, bufferSize, nullptr, 
+			Gl::STREAM_DRAW);
+
+	uint8_t *mapped = static_cast<uint8_t *>(
+			gl.mapBuffer(Gl::PIXEL_UNPACK_BUFFER, Gl::WRITE_ONLY));
+	if (mapped) {
+		const Pixel *srcRow = 
+			image.data() + updRegion.y * image.size().x + updRegion.x;
+		for (long row = 0; row < updRegion.h; row++) {
+			::memcpy(mapped + rowSize * row, srcRow, rowSize);
+			srcRow += image.size().x;
+		}
+		gl.unmapBuffer(Gl::PIXEL_UNPACK_BUFFER);
+
+		Usage use(*this);
+
+		/* Returns at once: the transfer is done by the driver. */
+		gl.texSubImage2D(_TEX_TYPES.at(m_type), 
+				0, /* Level of detail */
+				static_cast<Gl::Int>(updRegion.x), 
+				static_cast<Gl::Int>(updRegion.y), 
+				static_cast<Gl::Sizei>(updRegion.w), 
+				static_cast<Gl::Sizei>(updRegion.h), 
+				_DATA_TYPES.at(m_data).format, 
+				_DATA_TYPES.at(m_data).type, 
+				reinterpret_cast<const void *>(0)); /* Buffer offset. */
+	} else {
+		EPRINTF("", "failed to map pixel buffer %u", pixelBuffer);
+	}
+
+	gl.state.bindBuffer(Gl::PIXEL_UNPACK_BUFFER, prevBuffer);
+}
+
+void ATD::Texture::copy(const ATD::Texture &src, 
+		const ATD::RectL &srcRect, 
+		ATD::Texture &dst, 
+		const ATD::Vector2L &dstPos)
+{
+	if (src.m_type != TEX_2D || dst.m_type != TEX_2D) {
+		throw std::runtime_error(Aux::printf(
+					"cannot copy texture %u to %u: not 2D", 
+					src.m_texture, dst.m_texture));
+	}
+	if (src.m_data != dst.m_data) {
+		throw std::runtime_error(Aux::printf(
+					"cannot copy texture %u to %u: different data", 
+					src.m_texture, dst.m_texture));
+	}
+
+	/* Clip by the source bounds, then by the destination ones. */
+	RectL srcClipped = srcRect.clamped(
+			RectL(static_cast<Vector2L>(src.m_size)));
+	RectL dstRect(srcClipped.pos() - srcRect.pos() + dstPos, 
+			srcClipped.size());
+	RectL dstClipped = dstRect.clamped(
+			RectL(static_cast<Vector2L>(dst.m_size)));
+	if (dstClipped.w <= 0 || dstClipped.h <= 0) {
+		return;
+	}
+	srcClipped = RectL(srcClipped.pos() + dstClipped.pos() - dstRect.pos(), 
+			dstClipped.size());
+
+	Gl::Uint prevReadFbId = gl.state.framebuffer(Gl::READ_FRAMEBUFFER);
+	Gl::Uint prevDrawFbId = gl.state.framebuffer(Gl::DRAW_FRAMEBUFFER);
+	gl.state.bindFramebuffer(Gl::READ_FRAMEBUFFER, 
+			gl.state.scratchFramebuffer(Gl::READ_FRAMEBUFFER));
+	gl.state.bindFramebuffer(Gl::DRAW_FRAMEBUFFER, 
+			gl.state.scratchFramebuffer(Gl::DRAW_FRAMEBUFFER));
+
+	_attachForCopying(Gl::READ_FRAMEBUFFER, src.m_data, src.m_texture);
+	_attachForCopying(Gl::DRAW_FRAMEBUFFER, dst.m_data, dst.m_texture);
+
+	/* Same size on both sides, so no filtering actually happens (and 
+	 * depth can only be blitted with NEAREST anyway). */
+	gl.blitFramebuffer(
+			static_cast<Gl::Int>(srcClipped.x), 
+			static_cast<Gl::Int>(srcClipped.y), 
+			static_cast<Gl::Int>(srcClipped.x + srcClipped.w), 
+			static_cast<Gl::Int>(srcClipped.y + srcClipped.h), 
+			static_cast<Gl::Int>(dstClipped.x), 
+			static_cast<Gl::Int>(dstClipped.y), 
+			static_cast<Gl::Int>(dstClipped.x + dstClipped.w), 
+			static_cast<Gl::Int>(dstClipped.y + dstClipped.h), 
+			src.m_data == DEPTH ? Gl::DEPTH_BUFFER_BIT : Gl::COLOR_BUFFER_BIT, 
+			Gl::NEAREST);
+
+	/* Detached, so that the textures can be freed on deletion. */
+	_attachForCopying(Gl::READ_FRAMEBUFFER, src.m_data, 0);
+	_attachForCopying(Gl::DRAW_FRAMEBUFFER, dst.m_data, 0);
+
+	gl.state.bindFramebuffer(Gl::READ_FRAMEBUFFER, prevReadFbId);
+	gl.state.bindFramebuffer(Gl::DRAW_FRAMEBUFFER, prevDrawFbId);
+}
+
 
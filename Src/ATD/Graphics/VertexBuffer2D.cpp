@@ -11,6 +11,9 @@
 #include <ATD/Core/Debug.hpp>
 #include <ATD/Core/Printf.hpp>
 
+#include <stdexcept>
+#include <tuple>
+
 
 /* ATD::VertexBuffer2D::Usage: */
 
@@ -18,18 +21,131 @@ ATD::VertexBuffer2D::Usage::Usage(const ATD::VertexBuffer2D &buffer)
 	: m_prevBuffer(0)
 	, m_activated(false)
 {
-	gl.getIntegerv(Gl::ARRAY_BUFFER_BINDING, 
-			reinterpret_cast<Gl::Int *>(&m_prevBuffer));
+	m_prevBuffer = gl.state.buffer(Gl::ARRAY_BUFFER);
 
 	if (m_prevBuffer != buffer.glId()) {
-		gl.bindBuffer(Gl::ARRAY_BUFFER, buffer.glId());
+		gl.state.bindBuffer(Gl::ARRAY_BUFFER, buffer.glId());
 		m_activated = true;
 	}
 }
 
 ATD::VertexBuffer2D::Usage::~Usage()
 {
-	if (m_activated) { gl.bindBuffer(Gl::ARRAY_BUFFER, m_prevBuffer); }
+	if (m_activated) {
+		gl.state.bindBuffer(Gl::ARRAY_BUFFER, m_prevBuffer);
+	}
+}
+
+
+/* ATD::VertexBuffer2D::Builder: */
+
+ATD::VertexBuffer2D::Builder::Builder(const ATD::Vector2S &textureSize, 
+		size_t capacity)
+	: m_textureSize(textureSize)
+	, m_glVertices()
+{
+	m_glVertices.reserve(capacity);
+}
+
+void ATD::VertexBuffer2D::Builder::reserve(size_t capacity)
+{
+	m_glVertices.reserve(capacity);
+}
+
+void ATD::VertexBuffer2D::Builder::clear()
+{
+	m_glVertices.clear();
+}
+
+void ATD::VertexBuffer2D::Builder::truncate(size_t size)
+{
+	if (size < m_glVertices.size()) {
+		m_glVertices.erase(m_glVertices.begin() + size, m_glVertices.end());
+	}
+}
+
+void ATD::VertexBuffer2D::Builder::addTriangle(
+		const ATD::Vertex2D::GlVertex &v0, 
+		const ATD::Vertex2D::GlVertex &v1, 
+		const ATD::Vertex2D::GlVertex &v2)
+{
+	m_glVertices.push_back(v0);
+	m_glVertices.push_back(v1);
+	m_glVertices.push_back(v2);
+}
+
+void ATD::VertexBuffer2D::Builder::addQuad(
+		const ATD::Vertex2D::GlVertex &topLeft, 
+		const ATD::Vertex2D::GlVertex &topRight, 
+		const ATD::Vertex2D::GlVertex &bottomRight, 
+		const ATD::Vertex2D::GlVertex &bottomLeft)
+{
+	addTriangle(bottomLeft, topLeft, bottomRight);
+	addTriangle(topRight, bottomRight, topLeft);
+}
+
+void ATD::VertexBuffer2D::Builder::append(
+		const std::vector<ATD::Vertex2D::GlVertex> &glVertices)
+{
+	m_glVertices.insert(m_glVertices.end(), 
+			glVertices.begin(), glVertices.end());
+}
+
+void ATD::VertexBuffer2D::Builder::addRect(const ATD::Vector2F &position, 
+		const ATD::RectL &textureBounds, 
+		const ATD::Pixel &color)
+{
+	Vector2F size(static_cast<float>(textureBounds.w), 
+			static_cast<float>(textureBounds.h));
+	Vector4F glColor = color.glColor();
+
+	addQuad(
+			Vertex2D::GlVertex(position, 
+				glTexCoords(Vector2L(textureBounds.x, textureBounds.y)), 
+				glColor), 
+			Vertex2D::GlVertex(position + Vector2F(size.x, 0.f), 
+				glTexCoords(Vector2L(textureBounds.x + textureBounds.w, 
+						textureBounds.y)), 
+				glColor), 
+			Vertex2D::GlVertex(position + size, 
+				glTexCoords(Vector2L(textureBounds.x + textureBounds.w, 
+						textureBounds.y + textureBounds.h)), 
+				glColor), 
+			Vertex2D::GlVertex(position + Vector2F(0.f, size.y), 
+				glTexCoords(Vector2L(textureBounds.x, 
+						textureBounds.y + textureBounds.h)), 
+				glColor));
+}
+
+ATD::Vector2F ATD::VertexBuffer2D::Builder::glTexCoords(
+		const ATD::Vector2L &texCoords) const
+{
+	return Vector2F(
+			(m_textureSize.x > 0 ? 
+				clamp<float>(static_cast<float>(texCoords.x) / 
+					static_cast<float>(m_textureSize.x), 0.f, 1.f) : 
+				0.f), 
+			(m_textureSize.y > 0 ? 
+				clamp<float>(static_cast<float>(texCoords.y) / 
+					static_cast<float>(m_textureSize.y), 0.f, 1.f) : 
+				0.f));
+}
+
+
+/* ATD::VertexBuffer2D::AttrIndices: */
+
+bool ATD::VertexBuffer2D::AttrIndices::operator<(
+		const ATD::VertexBuffer2D::AttrIndices &other) const
+{
+	return std::tie(positionIndex, texCoordsIndex, colorIndex, 
+			instanceTransformIndex, instanceColorIndex, 
+			texCoordsAreRequired, colorIsRequired, 
+			instanceTransformIsRequired, instanceColorIsRequired) < 
+		std::tie(other.positionIndex, other.texCoordsIndex, 
+				other.colorIndex, other.instanceTransformIndex, 
+				other.instanceColorIndex, other.texCoordsAreRequired, 
+				other.colorIsRequired, other.instanceTransformIsRequired, 
+				other.instanceColorIsRequired);
 }
 
 
@@ -60,38 +176,14 @@ static const std::vector<ATD::Vertex2D::GlVertex> _DFT_GL_VERTICES = {
 	_DFT_GL_VERTICES_VALS[0]
 };
 
-static std::vector<ATD::Vertex2D> _dftVerticesFromRect(
+static ATD::VertexBuffer2D::Builder _dftBuilderFromRect(
 		const ATD::RectL &textureBounds, 
+		const ATD::Vector2S &textureSize, 
 		const ATD::Pixel &color)
 {
-	const std::vector<ATD::Vertex2D> verticesVals = {
-		ATD::Vertex2D(ATD::Vector2D(0., 0.), 
-				textureBounds.pos(), 
-				color), 
-		ATD::Vertex2D(
-				ATD::Vector2D(static_cast<double>(textureBounds.size().x), 0.), 
-				textureBounds.pos() + ATD::Vector2L(textureBounds.size().x, 0), 
-				color), 
-		ATD::Vertex2D(static_cast<ATD::Vector2D>(textureBounds.size()), 
-				textureBounds.pos() + textureBounds.size(), 
-				color), 
-		ATD::Vertex2D(
-				ATD::Vector2D(0., static_cast<double>(textureBounds.size().y)), 
-				textureBounds.pos() + ATD::Vector2L(0, textureBounds.size().y), 
-				color)
-	};
-
-	const std::vector<ATD::Vertex2D> vertices = {
-		verticesVals[3], 
-		verticesVals[0], 
-		verticesVals[2], 
-
-		verticesVals[1], 
-		verticesVals[2], 
-		verticesVals[0]
-	};
-
-	return vertices;
+	ATD::VertexBuffer2D::Builder builder(textureSize, 6);
+	builder.addRect(ATD::Vector2F(), textureBounds, color);
+	return builder;
 }
 
 
@@ -104,20 +196,25 @@ ATD::VertexBuffer2D::VertexBuffer2D()
 ATD::VertexBuffer2D::VertexBuffer2D(const ATD::RectL &textureBounds, 
 		const ATD::Vector2S &textureSize, 
 		const ATD::Pixel &color)
-	: VertexBuffer2D(_dftVerticesFromRect(textureBounds, color), textureSize)
+	: VertexBuffer2D(_dftBuilderFromRect(textureBounds, textureSize, color))
 {}
 
 ATD::VertexBuffer2D::VertexBuffer2D(
 		const std::vector<ATD::Vertex2D> &vertices, 
 		const ATD::Vector2S &textureSize, 
-		const ATD::VertexBuffer2D::Primitive &primitive)
+		const ATD::VertexBuffer2D::Primitive &primitive, 
+		const ATD::VertexLayout &layout)
 	: m_bufferId(0)
 	, m_size(vertices.size())
+	, m_capacity(vertices.size())
 	, m_primitive(primitive)
+	, m_indexBufferPtr()
+	, m_layout(layout)
 {
 	/* std::string verticesStr = ""; // DEBUG */
 
 	std::vector<Vertex2D::GlVertex> glVertices;
+	glVertices.reserve(vertices.size());
 	for (auto &vertex : vertices) {
 		Vertex2D::GlVertex glVertex = vertex.glVertex(textureSize);
 		glVertices.push_back(glVertex);
@@ -130,32 +227,180 @@ ATD::VertexBuffer2D::VertexBuffer2D(
 	/* IPRINTF("", "GL vertices:%s", verticesStr.c_str()); // DEBUG */
 
 	gl.genBuffers(1, &m_bufferId);
-	Usage use(*this);
-	gl.bufferData(Gl::ARRAY_BUFFER, sizeof(Vertex2D::GlVertex) * m_size,
-			glVertices.data(), Gl::STATIC_DRAW);
+	upload(glVertices);
 }
 
 ATD::VertexBuffer2D::VertexBuffer2D(
 		const std::vector<ATD::Vertex2D::GlVertex> &glVertices, 
-		const ATD::VertexBuffer2D::Primitive &primitive)
+		const ATD::VertexBuffer2D::Primitive &primitive, 
+		const ATD::VertexLayout &layout)
 	: m_bufferId(0)
 	, m_size(glVertices.size())
+	, m_capacity(glVertices.size())
 	, m_primitive(primitive)
+	, m_indexBufferPtr()
+	, m_layout(layout)
 {
 	gl.genBuffers(1, &m_bufferId);
-	Usage use(*this);
-	gl.bufferData(Gl::ARRAY_BUFFER, sizeof(Vertex2D::GlVertex) * m_size,
-			glVertices.data(), Gl::STATIC_DRAW);
+	upload(glVertices);
+}
+
+ATD::VertexBuffer2D::VertexBuffer2D(
+		const ATD::VertexBuffer2D::Builder &builder, 
+		const ATD::VertexBuffer2D::Primitive &primitive, 
+		const ATD::VertexLayout &layout)
+	: VertexBuffer2D(builder.glVertices(), primitive, layout)
+{}
+
+ATD::VertexBuffer2D::VertexBuffer2D(
+		const std::vector<ATD::Vertex2D::GlVertex> &glVertices, 
+		const ATD::IndexBuffer::CPtr &indexBufferPtr, 
+		const ATD::VertexBuffer2D::Primitive &primitive, 
+		const ATD::VertexLayout &layout)
+	: VertexBuffer2D(glVertices, primitive, layout)
+{
+	m_indexBufferPtr = indexBufferPtr;
 }
 
 ATD::VertexBuffer2D::~VertexBuffer2D()
 {
-	gl.deleteBuffers(1, &m_bufferId);
+	for (auto &vertexArrayPair : m_vertexArrayIds) {
+		gl.state.deleteVertexArrays(1, &vertexArrayPair.second);
+	}
+	gl.state.deleteBuffers(1, &m_bufferId);
+}
+
+void ATD::VertexBuffer2D::update(
+		const std::vector<ATD::Vertex2D::GlVertex> &glVertices, 
+		size_t first)
+{
+	if (m_indexBufferPtr) {
+		throw std::runtime_error("cannot update indexed vertex buffer");
+	}
+
+	size_t stride = m_layout.stride(false);
+	Usage use(*this);
+
+	if (glVertices.size() > m_capacity) {
+		m_capacity = max<size_t>(glVertices.size(), m_capacity * 2);
+		gl.bufferData(Gl::ARRAY_BUFFER, stride * m_capacity, 
+				nullptr, Gl::DYNAMIC_DRAW);
+
+		/* Storage is reallocated, nothing is kept. */
+		first = 0;
+	}
+	m_size = glVertices.size();
+
+	if (first >= m_size) {
+		return;
+	}
+
+	if (m_layout.isFloat()) {
+		gl.bufferSubData(Gl::ARRAY_BUFFER, 
+				static_cast<Gl::Intptr>(stride * first), 
+				static_cast<Gl::Sizeiptr>(stride * (m_size - first)), 
+				glVertices.data() + first);
+	} else {
+		std::vector<uint8_t> data = m_layout.packed(
+				std::vector<Vertex2D::GlVertex>(
+					glVertices.begin() + first, glVertices.end()));
+		gl.bufferSubData(Gl::ARRAY_BUFFER, 
+				static_cast<Gl::Intptr>(stride * first), 
+				static_cast<Gl::Sizeiptr>(data.size()), 
+				data.data());
+	}
+}
+
+void ATD::VertexBuffer2D::drawSelfInternal(
+		const ATD::VertexBuffer2D::AttrIndices &attrIndices) const
+{
+	Gl::Enum primitive = 
+		m_primitive == TRIANGLES ? Gl::TRIANGLES : 
+		m_primitive == TRIANGLE_STRIP ? Gl::TRIANGLE_STRIP : 
+		Gl::TRIANGLE_FAN;
+
+	/* Attributes (and the index buffer) are bound to the vertex array. */
+	gl.state.bindVertexArray(vertexArrayId(attrIndices));
+
+	if (m_indexBufferPtr) {
+		gl.drawElements(primitive, 
+				static_cast<Gl::Sizei>(m_indexBufferPtr->size()), 
+				m_indexBufferPtr->glType(), 
+				reinterpret_cast<const void *>(0));
+	} else {
+		gl.drawArrays(primitive, 0, static_cast<Gl::Sizei>(m_size));
+	}
+
+	gl.state.bindVertexArray(0);
 }
 
 void ATD::VertexBuffer2D::drawSelfInternal(
+		const ATD::VertexBuffer2D::AttrIndices &attrIndices, 
+		const ATD::InstanceBuffer2D &instances) const
+{
+	if (!attrIndices.instanceTransformIsRequired) {
+		throw std::runtime_error(
+				"cannot draw instances with non-instanced shader");
+	}
+
+	Gl::Enum primitive = 
+		m_primitive == TRIANGLES ? Gl::TRIANGLES : 
+		m_primitive == TRIANGLE_STRIP ? Gl::TRIANGLE_STRIP : 
+		Gl::TRIANGLE_FAN;
+
+	gl.state.bindVertexArray(vertexArrayId(attrIndices));
+
+	/* Instance attributes are set on each draw: the vertex array shall not 
+	 * keep the instance buffer after it is deleted. */
+	instances.enableAttributes(attrIndices.instanceTransformIndex, 
+			attrIndices.instanceColorIsRequired, 
+			attrIndices.instanceColorIndex);
+
+	if (m_indexBufferPtr) {
+		gl.drawElementsInstanced(primitive, 
+				static_cast<Gl::Sizei>(m_indexBufferPtr->size()), 
+				m_indexBufferPtr->glType(), 
+				reinterpret_cast<const void *>(0), 
+				static_cast<Gl::Sizei>(instances.size()));
+	} else {
+		gl.drawArraysInstanced(primitive, 0, static_cast<Gl::Sizei>(m_size), 
+				static_cast<Gl::Sizei>(instances.size()));
+	}
+
+	InstanceBuffer2D::disableAttributes(attrIndices.instanceTransformIndex, 
+			attrIndices.instanceColorIsRequired, 
+			attrIndices.instanceColorIndex);
+
+	gl.state.bindVertexArray(0);
+}
+
+void ATD::VertexBuffer2D::upload(
+		const std::vector<ATD::Vertex2D::GlVertex> &glVertices)
+{
+	Usage use(*this);
+	if (m_layout.isFloat()) {
+		gl.bufferData(Gl::ARRAY_BUFFER, 
+				sizeof(Vertex2D::GlVertex) * glVertices.size(), 
+				glVertices.data(), Gl::STATIC_DRAW);
+	} else {
+		std::vector<uint8_t> data = m_layout.packed(glVertices);
+		gl.bufferData(Gl::ARRAY_BUFFER, data.size(), 
+				data.data(), Gl::STATIC_DRAW);
+	}
+}
+
+ATD::Gl::Uint ATD::VertexBuffer2D::vertexArrayId(
 		const ATD::VertexBuffer2D::AttrIndices &attrIndices) const
 {
+	auto vertexArrayIt = m_vertexArrayIds.find(attrIndices);
+	if (vertexArrayIt != m_vertexArrayIds.end()) {
+		return vertexArrayIt->second;
+	}
+
+	Gl::Uint vertexArrayId = 0;
+	gl.genVertexArrays(1, &vertexArrayId);
+	gl.state.bindVertexArray(vertexArrayId);
+
 	gl.enableVertexAttribArray(attrIndices.positionIndex);
 	if (attrIndices.texCoordsAreRequired) {
 		gl.enableVertexAttribArray(attrIndices.texCoordsIndex);
@@ -167,50 +412,43 @@ void ATD::VertexBuffer2D::drawSelfInternal(
 	{
 		Usage useVBuffer(*this);
 
+		Gl::Sizei stride = static_cast<Gl::Sizei>(m_layout.stride(false));
+		auto attribPointer = [stride](Gl::Uint index, 
+				const VertexLayout::Attribute &attribute) {
+			gl.vertexAttribPointer(index, 
+					attribute.size, 
+					attribute.type, 
+					attribute.normalized, 
+					stride, 
+					reinterpret_cast<const void *>(attribute.offset));
+		};
+
 		/* position is set unconditionally */
-		gl.vertexAttribPointer(attrIndices.positionIndex, 
-				static_cast<Gl::Int>(sizeof(Vector2F) / sizeof(float)), 
-				Gl::FLOAT, 
-				Gl::FALSE, 
-				static_cast<Gl::Sizei>(sizeof(Vertex2D::GlVertex)), 
-				reinterpret_cast<const void *>(0));
+		attribPointer(attrIndices.positionIndex, 
+				m_layout.positionAttribute(false));
 
 		/* texCoords are set optionally */
 		if (attrIndices.texCoordsAreRequired) {
-			gl.vertexAttribPointer(attrIndices.texCoordsIndex, 
-					static_cast<Gl::Int>(sizeof(Vector2F) / sizeof(float)), 
-					Gl::FLOAT, 
-					Gl::FALSE, 
-					static_cast<Gl::Sizei>(sizeof(Vertex2D::GlVertex)), 
-					reinterpret_cast<const void *>(sizeof(Vector2F)));
+			attribPointer(attrIndices.texCoordsIndex, 
+					m_layout.texCoordsAttribute(false));
 		}
 
 		/* color is set optionally */
 		if (attrIndices.colorIsRequired) {
-			gl.vertexAttribPointer(attrIndices.colorIndex, 
-					static_cast<Gl::Int>(sizeof(Vector4F) / sizeof(float)), 
-					Gl::FLOAT, 
-					Gl::FALSE, 
-					static_cast<Gl::Sizei>(sizeof(Vertex2D::GlVertex)), 
-					reinterpret_cast<const void *>(sizeof(Vector2F) + 
-						sizeof(Vector2F)));
+			attribPointer(attrIndices.colorIndex, 
+					m_layout.colorAttribute(false));
 		}
-
-		Gl::Enum primitive = 
-			m_primitive == TRIANGLES ? Gl::TRIANGLES : 
-			m_primitive == TRIANGLE_STRIP ? Gl::TRIANGLE_STRIP : 
-			Gl::TRIANGLE_FAN;
-
-		gl.drawArrays(primitive, 0, static_cast<Gl::Sizei>(m_size));
 	}
 
-	if (attrIndices.colorIsRequired) {
-		gl.disableVertexAttribArray(attrIndices.colorIndex);
-	}
-	if (attrIndices.texCoordsAreRequired) {
-		gl.disableVertexAttribArray(attrIndices.texCoordsIndex);
+	/* Element array binding is a part of the vertex array state, so it is 
+	 * not restored while the vertex array is bound. */
+	if (m_indexBufferPtr) {
+		gl.state.bindBuffer(Gl::ELEMENT_ARRAY_BUFFER, 
+				m_indexBufferPtr->glId());
 	}
-	gl.disableVertexAttribArray(attrIndices.positionIndex);
-}
 
+	gl.state.bindVertexArray(0);
 
+	m_vertexArrayIds.insert(std::make_pair(attrIndices, vertexArrayId));
+	return vertexArrayId;
+}
@@ -12,6 +12,9 @@
 #include <ATD/Core/Printf.hpp>
 #include <ATD/Graphics/GlCheck.hpp>
 
+#include <stdexcept>
+#include <tuple>
+
 
 /* ATD::VertexBuffer3D::Usage: */
 
@@ -19,18 +22,37 @@ ATD::VertexBuffer3D::Usage::Usage(const ATD::VertexBuffer3D &buffer)
 	: m_prevBuffer(0)
 	, m_activated(false)
 {
-	gl.getIntegerv(Gl::ARRAY_BUFFER_BINDING, 
-			reinterpret_cast<Gl::Int *>(&m_prevBuffer));
+	m_prevBuffer = gl.state.buffer(Gl::ARRAY_BUFFER);
 
 	if (m_prevBuffer != buffer.glId()) {
-		gl.bindBuffer(Gl::ARRAY_BUFFER, buffer.glId());
+		gl.state.bindBuffer(Gl::ARRAY_BUFFER, buffer.glId());
 		m_activated = true;
 	}
 }
 
 ATD::VertexBuffer3D::Usage::~Usage()
 {
-	if (m_activated) { gl.bindBuffer(Gl::ARRAY_BUFFER, m_prevBuffer); }
+	if (m_activated) {
+		gl.state.bindBuffer(Gl::ARRAY_BUFFER, m_prevBuffer);
+	}
+}
+
+
+/* ATD::VertexBuffer3D::AttrIndices: */
+
+bool ATD::VertexBuffer3D::AttrIndices::operator<(
+		const ATD::VertexBuffer3D::AttrIndices &other) const
+{
+	return std::tie(positionIndex, texCoordsIndex, normalIndex, colorIndex, 
+			instanceTransformIndex, instanceColorIndex, 
+			texCoordsAreRequired, normalIsRequired, colorIsRequired, 
+			instanceTransformIsRequired, instanceColorIsRequired) < 
+		std::tie(other.positionIndex, other.texCoordsIndex, 
+				other.normalIndex, other.colorIndex, 
+				other.instanceTransformIndex, other.instanceColorIndex, 
+				other.texCoordsAreRequired, other.normalIsRequired, 
+				other.colorIsRequired, other.instanceTransformIsRequired, 
+				other.instanceColorIsRequired);
 }
 
 
@@ -120,10 +142,13 @@ ATD::VertexBuffer3D::VertexBuffer3D()
 ATD::VertexBuffer3D::VertexBuffer3D(
 		const std::vector<ATD::Vertex3D> &vertices, 
 		const ATD::Vector2S &textureSize, 
-		const ATD::VertexBuffer3D::Primitive &primitive)
+		const ATD::VertexBuffer3D::Primitive &primitive, 
+		const ATD::VertexLayout &layout)
 	: m_bufferId(0)
 	, m_size(vertices.size())
 	, m_primitive(primitive)
+	, m_indexBufferPtr()
+	, m_layout(layout)
 {
 	/* std::string verticesStr = ""; // DEBUG */
 
@@ -142,32 +167,166 @@ ATD::VertexBuffer3D::VertexBuffer3D(
 	/* IPRINTF("", "GL vertices:%s", verticesStr.c_str()); // DEBUG */
 
 	gl.genBuffers(1, &m_bufferId);
-	Usage use(*this);
-	gl.bufferData(Gl::ARRAY_BUFFER, sizeof(Vertex3D::GlVertex) * m_size, 
-			glVertices.data(), Gl::STATIC_DRAW);
+	upload(glVertices);
+}
+
+ATD::VertexBuffer3D::VertexBuffer3D(
+		const std::vector<ATD::Vertex3D> &vertices, 
+		const ATD::Vector2S &textureSize, 
+		const ATD::VertexBuffer3D::Primitive &primitive, 
+		const ATD::VertexBuffer3D::Indexing &indexing, 
+		const ATD::VertexLayout &layout)
+	: m_bufferId(0)
+	, m_size(0)
+	, m_primitive(primitive)
+	, m_indexBufferPtr()
+	, m_layout(layout)
+{
+	std::vector<Vertex3D::GlVertex> glVertices;
+	glVertices.reserve(vertices.size());
+	for (auto &vertex : vertices) {
+		glVertices.push_back(vertex.glVertex(textureSize));
+	}
+
+	std::vector<Vertex3D::GlVertex> uniqueGlVertices;
+	std::vector<uint32_t> indices = 
+		IndexBuffer::deduplicate(glVertices, uniqueGlVertices);
+
+	if (indexing == DEDUPLICATE_CACHE_OPTIMIZED && primitive == TRIANGLES) {
+		indices = IndexBuffer::cacheOptimized(indices, 
+				uniqueGlVertices.size());
+		IndexBuffer::reorderForFetch(uniqueGlVertices, indices);
+	}
+
+	m_size = uniqueGlVertices.size();
+	m_indexBufferPtr = IndexBuffer::CPtr(new IndexBuffer(indices));
+
+	gl.genBuffers(1, &m_bufferId);
+	upload(uniqueGlVertices);
 }
 
 ATD::VertexBuffer3D::VertexBuffer3D(
 		const std::vector<ATD::Vertex3D::GlVertex> &glVertices, 
-		const ATD::VertexBuffer3D::Primitive &primitive)
+		const ATD::VertexBuffer3D::Primitive &primitive, 
+		const ATD::VertexLayout &layout)
 	: m_bufferId(0)
 	, m_size(glVertices.size())
 	, m_primitive(primitive)
+	, m_indexBufferPtr()
+	, m_layout(layout)
 {
 	gl.genBuffers(1, &m_bufferId);
-	Usage use(*this);
-	gl.bufferData(Gl::ARRAY_BUFFER, sizeof(Vertex3D::GlVertex) * m_size, 
-			glVertices.data(), Gl::STATIC_DRAW);
+	upload(glVertices);
+}
+
+ATD::VertexBuffer3D::VertexBuffer3D(
+		const std::vector<ATD::Vertex3D::GlVertex> &glVertices, 
+		const ATD::IndexBuffer::CPtr &indexBufferPtr, 
+		const ATD::VertexBuffer3D::Primitive &primitive, 
+		const ATD::VertexLayout &layout)
+	: VertexBuffer3D(glVertices, primitive, layout)
+{
+	m_indexBufferPtr = indexBufferPtr;
 }
 
 ATD::VertexBuffer3D::~VertexBuffer3D()
 {
-	gl.deleteBuffers(1, &m_bufferId);
+	for (auto &vertexArrayPair : m_vertexArrayIds) {
+		gl.state.deleteVertexArrays(1, &vertexArrayPair.second);
+	}
+	gl.state.deleteBuffers(1, &m_bufferId);
 }
 
 void ATD::VertexBuffer3D::drawSelfInternal(
 		const ATD::VertexBuffer3D::AttrIndices &attrIndices) const
 {
+	Gl::Enum primitive = 
+		m_primitive == TRIANGLES ? Gl::TRIANGLES : 
+		m_primitive == TRIANGLE_STRIP ? Gl::TRIANGLE_STRIP : 
+		Gl::TRIANGLE_FAN;
+
+	/* Attributes (and the index buffer) are bound to the vertex array. */
+	gl.state.bindVertexArray(vertexArrayId(attrIndices));
+
+	if (m_indexBufferPtr) {
+		gl.drawElements(primitive, 
+				static_cast<Gl::Sizei>(m_indexBufferPtr->size()), 
+				m_indexBufferPtr->glType(), 
+				reinterpret_cast<const void *>(0));
+	} else {
+		gl.drawArrays(primitive, 0, static_cast<Gl::Sizei>(m_size));
+	}
+
+	gl.state.bindVertexArray(0);
+}
+
+void ATD::VertexBuffer3D::drawSelfInternal(
+		const ATD::VertexBuffer3D::AttrIndices &attrIndices, 
+		const ATD::InstanceBuffer3D &instances) const
+{
+	if (!attrIndices.instanceTransformIsRequired) {
+		throw std::runtime_error(
+				"cannot draw instances with non-instanced shader");
+	}
+
+	Gl::Enum primitive = 
+		m_primitive == TRIANGLES ? Gl::TRIANGLES : 
+		m_primitive == TRIANGLE_STRIP ? Gl::TRIANGLE_STRIP : 
+		Gl::TRIANGLE_FAN;
+
+	gl.state.bindVertexArray(vertexArrayId(attrIndices));
+
+	/* Instance attributes are set on each draw: the vertex array shall not 
+	 * keep the instance buffer after it is deleted. */
+	instances.enableAttributes(attrIndices.instanceTransformIndex, 
+			attrIndices.instanceColorIsRequired, 
+			attrIndices.instanceColorIndex);
+
+	if (m_indexBufferPtr) {
+		gl.drawElementsInstanced(primitive, 
+				static_cast<Gl::Sizei>(m_indexBufferPtr->size()), 
+				m_indexBufferPtr->glType(), 
+				reinterpret_cast<const void *>(0), 
+				static_cast<Gl::Sizei>(instances.size()));
+	} else {
+		gl.drawArraysInstanced(primitive, 0, static_cast<Gl::Sizei>(m_size), 
+				static_cast<Gl::Sizei>(instances.size()));
+	}
+
+	InstanceBuffer3D::disableAttributes(attrIndices.instanceTransformIndex, 
+			attrIndices.instanceColorIsRequired, 
+			attrIndices.instanceColorIndex);
+
+	gl.state.bindVertexArray(0);
+}
+
+void ATD::VertexBuffer3D::upload(
+		const std::vector<ATD::Vertex3D::GlVertex> &glVertices)
+{
+	Usage use(*this);
+	if (m_layout.isFloat()) {
+		gl.bufferData(Gl::ARRAY_BUFFER, 
+				sizeof(Vertex3D::GlVertex) * glVertices.size(), 
+				glVertices.data(), Gl::STATIC_DRAW);
+	} else {
+		std::vector<uint8_t> data = m_layout.packed(glVertices);
+		gl.bufferData(Gl::ARRAY_BUFFER, data.size(), 
+				data.data(), Gl::STATIC_DRAW);
+	}
+}
+
+ATD::Gl::Uint ATD::VertexBuffer3D::vertexArrayId(
+		const ATD::VertexBuffer3D::AttrIndices &attrIndices) const
+{
+	auto vertexArrayIt = m_vertexArrayIds.find(attrIndices);
+	if (vertexArrayIt != m_vertexArrayIds.end()) {
+		return vertexArrayIt->second;
+	}
+
+	Gl::Uint vertexArrayId = 0;
+	gl.genVertexArrays(1, &vertexArrayId);
+	gl.state.bindVertexArray(vertexArrayId);
+
 	/* Looks a bit ugly ... */
 	gl.enableVertexAttribArray(attrIndices.positionIndex);
 	if (attrIndices.texCoordsAreRequired) {
@@ -183,64 +342,49 @@ void ATD::VertexBuffer3D::drawSelfInternal(
 	{
 		Usage useVBuffer(*this);
 
+		Gl::Sizei stride = static_cast<Gl::Sizei>(m_layout.stride(true));
+		auto attribPointer = [stride](Gl::Uint index, 
+				const VertexLayout::Attribute &attribute) {
+			gl.vertexAttribPointer(index, 
+					attribute.size, 
+					attribute.type, 
+					attribute.normalized, 
+					stride, 
+					reinterpret_cast<const void *>(attribute.offset));
+		};
+
 		/* position is set unconditionally */
-		gl.vertexAttribPointer(attrIndices.positionIndex, 
-				static_cast<Gl::Int>(sizeof(Vector3F) / sizeof(float)), 
-				Gl::FLOAT, 
-				Gl::FALSE, 
-				static_cast<Gl::Sizei>(sizeof(Vertex3D::GlVertex)), 
-				reinterpret_cast<const void *>(0));
+		attribPointer(attrIndices.positionIndex, 
+				m_layout.positionAttribute(true));
 
 		/* texCoords are set optionally */
 		if (attrIndices.texCoordsAreRequired) {
-			gl.vertexAttribPointer(attrIndices.texCoordsIndex, 
-					static_cast<Gl::Int>(sizeof(Vector2F) / sizeof(float)), 
-					Gl::FLOAT, 
-					Gl::FALSE, 
-					static_cast<Gl::Sizei>(sizeof(Vertex3D::GlVertex)), 
-					reinterpret_cast<const void *>(sizeof(Vector3F)));
+			attribPointer(attrIndices.texCoordsIndex, 
+					m_layout.texCoordsAttribute(true));
 		}
 
 		/* normal is set optionally */
 		if (attrIndices.normalIsRequired) {
-			gl.vertexAttribPointer(attrIndices.normalIndex, 
-					static_cast<Gl::Int>(sizeof(Vector3F) / sizeof(float)), 
-					Gl::FLOAT, 
-					Gl::FALSE, 
-					static_cast<Gl::Sizei>(sizeof(Vertex3D::GlVertex)), 
-					reinterpret_cast<const void *>(sizeof(Vector3F) + 
-						sizeof(Vector2F)));
+			attribPointer(attrIndices.normalIndex, 
+					m_layout.normalAttribute());
 		}
 
 		/* color is set optionally */
 		if (attrIndices.colorIsRequired) {
-			gl.vertexAttribPointer(attrIndices.colorIndex, 
-					static_cast<Gl::Int>(sizeof(Vector4F) / sizeof(float)), 
-					Gl::FLOAT, 
-					Gl::FALSE, 
-					static_cast<Gl::Sizei>(sizeof(Vertex3D::GlVertex)), 
-					reinterpret_cast<const void *>(sizeof(Vector3F) + 
-						sizeof(Vector2F) + sizeof(Vector3F)));
+			attribPointer(attrIndices.colorIndex, 
+					m_layout.colorAttribute(true));
 		}
-
-		Gl::Enum primitive = 
-			m_primitive == TRIANGLES ? Gl::TRIANGLES : 
-			m_primitive == TRIANGLE_STRIP ? Gl::TRIANGLE_STRIP : 
-			Gl::TRIANGLE_FAN;
-
-		gl.drawArrays(primitive, 0, static_cast<Gl::Sizei>(m_size));
 	}
 
-	if (attrIndices.colorIsRequired) {
-		gl.disableVertexAttribArray(attrIndices.colorIndex);
-	}
-	if (attrIndices.normalIsRequired) {
-		gl.disableVertexAttribArray(attrIndices.normalIndex);
+	/* Element array binding is a part of the vertex array state, so it is 
+	 * not restored while the vertex array is bound. */
+	if (m_indexBufferPtr) {
+		gl.state.bindBuffer(Gl::ELEMENT_ARRAY_BUFFER, 
+				m_indexBufferPtr->glId());
 	}
-	if (attrIndices.texCoordsAreRequired) {
-		gl.disableVertexAttribArray(attrIndices.texCoordsIndex);
-	}
-	gl.disableVertexAttribArray(attrIndices.positionIndex);
-}
 
+	gl.state.bindVertexArray(0);
 
+	m_vertexArrayIds.insert(std::make_pair(attrIndices, vertexArrayId));
+	return vertexArrayId;
+}
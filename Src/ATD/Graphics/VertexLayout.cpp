@@ -0,0 +1,285 @@
+/**
+ * @file      
+ * @brief     Packed vertex formats for vertex buffers.
+ * @details   ...
+ * @author    ArthurTheDigital (arthurthedigital@gmail.com)
+ * @copyright GPL v3.
+ * @since     $Id: $ */
+
+#include <ATD/Graphics/VertexLayout.hpp>
+
+#include <ATD/Core/MinMax.hpp>
+
+#include <math.h>
+#include <string.h>
+
+
+/* ATD::VertexLayout auxiliary: */
+
+/* IEEE 754 binary16, rounded to nearest. */
+static uint16_t _halfFloat(float value)
+{
+	uint32_t bits = 0;
+	::memcpy(&bits, &value, sizeof(bits));
+
+	uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+	uint32_t rawExponent = (bits >> 23) & 0xFF;
+	uint32_t mantissa = bits & 0x7FFFFF;
+
+	if (rawExponent == 0xFF) {
+		/* Infinity or NaN. */
+		return sign | 0x7C00 | (mantissa ? 0x200 : 0);
+	}
+
+	int32_t exponent = static_cast<int32_t>(rawExponent) - 127 + 15;
+	if (exponent >= 0x1F) {
+		return sign | 0x7C00;
+	}
+
+	if (exponent <= 0) {
+		/* Subnormal or zero. */
+		if (exponent < -10) {
+			return sign;
+		}
+		mantissa |= 0x800000;
+		uint32_t shift = static_cast<uint32_t>(14 - exponent);
+		uint32_t half = mantissa >> shift;
+		if ((mantissa >> (shift - 1)) & 1) { half++; }
+		return sign | static_cast<uint16_t>(half);
+	}
+
+	/* Rounding carry may go to the exponent, that is still correct. */
+	uint32_t half = (static_cast<uint32_t>(exponent) << 10) | 
+		(mantissa >> 13);
+	if (mantissa & 0x1000) { half++; }
+	return sign | static_cast<uint16_t>(half);
+}
+
+static uint16_t _unorm16(float value)
+{
+	return static_cast<uint16_t>(
+			::lroundf(ATD::clamp<float>(value, 0.f, 1.f) * 65535.f));
+}
+
+static int16_t _snorm16(float value)
+{
+	return static_cast<int16_t>(
+			::lroundf(ATD::clamp<float>(value, -1.f, 1.f) * 32767.f));
+}
+
+static uint8_t _unorm8(float value)
+{
+	return static_cast<uint8_t>(
+			::lroundf(ATD::clamp<float>(value, 0.f, 1.f) * 255.f));
+}
+
+static uint32_t _int2101010Rev(const ATD::Vector3F &value)
+{
+	auto snorm10 = [](float component) -> uint32_t {
+		long packed = ::lroundf(
+				ATD::clamp<float>(component, -1.f, 1.f) * 511.f);
+		return static_cast<uint32_t>(packed) & 0x3FF;
+	};
+
+	/* w (2 bits) is 0. */
+	return snorm10(value.x) | 
+		(snorm10(value.y) << 10) | 
+		(snorm10(value.z) << 20);
+}
+
+static size_t _texCoordsSize(const ATD::VertexLayout::TexCoords &texCoords)
+{
+	return texCoords == ATD::VertexLayout::TEX_COORDS_FLOAT ? 
+		sizeof(float) * 2 : sizeof(uint16_t) * 2;
+}
+
+static size_t _normalSize(const ATD::VertexLayout::Normal &normal)
+{
+	/* snorm16 is padded to 4 components, to keep 4-byte alignment. */
+	return normal == ATD::VertexLayout::NORMAL_FLOAT ? sizeof(float) * 3 : 
+		normal == ATD::VertexLayout::NORMAL_INT_2_10_10_10_REV ? 
+		sizeof(uint32_t) : sizeof(int16_t) * 4;
+}
+
+static size_t _colorSize(const ATD::VertexLayout::Color &color)
+{
+	return color == ATD::VertexLayout::COLOR_FLOAT ? 
+		sizeof(float) * 4 : sizeof(uint8_t) * 4;
+}
+
+template<typename T>
+static void _append(uint8_t *&cursor, const T &value)
+{
+	::memcpy(cursor, &value, sizeof(T));
+	cursor += sizeof(T);
+}
+
+static void _appendTexCoords(uint8_t *&cursor, 
+		const ATD::VertexLayout::TexCoords &texCoords, 
+		const ATD::Vector2F &value)
+{
+	switch (texCoords) {
+		case ATD::VertexLayout::TEX_COORDS_FLOAT:
+			_append(cursor, value.x);
+			_append(cursor, value.y);
+			break;
+		case ATD::VertexLayout::TEX_COORDS_HALF_FLOAT:
+			_append(cursor, _halfFloat(value.x));
+			_append(cursor, _halfFloat(value.y));
+			break;
+		case ATD::VertexLayout::TEX_COORDS_UNORM16:
+			_append(cursor, _unorm16(value.x));
+			_append(cursor, _unorm16(value.y));
+			break;
+	}
+}
+
+static void _appendNormal(uint8_t *&cursor, 
+		const ATD::VertexLayout::Normal &normal, 
+		const ATD::Vector3F &value)
+{
+	switch (normal) {
+		case ATD::VertexLayout::NORMAL_FLOAT:
+			_append(cursor, value.x);
+			_append(cursor, value.y);
+			_append(cursor, value.z);
+			break;
+		case ATD::VertexLayout::NORMAL_INT_2_10_10_10_REV:
+			_append(cursor, _int2101010Rev(value));
+			break;
+		case ATD::VertexLayout::NORMAL_SNORM16:
+			_append(cursor, _snorm16(value.x));
+			_append(cursor, _snorm16(value.y));
+			_append(cursor, _snorm16(value.z));
+			_append(cursor, static_cast<int16_t>(0));
+			break;
+	}
+}
+
+static void _appendColor(uint8_t *&cursor, 
+		const ATD::VertexLayout::Color &color, 
+		const ATD::Vector4F &value)
+{
+	switch (color) {
+		case ATD::VertexLayout::COLOR_FLOAT:
+			_append(cursor, value.x);
+			_append(cursor, value.y);
+			_append(cursor, value.z);
+			_append(cursor, value.w);
+			break;
+		case ATD::VertexLayout::COLOR_UNORM8:
+			_append(cursor, _unorm8(value.x));
+			_append(cursor, _unorm8(value.y));
+			_append(cursor, _unorm8(value.z));
+			_append(cursor, _unorm8(value.w));
+			break;
+	}
+}
+
+
+/* ATD::VertexLayout constants: */
+
+const ATD::VertexLayout ATD::VertexLayout::COMPACT = ATD::VertexLayout(
+		ATD::VertexLayout::TEX_COORDS_HALF_FLOAT, 
+		ATD::VertexLayout::NORMAL_INT_2_10_10_10_REV, 
+		ATD::VertexLayout::COLOR_UNORM8);
+
+
+/* ATD::VertexLayout: */
+
+bool ATD::VertexLayout::isFloat() const
+{
+	return texCoords == TEX_COORDS_FLOAT && 
+		normal == NORMAL_FLOAT && 
+		color == COLOR_FLOAT;
+}
+
+size_t ATD::VertexLayout::stride(bool is3D) const
+{
+	return is3D ? 
+		sizeof(float) * 3 + _texCoordsSize(texCoords) + 
+			_normalSize(normal) + _colorSize(color) : 
+		sizeof(float) * 2 + _texCoordsSize(texCoords) + _colorSize(color);
+}
+
+ATD::VertexLayout::Attribute ATD::VertexLayout::positionAttribute(
+		bool is3D) const
+{
+	Attribute attribute;
+	attribute.size = is3D ? 3 : 2;
+	attribute.type = Gl::FLOAT;
+	attribute.normalized = Gl::FALSE;
+	attribute.offset = 0;
+	return attribute;
+}
+
+ATD::VertexLayout::Attribute ATD::VertexLayout::texCoordsAttribute(
+		bool is3D) const
+{
+	Attribute attribute;
+	attribute.size = 2;
+	attribute.type = texCoords == TEX_COORDS_FLOAT ? Gl::FLOAT : 
+		texCoords == TEX_COORDS_HALF_FLOAT ? Gl::HALF_FLOAT : 
+		Gl::UNSIGNED_SHORT;
+	attribute.normalized = texCoords == TEX_COORDS_UNORM16 ? 
+		Gl::TRUE : Gl::FALSE;
+	attribute.offset = sizeof(float) * (is3D ? 3 : 2);
+	return attribute;
+}
+
+ATD::VertexLayout::Attribute ATD::VertexLayout::normalAttribute() const
+{
+	Attribute attribute;
+	attribute.size = normal == NORMAL_INT_2_10_10_10_REV ? 4 : 3;
+	attribute.type = normal == NORMAL_FLOAT ? Gl::FLOAT : 
+		normal == NORMAL_INT_2_10_10_10_REV ? Gl::INT_2_10_10_10_REV : 
+		Gl::SHORT;
+	attribute.normalized = normal == NORMAL_FLOAT ? Gl::FALSE : Gl::TRUE;
+	attribute.offset = sizeof(float) * 3 + _texCoordsSize(texCoords);
+	return attribute;
+}
+
+ATD::VertexLayout::Attribute ATD::VertexLayout::colorAttribute(
+		bool is3D) const
+{
+	Attribute attribute;
+	attribute.size = 4;
+	attribute.type = color == COLOR_FLOAT ? Gl::FLOAT : Gl::UNSIGNED_BYTE;
+	attribute.normalized = color == COLOR_FLOAT ? Gl::FALSE : Gl::TRUE;
+	attribute.offset = is3D ? 
+		sizeof(float) * 3 + _texCoordsSize(texCoords) + _normalSize(normal) : 
+		sizeof(float) * 2 + _texCoordsSize(texCoords);
+	return attribute;
+}
+
+std::vector<uint8_t> ATD::VertexLayout::packed(
+		const std::vector<ATD::Vertex2D::GlVertex> &glVertices) const
+{
+	std::vector<uint8_t> data(stride(false) * glVertices.size(), 0);
+	uint8_t *cursor = data.data();
+	for (auto &glVertex : glVertices) {
+		_append(cursor, glVertex.position.x);
+		_append(cursor, glVertex.position.y);
+		_appendTexCoords(cursor, texCoords, glVertex.texCoords);
+		_appendColor(cursor, color, glVertex.color);
+	}
+	return data;
+}
+
+std::vector<uint8_t> ATD::VertexLayout::packed(
+		const std::vector<ATD::Vertex3D::GlVertex> &glVertices) const
+{
+	std::vector<uint8_t> data(stride(true) * glVertices.size(), 0);
+	uint8_t *cursor = data.data();
+	for (auto &glVertex : glVertices) {
+		_append(cursor, glVertex.position.x);
+		_append(cursor, glVertex.position.y);
+		_append(cursor, glVertex.position.z);
+		_appendTexCoords(cursor, texCoords, glVertex.texCoords);
+		_appendNormal(cursor, normal, glVertex.normal);
+		_appendColor(cursor, color, glVertex.color);
+	}
+	return data;
+}
+
+
@@ -0,0 +1,156 @@
+/**
+ * @file      
+ * @brief     Window resource loader thread implementation.
+ * @details   ...
+ * @author    ArthurTheDigital (arthurthedigital@gmail.com)
+ * @copyright GPL v3.
+ * @since     $Id: $ */
+
+#include <ATD/Window/Loader.hpp>
+
+#include <ATD/Graphics/Gl.hpp>
+#include <ATD/Window/WindowX11.hpp>
+
+#include <stdexcept>
+
+
+/* ATD::Window::Loader constants: */
+
+const ATD::Gl::Uint64 ATD::Window::Loader::FENCE_TIMEOUT_NS = 100000000;
+
+
+/* ATD::Window::Loader auxiliary: */
+
+static void _markReady(ATD::Window::LoadJob &job, 
+		const std::shared_ptr<void> &resourcePtr, 
+		const std::exception_ptr &errorPtr)
+{
+	/* The job function holds captures, which may be GL resources too. */
+	job.loadFunc = nullptr;
+	job.resourcePtr = resourcePtr;
+	job.errorPtr = errorPtr;
+	job.isReady.store(true);
+}
+
+
+/* ATD::Window::Loader: */
+
+ATD::Window::Loader::Loader(ATD::Window::WindowX11 &winX11)
+	: m_winX11(winX11)
+	, m_jobPtrs()
+	, m_isStopping(false)
+	, m_mtx()
+	, m_cond()
+	, m_thread()
+{
+	if (!m_winX11.glLoaderCtx) {
+		throw std::runtime_error("no shared GLX context for loading");
+	}
+	if (!gl.fenceSync || !gl.clientWaitSync || !gl.deleteSync) {
+		throw std::runtime_error("GL fences are not supported");
+	}
+
+	m_thread = std::thread(&Loader::run, this);
+}
+
+ATD::Window::Loader::~Loader()
+{
+	std::deque<std::shared_ptr<LoadJob> > jobPtrs;
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		m_isStopping = true;
+		jobPtrs.swap(m_jobPtrs);
+	}
+	m_cond.notify_all();
+	m_thread.join();
+
+	std::exception_ptr errorPtr = std::make_exception_ptr(
+			std::runtime_error("loading canceled"));
+	for (auto &jobPtr : jobPtrs) {
+		_markReady(*jobPtr, nullptr, errorPtr);
+	}
+}
+
+void ATD::Window::Loader::push(
+		const std::shared_ptr<ATD::Window::LoadJob> &jobPtr)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		m_jobPtrs.push_back(jobPtr);
+	}
+	m_cond.notify_all();
+}
+
+void ATD::Window::Loader::run()
+{
+	bool isCurrent = X11::glXMakeCurrent(m_winX11.displayPtr, 
+			m_winX11.window, m_winX11.glLoaderCtx);
+	if (isCurrent) {
+		gl.state.reset();
+	}
+
+	std::unique_lock<std::mutex> lock(m_mtx);
+	while (true) {
+		m_cond.wait(lock, [this]() {
+			return !m_jobPtrs.empty() || m_isStopping;
+		});
+		if (m_isStopping) {
+			break;
+		}
+
+		std::shared_ptr<LoadJob> jobPtr = m_jobPtrs.front();
+		m_jobPtrs.pop_front();
+		lock.unlock();
+
+		std::shared_ptr<void> resourcePtr;
+		std::exception_ptr errorPtr;
+		if (!isCurrent) {
+			errorPtr = std::make_exception_ptr(
+					std::runtime_error("'glXMakeCurrent(..)' failure"));
+		} else {
+			try {
+				resourcePtr = jobPtr->loadFunc();
+
+				/* Uploads are asynchronous: the other context may see 
+				 * incomplete data before the fence is signaled. */
+				waitFence();
+			} catch (...) {
+				resourcePtr = nullptr;
+				errorPtr = std::current_exception();
+			}
+		}
+		_markReady(*jobPtr, resourcePtr, errorPtr);
+
+		lock.lock();
+	}
+	lock.unlock();
+
+	if (isCurrent) {
+		gl.state.release();
+	}
+	X11::glXMakeCurrent(m_winX11.displayPtr, None, nullptr);
+}
+
+void ATD::Window::Loader::waitFence()
+{
+	Gl::Sync fence = gl.fenceSync(Gl::SYNC_GPU_COMMANDS_COMPLETE, 0);
+	if (!fence) {
+		throw std::runtime_error("'glFenceSync(..)' failure");
+	}
+
+	/* Flush on the first wait only, so that the fence is not stuck in the 
+	 * command queue. */
+	Gl::Enum status = gl.clientWaitSync(fence, 
+			Gl::SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NS);
+	while (status == Gl::TIMEOUT_EXPIRED) {
+		status = gl.clientWaitSync(fence, 0, FENCE_TIMEOUT_NS);
+	}
+	gl.deleteSync(fence);
+
+	if (status != Gl::ALREADY_SIGNALED && 
+			status != Gl::CONDITION_SATISFIED) {
+		throw std::runtime_error("'glClientWaitSync(..)' failure");
+	}
+}
+
+
@@ -0,0 +1,75 @@
+/**
+ * @file      
+ * @brief     Window resource loader thread implementation.
+ * @details   ...
+ * @author    ArthurTheDigital (arthurthedigital@gmail.com)
+ * @copyright GPL v3.
+ * @since     $Id: $ */
+
+#pragma once
+
+#include <ATD/Window/Window.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+
+/* ATD::Window::Loader: */
+
+/**
+ * @brief Thread with the loader context, shared with the window one.
+ * @class ...
+ *
+ * Jobs are executed in order. After each job a fence is inserted and 
+ * waited for, and only then the job is marked ready, so the resource is 
+ * complete, when the window context sees it. */
+class ATD::Window::Loader
+{
+public:
+	/* Fence wait portion, the wait is repeated until signaled. */
+	static const Gl::Uint64 FENCE_TIMEOUT_NS;
+
+
+	/**
+	 * @brief ...
+	 * @param winX11 - ...
+	 * @throws if the loader context or fences are not available */
+	Loader(WindowX11 &winX11);
+
+	/**
+	 * @brief Finish the current job, drop the rest and stop.
+	 *
+	 * Dropped jobs are marked ready with an error. */
+	~Loader();
+
+	/**
+	 * @brief ...
+	 * @param jobPtr - ... */
+	void push(const std::shared_ptr<LoadJob> &jobPtr);
+
+private:
+	/* Non-copyable. */
+	Loader(const Loader &other) = delete;
+
+	/**
+	 * @brief Loader thread loop. */
+	void run();
+
+	/**
+	 * @brief Wait, until the GL commands, issued so far, are complete. */
+	static void waitFence();
+
+
+	WindowX11 &m_winX11;
+
+	std::deque<std::shared_ptr<LoadJob> > m_jobPtrs;
+	bool m_isStopping;
+
+	std::mutex m_mtx;
+	std::condition_variable m_cond;
+	std::thread m_thread;
+};
+
+
@@ -0,0 +1,195 @@
+/**
+ * @file      
+ * @brief     Window render thread implementation.
+ * @details   ...
+ * @author    ArthurTheDigital (arthurthedigital@gmail.com)
+ * @copyright GPL v3.
+ * @since     $Id: $ */
+
+#include <ATD/Window/RenderThread.hpp>
+
+#include <ATD/Graphics/Gl.hpp>
+#include <ATD/Window/WindowInternal.hpp>
+#include <ATD/Window/WindowX11.hpp>
+
+#include <stdexcept>
+
+
+/* ATD::Window::RenderThread: */
+
+ATD::Window::RenderThread::RenderThread(ATD::Window::WindowX11 &winX11, 
+		ATD::Window::WindowInternal &internal)
+	: internalMtx()
+	, m_winX11(winX11)
+	, m_internal(internal)
+	, m_recordedCommands()
+	, m_renderedCommands()
+	, m_invokedPtr(nullptr)
+	, m_isBusy(false)
+	, m_isStopping(false)
+	, m_errorPtr()
+	, m_mtx()
+	, m_cond()
+	, m_thread()
+{
+	/* A context may be current in one thread at a time. */
+	if (X11::glXGetCurrentContext() == m_winX11.glRenderCtx) {
+		gl.state.release();
+	}
+	X11::glXMakeCurrent(m_winX11.displayPtr, None, nullptr);
+
+	m_thread = std::thread(&RenderThread::run, this);
+}
+
+ATD::Window::RenderThread::~RenderThread()
+{
+	{
+		std::unique_lock<std::mutex> lock(m_mtx);
+		m_cond.wait(lock, [this]() { return !m_isBusy; });
+		m_isStopping = true;
+	}
+	m_cond.notify_all();
+	m_thread.join();
+
+	/* Commands, left unsubmitted, may hold GL resources. */
+	X11::glXMakeCurrent(m_winX11.displayPtr, m_winX11.window, 
+			m_winX11.glRenderCtx);
+	gl.state.reset();
+	m_recordedCommands.clear();
+}
+
+void ATD::Window::RenderThread::record(
+		const ATD::Window::RenderThread::Command &command)
+{
+	m_recordedCommands.push_back(command);
+}
+
+void ATD::Window::RenderThread::submit()
+{
+	std::exception_ptr errorPtr;
+	{
+		std::unique_lock<std::mutex> lock(m_mtx);
+		errorPtr = waitIdle(lock);
+
+		/* The render thread leaves its buffer empty, so the recording 
+		 * continues into the cleared buffer of the previous frame. */
+		m_recordedCommands.swap(m_renderedCommands);
+		m_isBusy = true;
+	}
+	m_cond.notify_all();
+
+	/* The frame is submitted anyway, so the commands are not piled up. */
+	if (errorPtr) {
+		std::rethrow_exception(errorPtr);
+	}
+}
+
+void ATD::Window::RenderThread::invoke(
+		const ATD::Window::RenderThread::Command &command)
+{
+	/* Called from a recorded command. */
+	if (std::this_thread::get_id() == m_thread.get_id()) {
+		command();
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(m_mtx);
+	std::exception_ptr errorPtr = waitIdle(lock);
+	if (!errorPtr) {
+		m_invokedPtr = &command;
+		m_isBusy = true;
+		m_cond.notify_all();
+
+		errorPtr = waitIdle(lock);
+	}
+
+	if (errorPtr) {
+		std::rethrow_exception(errorPtr);
+	}
+}
+
+void ATD::Window::RenderThread::run()
+{
+	bool isCurrent = X11::glXMakeCurrent(m_winX11.displayPtr, 
+			m_winX11.window, m_winX11.glRenderCtx);
+	if (isCurrent) {
+		/* The shadow state is per thread, the context is not new. */
+		gl.state.reset();
+	}
+
+	std::unique_lock<std::mutex> lock(m_mtx);
+	while (true) {
+		m_cond.wait(lock, [this]() { return m_isBusy || m_isStopping; });
+		if (!m_isBusy) {
+			break;
+		}
+
+		const Command *invokedPtr = m_invokedPtr;
+		lock.unlock();
+
+		std::exception_ptr errorPtr;
+		if (!isCurrent) {
+			errorPtr = std::make_exception_ptr(
+					std::runtime_error("'glXMakeCurrent(..)' failure"));
+		} else {
+			try {
+				if (invokedPtr) {
+					(*invokedPtr)();
+				} else {
+					renderFrame();
+				}
+			} catch (...) {
+				errorPtr = std::current_exception();
+			}
+		}
+
+		/* Captured resources are released here, with the context. */
+		m_renderedCommands.clear();
+
+		lock.lock();
+		if (!m_errorPtr) {
+			m_errorPtr = errorPtr;
+		}
+		m_invokedPtr = nullptr;
+		m_isBusy = false;
+		m_cond.notify_all();
+	}
+	lock.unlock();
+
+	if (isCurrent) {
+		gl.state.release();
+	}
+	X11::glXMakeCurrent(m_winX11.displayPtr, None, nullptr);
+}
+
+void ATD::Window::RenderThread::renderFrame()
+{
+	for (auto &command : m_renderedCommands) {
+		command();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(internalMtx);
+
+		/* Resize, noticed by poll(), is reported by the next poll(). */
+		if (m_internal.applyResize()) {
+			m_internal.updateTransform(m_winX11);
+		}
+		m_internal.present(m_winX11);
+	}
+
+	/* Swap may block until vblank, poll() is not held meanwhile. */
+	X11::glXSwapBuffers(m_winX11.displayPtr, m_winX11.window);
+}
+
+std::exception_ptr ATD::Window::RenderThread::waitIdle(
+		std::unique_lock<std::mutex> &lock)
+{
+	m_cond.wait(lock, [this]() { return !m_isBusy; });
+
+	std::exception_ptr errorPtr = m_errorPtr;
+	m_errorPtr = nullptr;
+	return errorPtr;
+}
+
+
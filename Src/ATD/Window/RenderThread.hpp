@@ -0,0 +1,104 @@
+/**
+ * @file      
+ * @brief     Window render thread implementation.
+ * @details   ...
+ * @author    ArthurTheDigital (arthurthedigital@gmail.com)
+ * @copyright GPL v3.
+ * @since     $Id: $ */
+
+#pragma once
+
+#include <ATD/Window/Window.hpp>
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/* ATD::Window::RenderThread: */
+
+/**
+ * @brief Thread, which owns the window GL context.
+ * @class ...
+ *
+ * The game thread records commands into one buffer, while the render 
+ * thread executes the other one (the previous frame). submit() swaps the 
+ * buffers, so that at most one frame is in flight. */
+class ATD::Window::RenderThread
+{
+public:
+	typedef std::function<void()> Command;
+
+
+	/**
+	 * @brief Release the context on the calling thread and start.
+	 * @param winX11   - ...
+	 * @param internal - ... */
+	RenderThread(WindowX11 &winX11, WindowInternal &internal);
+
+	/**
+	 * @brief Finish the frame in flight, stop and make the context 
+	 * current on the calling thread again. */
+	~RenderThread();
+
+	/**
+	 * @brief Append a command to the recorded frame.
+	 * @param command - ... */
+	void record(const Command &command);
+
+	/**
+	 * @brief Hand the recorded frame to the render thread.
+	 * @throws the error of the previous frame, if any
+	 *
+	 * Waits, until the previous frame is rendered. */
+	void submit();
+
+	/**
+	 * @brief Execute the command on the render thread and wait for it.
+	 * @param command - ...
+	 * @throws the error of the command or of the previous frame */
+	void invoke(const Command &command);
+
+
+	/* Guards WindowInternal, shared by poll() and the frame presentation. */
+	std::mutex internalMtx;
+
+private:
+	/* Non-copyable. */
+	RenderThread(const RenderThread &other) = delete;
+
+	/**
+	 * @brief Render thread loop. */
+	void run();
+
+	/**
+	 * @brief Execute the frame commands, present and swap buffers. */
+	void renderFrame();
+
+	/**
+	 * @brief Wait, until the render thread is idle.
+	 * @param lock - locked m_mtx
+	 * @return the error of the previous frame or command (taken), if any */
+	std::exception_ptr waitIdle(std::unique_lock<std::mutex> &lock);
+
+
+	WindowX11 &m_winX11;
+	WindowInternal &m_internal;
+
+	std::vector<Command> m_recordedCommands; /* Game thread side. */
+	std::vector<Command> m_renderedCommands; /* Render thread side. */
+	const Command *m_invokedPtr; /* Instead of the frame, if set. */
+
+	bool m_isBusy;
+	bool m_isStopping;
+	std::exception_ptr m_errorPtr;
+
+	std::mutex m_mtx;
+	std::condition_variable m_cond;
+	std::thread m_thread;
+};
+
+
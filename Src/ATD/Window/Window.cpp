@@ -11,10 +11,13 @@
 #include <ATD/Core/Debug.hpp>
 #include <ATD/Core/Printf.hpp>
 
+#include <ATD/Window/Loader.hpp>
+#include <ATD/Window/RenderThread.hpp>
 #include <ATD/Window/WindowX11.hpp>
 #include <ATD/Window/WindowInternal.hpp>
 
 #include <set>
+#include <stdexcept>
 
 #define IGNORE_UNUSED(x) (void)(x)
 
@@ -66,6 +69,8 @@ ATD::Window::Window(const ATD::Vector2S &size,
 		const ATD::Window::PixelSize &pixelSize)
 	: m_x11(new WindowX11(size * static_cast<unsigned>(pixelSize), title))
 	, m_internal(new WindowInternal(size, static_cast<unsigned>(pixelSize)))
+	, m_renderThread(nullptr)
+	, m_loader(nullptr)
 	, m_observerPtrs()
 	, m_observerPtrsLock()
 	, m_events()
@@ -79,6 +84,10 @@ ATD::Window::Window(const ATD::Vector2S &size,
 
 ATD::Window::~Window()
 {
+	/* The contexts shall be released, before they are destroyed. */
+	delete m_loader;
+	stopRenderThread();
+
 	delete m_x11;
 
 	/* Detach all observers. */
@@ -92,6 +101,28 @@ ATD::Window::~Window()
 	for (auto &observerPtr : observerPtrs) { observerPtr->detach(); }
 }
 
+void ATD::Window::startRenderThread()
+{
+	if (!m_renderThread) {
+		m_renderThread = new RenderThread(*m_x11, *m_internal);
+	}
+}
+
+void ATD::Window::stopRenderThread()
+{
+	delete m_renderThread;
+	m_renderThread = nullptr;
+}
+
+void ATD::Window::invoke(const ATD::Window::GlFunc &glFunc)
+{
+	if (m_renderThread) {
+		m_renderThread->invoke(glFunc);
+	} else {
+		glFunc();
+	}
+}
+
 void ATD::Window::poll(bool keepEvents)
 {
 	/* Prepare all Observers. */
@@ -123,7 +154,13 @@ void ATD::Window::poll(bool keepEvents)
 
 	{
 		std::list<Event> newEvents;
-		m_internal->processX11Events(xEvts, newEvents, *m_x11);
+		if (m_renderThread) {
+			/* FrameBuffer is replaced on the render thread. */
+			std::lock_guard<std::mutex> lock(m_renderThread->internalMtx);
+			m_internal->processX11Events(xEvts, newEvents, *m_x11, true);
+		} else {
+			m_internal->processX11Events(xEvts, newEvents, *m_x11);
+		}
 
 		/* Notify all Observers. */
 		for (auto &evt : newEvents) {
@@ -164,6 +201,10 @@ bool ATD::Window::pollEvent(ATD::Window::Event &evt)
 
 ATD::Vector2U ATD::Window::size() const
 {
+	if (m_renderThread) {
+		std::lock_guard<std::mutex> lock(m_renderThread->internalMtx);
+		return m_internal->frameBufferPtr->size();
+	}
 	return m_internal->frameBufferPtr->size();
 }
 
@@ -179,48 +220,162 @@ bool ATD::Window::isClosed() const
 
 void ATD::Window::setShader2D(ATD::Shader2D::Ptr shader2DPtr)
 {
-	m_internal->frameBufferPtr->setShader2D(shader2DPtr);
+	WindowInternal *internal = m_internal;
+	record([internal, shader2DPtr]() {
+		internal->frameBufferPtr->setShader2D(shader2DPtr);
+	});
 }
 
 void ATD::Window::setShader3D(ATD::Shader3D::Ptr shader3DPtr)
 {
-	m_internal->frameBufferPtr->setShader3D(shader3DPtr);
+	WindowInternal *internal = m_internal;
+	record([internal, shader3DPtr]() {
+		internal->frameBufferPtr->setShader3D(shader3DPtr);
+	});
 }
 
 void ATD::Window::setProjection2D(const ATD::Projection2D &projection2D)
 {
-	m_internal->frameBufferPtr->setProjection2D(projection2D);
+	WindowInternal *internal = m_internal;
+	record([internal, projection2D]() {
+		internal->frameBufferPtr->setProjection2D(projection2D);
+	});
 }
 
 void ATD::Window::setProjection3D(const ATD::Projection3D &projection3D)
 {
-	m_internal->frameBufferPtr->setProjection3D(projection3D);
+	WindowInternal *internal = m_internal;
+	record([internal, projection3D]() {
+		internal->frameBufferPtr->setProjection3D(projection3D);
+	});
+}
+
+bool ATD::Window::setSwapInterval(int interval)
+{
+	bool result = false;
+	invoke([this, interval, &result]() {
+		result = m_x11->setSwapInterval(interval);
+	});
+	return result;
+}
+
+void ATD::Window::setAlign(const ATD::Align &alignX, 
+		const ATD::Align &alignY)
+{
+	std::unique_lock<std::mutex> lock;
+	if (m_renderThread) {
+		lock = std::unique_lock<std::mutex>(m_renderThread->internalMtx);
+	}
+
+	m_internal->alignX = alignX;
+	m_internal->alignY = alignY;
+	m_internal->updateTransform(*m_x11);
+}
+
+void ATD::Window::setPostShader(ATD::Shader2D::Ptr postShaderPtr)
+{
+	WindowInternal *internal = m_internal;
+	record([internal, postShaderPtr]() {
+		if (postShaderPtr) {
+			postShaderPtr->setUniform("unfProject", 
+					Projection2D().matrix());
+		}
+		internal->postShaderPtr = postShaderPtr;
+	});
 }
 
 void ATD::Window::clear()
 {
-	m_internal->frameBufferPtr->clear();
+	if (m_renderThread) {
+		WindowInternal *internal = m_internal;
+		m_renderThread->record([internal]() {
+			internal->frameBufferPtr->clear();
+		});
+	} else {
+		m_internal->frameBufferPtr->clear();
+	}
 }
 
 void ATD::Window::draw(const ATD::FrameBuffer::Drawable &drawable)
 {
+	if (m_renderThread) {
+		throw std::runtime_error(
+				"drawable drawn by reference with render thread");
+	}
+
 	m_internal->frameBufferPtr->draw(drawable);
 }
 
 void ATD::Window::draw(const ATD::VertexBuffer2D &vertices2D, 
 		const ATD::Transform2D &transform)
 {
+	if (m_renderThread) {
+		throw std::runtime_error(
+				"vertices drawn by reference with render thread");
+	}
+
 	m_internal->frameBufferPtr->draw(vertices2D, transform);
 }
 
+void ATD::Window::draw(const ATD::VertexBuffer2D::CPtr &vertices2DPtr, 
+		const ATD::Transform2D &transform)
+{
+	if (m_renderThread) {
+		WindowInternal *internal = m_internal;
+		m_renderThread->record([internal, vertices2DPtr, transform]() {
+			internal->frameBufferPtr->draw(*vertices2DPtr, transform);
+		});
+	} else {
+		m_internal->frameBufferPtr->draw(*vertices2DPtr, transform);
+	}
+}
+
+void ATD::Window::draw(const ATD::Window::DrawFunc &drawFunc)
+{
+	if (m_renderThread) {
+		WindowInternal *internal = m_internal;
+		m_renderThread->record([internal, drawFunc]() {
+			drawFunc(*internal->frameBufferPtr);
+		});
+	} else {
+		drawFunc(*m_internal->frameBufferPtr);
+	}
+}
+
 ATD::Texture::CPtr ATD::Window::getColorTexture() const
 {
+	if (m_renderThread) {
+		std::lock_guard<std::mutex> lock(m_renderThread->internalMtx);
+		return m_internal->frameBufferPtr->getColorTexture();
+	}
 	return m_internal->frameBufferPtr->getColorTexture();
 }
 
 void ATD::Window::display()
 {
-	m_internal->display(*m_x11);
+	if (m_renderThread) {
+		m_renderThread->submit();
+	} else {
+		m_internal->display(*m_x11);
+	}
+}
+
+void ATD::Window::pushLoadJob(
+		const std::shared_ptr<ATD::Window::LoadJob> &jobPtr)
+{
+	if (!m_loader) {
+		m_loader = new Loader(*m_x11);
+	}
+	m_loader->push(jobPtr);
+}
+
+void ATD::Window::record(const ATD::Window::GlFunc &glFunc)
+{
+	if (m_renderThread) {
+		m_renderThread->record(glFunc);
+	} else {
+		glFunc();
+	}
 }
 
 
@@ -135,6 +135,24 @@ static const std::map<unsigned, ATD::Key::Code> _KEY_MAP = {
 	{XK_End, ATD::Key::END}
 };
 
+/* Offset of the content within the window along one axis. */
+static long _alignedOffset(const ATD::Align &align, size_t windowSize, 
+		size_t contentSize)
+{
+	long spare = static_cast<long>(windowSize) - 
+		static_cast<long>(contentSize);
+
+	return align == ATD::Align::UPPER ? spare : 
+		align == ATD::Align::CENTER ? spare / 2 : 
+		0;
+}
+
+/* Whether the value has no fractional part. */
+static bool _isInteger(double value)
+{
+	return value == static_cast<double>(static_cast<long>(value));
+}
+
 
 /* ATD::Window::WindowInternal::FbResize: */
 
@@ -277,7 +295,8 @@ ATD::Window::WindowInternal::~WindowInternal()
 void ATD::Window::WindowInternal::processX11Events(
 		std::list<X11::XEvent> &eventsX11, 
 		std::list<ATD::Window::Event> &eventsResult, 
-		ATD::Window::WindowX11 &winX11)
+		ATD::Window::WindowX11 &winX11, 
+		bool isResizeDeferred)
 {
 	/* Erase RELEASE-PRESS key sequences. */
 	{
@@ -346,12 +365,6 @@ void ATD::Window::WindowInternal::processX11Events(
 						}
 
 						winX11.size = sizeNew;
-						/* TODO: Redesign, according to alignX and alignY
-						 *
-						 * transform.setOffset(
-								ATD::Vector2D(
-									winX11.size.x % pixelSize / 2, 
-									winX11.size.y % pixelSize / 2)); */
 					}
 
 					if (positionNew != winX11.position) {
@@ -526,9 +539,21 @@ void ATD::Window::WindowInternal::processX11Events(
 		}
 	}
 
-	/* Apply & report resize events. */
-	fbResizePtr->applyIfPending(frameBufferPtr, alignX, alignY, verticesPtr);
+	/* Apply & report resize events. With a render thread, the resize is 
+	 * applied there and reported by the next poll. */
+	if (!isResizeDeferred) {
+		applyResize();
+	}
 	fbResizePtr->reportIfComplete(eventsResult);
+
+	/* Both the window and the FrameBuffer may have changed. */
+	updateTransform(winX11);
+}
+
+bool ATD::Window::WindowInternal::applyResize()
+{
+	return fbResizePtr->applyIfPending(frameBufferPtr, alignX, alignY, 
+			verticesPtr);
 }
 
 ATD::Matrix3F ATD::Window::WindowInternal::coords2DTransformMatrix(
@@ -551,27 +576,86 @@ ATD::Matrix3F ATD::Window::WindowInternal::coords2DTransformMatrix(
 	return matrix;
 }
 
-void ATD::Window::WindowInternal::display(ATD::Window::WindowX11 &winX11)
+void ATD::Window::WindowInternal::updateTransform(
+		const ATD::Window::WindowX11 &winX11)
 {
-	gl.clear(Gl::COLOR_BUFFER_BIT | Gl::DEPTH_BUFFER_BIT);
+	transform.setOffset(
+			Vector2D(
+				_alignedOffset(alignX, winX11.size.x, 
+					frameBufferPtr->size().x * pixelSize), 
+				_alignedOffset(alignY, winX11.size.y, 
+					frameBufferPtr->size().y * pixelSize)));
+}
 
-	{
-		/* IPRINTF("", "FB size: %lu %lu", 
-				frameBufferPtr->size().x, 
-				frameBufferPtr->size().y); // DEBUG */
+bool ATD::Window::WindowInternal::isBlitPresentable() const
+{
+	return !postShaderPtr && gl.blitFramebuffer && 
+		transform.angleFrc() == 0. && 
+		_isInteger(transform.scale().x) && 
+		_isInteger(transform.scale().y) && 
+		_isInteger(transform.offset().x) && 
+		_isInteger(transform.offset().y);
+}
 
-		shader.setUniform("unfTransform", 
+void ATD::Window::WindowInternal::present(ATD::Window::WindowX11 &winX11)
+{
+	if (isBlitPresentable()) {
+		/* Pixel-perfect upscale is a nearest-filtered blit into the 
+		 * default framebuffer, no shader pass required. */
+		const Vector2S &fbSize = frameBufferPtr->size();
+		Vector2L dstSize(
+				static_cast<long>(fbSize.x * transform.scale().x), 
+				static_cast<long>(fbSize.y * transform.scale().y));
+		Vector2L dstTopLeft(
+				static_cast<long>(transform.offset().x), 
+				static_cast<long>(transform.offset().y));
+
+		Gl::Uint prevReadFramebuffer = 
+			gl.state.framebuffer(Gl::READ_FRAMEBUFFER);
+		gl.state.bindFramebuffer(Gl::READ_FRAMEBUFFER, frameBufferPtr->glId());
+		gl.state.bindFramebuffer(Gl::DRAW_FRAMEBUFFER, 0);
+
+		/* Margins are cleared only if there are any. */
+		if (dstTopLeft.x > 0 || dstTopLeft.y > 0 || 
+				dstTopLeft.x + dstSize.x < static_cast<long>(winX11.size.x) || 
+				dstTopLeft.y + dstSize.y < static_cast<long>(winX11.size.y)) {
+			gl.clear(Gl::COLOR_BUFFER_BIT | Gl::DEPTH_BUFFER_BIT);
+		}
+
+		/* FrameBuffer rows go top-down, window rows go bottom-up, so the 
+		 * destination is Y-flipped. */
+		long winHeight = static_cast<long>(winX11.size.y);
+		GL_CHECK("", gl.blitFramebuffer(0, 0, 
+					static_cast<Gl::Int>(fbSize.x), 
+					static_cast<Gl::Int>(fbSize.y), 
+					static_cast<Gl::Int>(dstTopLeft.x), 
+					static_cast<Gl::Int>(winHeight - dstTopLeft.y), 
+					static_cast<Gl::Int>(dstTopLeft.x + dstSize.x), 
+					static_cast<Gl::Int>(
+						winHeight - dstTopLeft.y - dstSize.y), 
+					Gl::COLOR_BUFFER_BIT, Gl::NEAREST));
+
+		gl.state.bindFramebuffer(Gl::READ_FRAMEBUFFER, prevReadFramebuffer);
+	} else {
+		gl.clear(Gl::COLOR_BUFFER_BIT | Gl::DEPTH_BUFFER_BIT);
+
+		Shader2D &postShader = postShaderPtr ? *postShaderPtr : shader;
+		postShader.setUniform(postShader.transformUniform(), 
 				coords2DTransformMatrix(winX11) * 
 				transform.matrix());
 
-		Shader::Usage useShader(shader);
+		Shader::Usage useShader(postShader);
 		Texture::Usage useTexture(*frameBufferPtr->getColorTexture());
 
-		gl.viewport(0, 0, winX11.size.x, winX11.size.y);
+		gl.state.viewport(0, 0, winX11.size.x, winX11.size.y);
 
-		verticesPtr->drawSelfInternal(shader.getAttrIndices());
+		verticesPtr->drawSelfInternal(postShader.getAttrIndices());
 	}
+}
 
+void ATD::Window::WindowInternal::display(ATD::Window::WindowX11 &winX11)
+{
+	present(winX11);
 	X11::glXSwapBuffers(winX11.displayPtr, winX11.window);
 }
 
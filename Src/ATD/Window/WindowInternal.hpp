@@ -40,15 +40,28 @@ public:
 
 	/**
 	 * @brief ...
-	 * @param eventsX11    - ...
-	 * @param eventsResult - ...
-	 * @param winX11       - ... */
+	 * @param eventsX11        - ...
+	 * @param eventsResult     - ...
+	 * @param winX11           - ...
+	 * @param isResizeDeferred - FrameBuffer is replaced by applyResize() 
+	 * on the render thread */
 	void processX11Events(std::list<X11::XEvent> &eventsX11, 
 			std::list<Window::Event> &eventsResult, 
-			WindowX11 &winX11);
+			WindowX11 &winX11, 
+			bool isResizeDeferred = false);
 
 	/**
-	 * @brief ...
+	 * @brief Replace the FrameBuffer, if the window resize is pending.
+	 * @return true, if replaced */
+	bool applyResize();
+
+	/**
+	 * @brief Draw the FrameBuffer into the window, without swapping.
+	 * @param winX11 - ... */
+	void present(WindowX11 &winX11);
+
+	/**
+	 * @brief present() and swap buffers.
 	 * @param winX11 - ... */
 	void display(WindowX11 &winX11);
 
@@ -58,6 +71,17 @@ public:
 	 * @return ... */
 	Matrix3F coords2DTransformMatrix(const WindowX11 &winX11) const;
 
+	/**
+	 * @brief Place the upscaled FrameBuffer within the window, according 
+	 * to alignX and alignY.
+	 * @param winX11 - ... */
+	void updateTransform(const WindowX11 &winX11);
+
+	/**
+	 * @brief Whether display() may present with a single framebuffer blit.
+	 * @return false for custom post-shader or non-integer transform */
+	bool isBlitPresentable() const;
+
 
 	bool hasFocus;
 	bool isClosed;
@@ -69,6 +93,7 @@ public:
 	FrameBuffer::Ptr frameBufferPtr; /* Size == frameBuffer.Size() */
 	VertexBuffer2D::Ptr verticesPtr;
 	Shader2D shader;
+	Shader2D::Ptr postShaderPtr; /* If set, used instead of blit. */
 	Transform2D transform; /* Pixel-perfect upscale transform. */
 
 	/* FrameBuffer resize truly happens only after Display()! */
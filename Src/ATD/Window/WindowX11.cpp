@@ -8,6 +8,8 @@
 
 #include <ATD/Window/WindowX11.hpp>
 
+#include <string.h>
+
 #include <atomic>
 
 #define IGNORE_UNUSED(x) (void)(x)
@@ -22,6 +24,10 @@ static void _x11Init()
 	if (!_isX11Init.load()) {
 		/* Perform init */
 
+		/* Window may be polled and drawn (by the render thread) 
+		 * simultaneously, so Xlib shall lock the display. */
+		X11::XInitThreads();
+
 		/* Ignore all IO X-errors */
 		X11::XSetIOErrorHandler(
 				[](X11::Display *displayPtr) -> int {
@@ -68,6 +74,38 @@ static void _closeSharedDisplay()
 }
 
 
+/* ATD::Window::WindowX11 auxiliary: Swap control: */
+
+typedef void(_SwapIntervalExtFunc)(X11::Display *displayPtr, 
+		X11::GLXDrawable drawable, int interval);
+typedef int(_SwapIntervalMesaFunc)(unsigned interval);
+typedef int(_SwapIntervalSgiFunc)(int interval);
+
+/* Whether the space-separated extension list has the extension. */
+static bool _hasExtension(const char *extensions, const char *extension)
+{
+	if (!extensions) {
+		return false;
+	}
+
+	size_t length = ::strlen(extension);
+	for (const char *found = ::strstr(extensions, extension); found; 
+			found = ::strstr(found + length, extension)) {
+		if ((found == extensions || found[-1] == ' ') && 
+				(found[length] == ' ' || found[length] == '\0')) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static void *_glXFunction(const char *name)
+{
+	return reinterpret_cast<void *>(X11::glXGetProcAddress(
+				reinterpret_cast<const unsigned char *>(name)));
+}
+
+
 /* ATD::Window::WindowX11: */
 
 ATD::Window::WindowX11::WindowX11(const ATD::Vector2S &n_size, 
@@ -132,8 +170,15 @@ ATD::Window::WindowX11::WindowX11(const ATD::Vector2S &n_size,
 			visualInfoPtr, nullptr, GL_TRUE);
 	X11::glXMakeCurrent(displayPtr, window, glRenderCtx);
 
-	ATD::gl.viewport(0, 0, size.x, size.y);
-	ATD::gl.enable(ATD::Gl::TEXTURE_2D);
+	/* Context for the loader thread: textures and buffers, created there, 
+	 * are usable by glRenderCtx. Without it, Window::load() fails. */
+	glLoaderCtx = X11::glXCreateContext(displayPtr, 
+			visualInfoPtr, glRenderCtx, GL_TRUE);
+
+	/* Fresh context: the shadow state may be left from the previous one. */
+	ATD::gl.state.reset();
+	ATD::gl.state.viewport(0, 0, size.x, size.y);
+	ATD::gl.state.enable(ATD::Gl::TEXTURE_2D);
 
 	/* Window title. */
 	X11::XStoreName(displayPtr, window, title.c_str());
@@ -145,6 +190,14 @@ ATD::Window::WindowX11::WindowX11(const ATD::Vector2S &n_size,
 
 ATD::Window::WindowX11::~WindowX11()
 {
+	/* Scratch framebuffers are deleted, while the context is current. */
+	if (X11::glXGetCurrentContext() == glRenderCtx) {
+		ATD::gl.state.release();
+	}
+
+	if (glLoaderCtx) {
+		X11::glXDestroyContext(displayPtr, glLoaderCtx);
+	}
 	X11::glXDestroyContext(displayPtr, glRenderCtx);
 
 	X11::XDestroyWindow(displayPtr, window);
@@ -152,4 +205,51 @@ ATD::Window::WindowX11::~WindowX11()
 	_closeSharedDisplay();
 }
 
+bool ATD::Window::WindowX11::setSwapInterval(int interval)
+{
+	const char *extensions = 
+		X11::glXQueryExtensionsString(displayPtr, screenId);
+
+	/* Negative interval is adaptive vsync: late frames are not waited. */
+	if (interval < 0 && 
+			!_hasExtension(extensions, "GLX_EXT_swap_control_tear")) {
+		return false;
+	}
+
+	if (_hasExtension(extensions, "GLX_EXT_swap_control")) {
+		_SwapIntervalExtFunc *swapInterval = 
+			reinterpret_cast<_SwapIntervalExtFunc *>(
+					_glXFunction("glXSwapIntervalEXT"));
+		if (swapInterval) {
+			swapInterval(displayPtr, window, interval);
+			return true;
+		}
+	}
+
+	if (interval < 0) {
+		return false;
+	}
+
+	if (_hasExtension(extensions, "GLX_MESA_swap_control")) {
+		_SwapIntervalMesaFunc *swapInterval = 
+			reinterpret_cast<_SwapIntervalMesaFunc *>(
+					_glXFunction("glXSwapIntervalMESA"));
+		if (swapInterval) {
+			return swapInterval(static_cast<unsigned>(interval)) == 0;
+		}
+	}
+
+	/* SGI cannot turn vsync off. */
+	if (interval > 0 && _hasExtension(extensions, "GLX_SGI_swap_control")) {
+		_SwapIntervalSgiFunc *swapInterval = 
+			reinterpret_cast<_SwapIntervalSgiFunc *>(
+					_glXFunction("glXSwapIntervalSGI"));
+		if (swapInterval) {
+			return swapInterval(interval) == 0;
+		}
+	}
+
+	return false;
+}
+
 
@@ -45,6 +45,12 @@ public:
 	 * @brief ... */
 	~WindowX11();
 
+	/**
+	 * @brief Set swap interval via GLX_EXT_swap_control (or MESA, SGI).
+	 * @param interval - ...
+	 * @return false, if not supported */
+	bool setSwapInterval(int interval);
+
 
 	/* Cached size, position and title. */
 	Vector2S size;
@@ -56,6 +62,7 @@ public:
 	X11::XSetWindowAttributes windowAttributes = X11::XSetWindowAttributes();
 	X11::Window window = 0;
 	X11::GLXContext glRenderCtx = 0;
+	X11::GLXContext glLoaderCtx = 0; /* Shares objects with glRenderCtx. */
 	int screenId = 0;
 
 	/* FIXME: Shall I have input context? */
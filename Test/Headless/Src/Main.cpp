@@ -0,0 +1,49 @@
+
+
+#include <ATD/Core/ErrWriter.hpp>
+#include <ATD/Core/Fs.hpp>
+#include <ATD/Graphics/FrameBuffer.hpp>
+#include <ATD/Graphics/HeadlessContext.hpp>
+#include <ATD/Graphics/Image.hpp>
+#include <ATD/Graphics/Sprite.hpp>
+
+#include <stdio.h>
+
+
+/* Renders the test texture, rotated, into an image without X server. */
+int main(int argc, char **argv)
+{
+	ATD::ErrWriter dbgStderr; /* Enable debug output stderr. */
+	ATD::Fs fs(ATD::Fs::Path(argv[0], ATD::Fs::Path::NATIVE)); /* FS. */
+
+	if (argc < 2) {
+		::fprintf(stderr, "Usage: %s <output.png>\n", argv[0]);
+		return 1;
+	}
+
+	try {
+		ATD::HeadlessContext context;
+		::fprintf(stderr, "Renderer: %s\n", context.renderer());
+
+		ATD::FrameBuffer frameBuffer(ATD::Vector2S(256, 256));
+
+		ATD::Image img;
+		img.load(fs.binDir().joined(ATD::Fs::Path("TestTexture-0001.png")));
+
+		ATD::Sprite spr(ATD::Texture::CPtr(new ATD::Texture(img)));
+		spr.setOffset(ATD::Vector2D(128., 128.));
+		spr.setAngleFrc(0.125);
+
+		frameBuffer.clear();
+		frameBuffer.draw(spr);
+
+		frameBuffer.getColorTexture()->getImage()->save(
+				ATD::Fs::Path(argv[1], ATD::Fs::Path::NATIVE));
+	} catch (const std::exception &e_err) {
+		::fprintf(stderr, "%s\n", e_err.what());
+		return 1;
+	}
+	return 0;
+}
+
+
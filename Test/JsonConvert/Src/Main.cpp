@@ -0,0 +1,37 @@
+/**
+@file     
+@brief    Converts JSON-described assets between JSON, CBOR and MessagePack.
+@details  License: GPL v3.
+@author   ArthurTheDigital (arthurthedigital@gmail.com)
+@since    $Id: $
+*/
+
+#include <ATD/Core/Fs.hpp>
+#include <ATD/Core/JsonData.hpp>
+
+#include <stdio.h>
+
+#include <stdexcept>
+
+
+int main(int argc, char **argv)
+{
+	if (argc != 3) {
+		::fprintf(stderr, "Usage: %s <source> <destination>\n", argv[0]);
+		::fprintf(stderr, "Destination format is taken from its " 
+				"extension: .json, .cbor or .msgpack (JSON for others).\n");
+		return 1;
+	}
+
+	try {
+		ATD::JsonData::convert(ATD::Fs::Path(argv[1]), 
+				ATD::Fs::Path(argv[2]));
+	} catch (const std::exception &e) {
+		::fprintf(stderr, "Failed to convert: %s\n", e.what());
+		return 1;
+	}
+
+	return 0;
+}
+
+
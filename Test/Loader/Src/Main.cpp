@@ -0,0 +1,81 @@
+
+
+#include <ATD/Core/ErrWriter.hpp>
+#include <ATD/Core/FrameLoop.hpp>
+#include <ATD/Core/Fs.hpp>
+#include <ATD/Graphics/Texture.hpp>
+#include <ATD/Graphics/VertexBuffer2D.hpp>
+#include <ATD/Window/Window.hpp>
+
+#include <stdio.h>
+
+
+#define IGNORE_UNUSED(x) (void)(x)
+
+
+/* The texture is loaded and uploaded on the loader thread, while the frames 
+ * keep going. It is drawn, as soon as it is ready. */
+int main(int argc, char **argv)
+{
+	IGNORE_UNUSED(argc);
+
+	ATD::ErrWriter dbgStderr; /* Enable debug output stderr. */
+	ATD::Fs fs(ATD::Fs::Path(argv[0], ATD::Fs::Path::NATIVE)); /* FS. */
+
+	try {
+		ATD::Window win(ATD::Vector2S(600, 600), ATD::Vector2L(200, 200), 
+				"Test");
+
+		ATD::Fs::Path imgPath = fs.binDir().joined(
+				ATD::Fs::Path("TestTexture-0001.png"));
+
+		/* Decoding happens on the loader thread as well. */
+		ATD::Window::Loading<ATD::Texture> textureLoading = 
+			win.load<ATD::Texture>([imgPath]() {
+				ATD::Image img;
+				img.load(imgPath);
+				return ATD::Texture::Ptr(new ATD::Texture(img));
+			});
+
+		ATD::Texture::Ptr texturePtr;
+		ATD::VertexBuffer2D::Ptr verticesPtr;
+		size_t framesNum = 0;
+
+		win.setSwapInterval(1);
+		ATD::FrameLoop loop(60.);
+
+		loop.run(
+				[&](double step) -> bool {
+					IGNORE_UNUSED(step);
+					win.poll();
+
+					if (!texturePtr && textureLoading.isReady()) {
+						texturePtr = textureLoading.get();
+						verticesPtr.reset(new ATD::VertexBuffer2D(
+									ATD::RectL(texturePtr->size()), 
+									texturePtr->size()));
+
+						::fprintf(stderr, "texture ready after %lu frames\n", 
+								framesNum);
+					}
+
+					return !win.isClosed();
+				}, 
+				[&](double alpha) {
+					IGNORE_UNUSED(alpha);
+					win.clear();
+
+					if (texturePtr) {
+						ATD::Texture::Usage useTexture(*texturePtr);
+						win.draw(*verticesPtr, ATD::Transform2D());
+					}
+
+					win.display();
+					framesNum++;
+				});
+	} catch (const std::exception &e_err) {
+		::fprintf(stderr, "%s\n", e_err.what());
+	}
+}
+
+
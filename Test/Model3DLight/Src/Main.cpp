@@ -1,6 +1,5 @@
 
 #include "Camera.hpp"
-#include "Lighting.hpp"
 #include "Model.hpp"
 
 #include <ATD/Core/Debug.hpp>
@@ -8,6 +7,7 @@
 #include <ATD/Core/Fs.hpp>
 #include <ATD/Core/Vector2.hpp>
 #include <ATD/Core/Vector3.hpp>
+#include <ATD/Graphics/Lighting.hpp>
 #include <ATD/Graphics/Shader.hpp>
 #include <ATD/Window/Keyboard.hpp>
 #include <ATD/Window/Window.hpp>
@@ -22,6 +22,55 @@ const double ANGULAR_VELOCITY_FRC = 0.005;
 const double RADIAL_VELOCITY = 0.05;
 
 
+/* Lighting constants: */
+
+const float DFT_AMBIENT = 0.2f;
+const float DFT_DIFFUSE = 0.4f;
+const float DFT_SPECULAR = 0.4f;
+
+const ATD::Vector3F DFT_ATTENUATION = ATD::Vector3F(1.00f, 0.00f, 0.10f);
+
+const std::vector<ATD::Lighting::DirLight> DFT_DIR_LIGHTS = {
+	ATD::Lighting::DirLight(
+			ATD::Lighting::Light(ATD::Pixel(0xFF, 0xF8, 0xE0), 
+				DFT_AMBIENT, DFT_DIFFUSE, DFT_SPECULAR), 
+			ATD::Vector3F( 0.f, -1.f,  0.2f))
+};
+
+const std::vector<ATD::Lighting::PointLight> DFT_POINT_LIGHTS = {
+	ATD::Lighting::PointLight(
+			ATD::Lighting::Light(ATD::Pixel(0xFF, 0xFF, 0x80), 
+				DFT_AMBIENT, DFT_DIFFUSE, DFT_SPECULAR), 
+			ATD::Vector3F( 0.000f,  1.000f,  0.000f), 
+			DFT_ATTENUATION), 
+
+	ATD::Lighting::PointLight(
+			ATD::Lighting::Light(ATD::Pixel(0xFF, 0x80, 0xFF), 
+				DFT_AMBIENT, DFT_DIFFUSE, DFT_SPECULAR), 
+			ATD::Vector3F( 0.866f, -0.500f,  0.000f), 
+			DFT_ATTENUATION), 
+
+	ATD::Lighting::PointLight(
+			ATD::Lighting::Light(ATD::Pixel(0x80, 0xFF, 0xFF), 
+				DFT_AMBIENT, DFT_DIFFUSE, DFT_SPECULAR), 
+			ATD::Vector3F(-0.866f, -0.500f,  0.000f), 
+			DFT_ATTENUATION)
+};
+
+const std::vector<ATD::Lighting::SpotLight> DFT_SPOT_LIGHTS = {
+	ATD::Lighting::SpotLight(
+			ATD::Lighting::PointLight(
+				ATD::Lighting::Light(ATD::Pixel(0x80, 0xC0, 0xFF), 
+					DFT_AMBIENT, DFT_DIFFUSE, DFT_SPECULAR), 
+				ATD::Vector3F(0.000f, 0.000f, -10.000f), 
+				DFT_ATTENUATION), 
+			ATD::Vector3F(0.f, 0.f, 1.f), 
+			0.940f) /* Spot light cutoff - cos(angle). */
+};
+
+const float SPECULAR_POWER = 3.0f;
+
+
 /* === */
 
 int main(int argc, char **argv)
@@ -52,9 +101,13 @@ int main(int argc, char **argv)
 		Model model(textureImg);
 		Camera cam(ATD::Vector3D(0., 0., -5.));
 
-		Lighting light;
-		light.setCameraPosition(cam.getProjection().offset());
-		win.setShader3D(light.getShader());
+		bool dirLightsEnabled = true;
+		bool pointLightsEnabled = false;
+		bool spotLightsEnabled = false;
+
+		ATD::Lighting light;
+		light.setSpecularPower(SPECULAR_POWER);
+		light.setDirLights(DFT_DIR_LIGHTS);
 
 		IPRINTF("", "start");
 
@@ -93,7 +146,8 @@ int main(int argc, char **argv)
 				}
 
 				win.setProjection3D(cam.getProjection());
-				light.setCameraPosition(cam.getProjection().offset());
+				light.setCameraPosition(static_cast<ATD::Vector3F>(
+							cam.getProjection().offset()));
 			}
 
 			/* Model rotation: */
@@ -127,20 +181,37 @@ int main(int argc, char **argv)
 
 			{
 				if (kb[ATD::Key::N_1].isHeldStart()) {
-					light.onOffDirLights();
+					dirLightsEnabled = !dirLightsEnabled;
+					light.setDirLights(dirLightsEnabled ? 
+							DFT_DIR_LIGHTS : 
+							std::vector<ATD::Lighting::DirLight>());
 				}
 				if (kb[ATD::Key::N_2].isHeldStart()) {
-					light.onOffPointLights();
+					pointLightsEnabled = !pointLightsEnabled;
+					light.setPointLights(pointLightsEnabled ? 
+							DFT_POINT_LIGHTS : 
+							std::vector<ATD::Lighting::PointLight>());
 				}
 				if (kb[ATD::Key::N_3].isHeldStart()) {
-					light.onOffSpotLights();
+					spotLightsEnabled = !spotLightsEnabled;
+					light.setSpotLights(spotLightsEnabled ? 
+							DFT_SPOT_LIGHTS : 
+							std::vector<ATD::Lighting::SpotLight>());
 				}
+
+				/* One upload for all the lights, and the smallest shader 
+				 * for the enabled ones. */
+				light.update();
+				win.setShader3D(light.shader());
 			}
 
 			/* Rendering: */
 
 			win.clear();
-			win.draw(model);
+			{
+				ATD::Lighting::Usage useLight(light);
+				win.draw(model);
+			}
 			win.display();
 
 			/* Screenshot: */
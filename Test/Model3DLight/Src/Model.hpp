@@ -267,7 +267,7 @@ Model::Model(const ATD::Image &texture)
 	/* Enable triangle culling: */
 	ATD::gl.frontFace(ATD::Gl::CW);
 	ATD::gl.cullFace(ATD::Gl::BACK);
-	ATD::gl.enable(ATD::Gl::CULL_FACE);
+	ATD::gl.state.enable(ATD::Gl::CULL_FACE);
 
 	/* IPRINTF("", "sizeof(ATD::Vertex3D::GlVertex) == %lu", 
 			sizeof(ATD::Vertex3D::GlVertex)); // DEBUG */
@@ -0,0 +1,112 @@
+
+
+#include <ATD/Core/ErrWriter.hpp>
+#include <ATD/Core/FrameLoop.hpp>
+#include <ATD/Core/Fs.hpp>
+#include <ATD/Graphics/Texture.hpp>
+#include <ATD/Graphics/VertexBuffer2D.hpp>
+#include <ATD/Window/Window.hpp>
+
+#include <math.h>
+#include <stdio.h>
+
+#include <vector>
+
+
+#define IGNORE_UNUSED(x) (void)(x)
+
+
+const size_t SPRITES_NUM = 256;
+const double ROTATE_STEP_FRC = 0.002;
+
+
+/* Many rotating sprites, simulated while the previous frame is rendered by 
+ * the window render thread. */
+int main(int argc, char **argv)
+{
+	IGNORE_UNUSED(argc);
+
+	ATD::ErrWriter dbgStderr; /* Enable debug output stderr. */
+	ATD::Fs fs(ATD::Fs::Path(argv[0], ATD::Fs::Path::NATIVE)); /* FS. */
+
+	try {
+		ATD::Window win(ATD::Vector2S(600, 600), ATD::Vector2L(200, 200), 
+				"Test");
+		win.startRenderThread();
+
+		ATD::Image img;
+		img.load(fs.binDir().joined(ATD::Fs::Path("TestTexture-0001.png")));
+
+		/* GL resources are created with the context, on the render 
+		 * thread. */
+		ATD::Texture::CPtr texturePtr;
+		ATD::VertexBuffer2D::CPtr verticesPtr;
+		win.invoke([&]() {
+			texturePtr.reset(new ATD::Texture(img));
+			verticesPtr.reset(new ATD::VertexBuffer2D(
+						ATD::RectL(img.size()), img.size()));
+		});
+
+		/* Simulation state, owned by the game thread. */
+		std::vector<ATD::Transform2D> transforms(SPRITES_NUM);
+		for (size_t sIndex = 0; sIndex < SPRITES_NUM; sIndex++) {
+			double angleFrc = static_cast<double>(sIndex) / SPRITES_NUM;
+			transforms[sIndex].setScale(ATD::Vector2D(0.25, 0.25));
+			transforms[sIndex].setOffset(ATD::Vector2D(
+						300. + 200. * ::cos(angleFrc * M_PI * 2.), 
+						300. + 200. * ::sin(angleFrc * M_PI * 2.)));
+		}
+
+		win.setSwapInterval(1);
+		ATD::FrameLoop loop(60.);
+
+		loop.run(
+				[&](double step) -> bool {
+					IGNORE_UNUSED(step);
+					win.poll();
+
+					for (auto &transform : transforms) {
+						transform.setAngleFrc(
+								transform.angleFrc() + ROTATE_STEP_FRC);
+					}
+
+					return !win.isClosed();
+				}, 
+				[&](double alpha) {
+					IGNORE_UNUSED(alpha);
+					win.clear();
+
+					/* The transforms are copied, so that the next update 
+					 * does not race with the rendering. */
+					win.draw([texturePtr, verticesPtr, transforms](
+								ATD::FrameBuffer &target) {
+						ATD::Texture::Usage useTexture(*texturePtr);
+						for (auto &transform : transforms) {
+							target.draw(*verticesPtr, transform);
+						}
+					});
+
+					win.display();
+
+					ATD::FrameLoop::Stats stats = loop.stats();
+					if (stats.framesNum % 
+							ATD::FrameLoop::STATS_FRAMES_NUM == 0 && 
+							stats.framesNum > 0) {
+						::fprintf(stderr, 
+								"frame time, ms: avg %.2f, p99 %.2f\n", 
+								stats.avgFrameTime * 1000., 
+								stats.p99FrameTime * 1000.);
+					}
+				});
+
+		/* Release the resources with the context. */
+		win.invoke([&]() {
+			texturePtr.reset();
+			verticesPtr.reset();
+		});
+	} catch (const std::exception &e_err) {
+		::fprintf(stderr, "%s\n", e_err.what());
+	}
+}
+
+
@@ -0,0 +1,76 @@
+
+
+#include <ATD/Core/ErrWriter.hpp>
+#include <ATD/Core/Fs.hpp>
+#include <ATD/Graphics/Image.hpp>
+#include <ATD/Graphics/SoftFrameBuffer.hpp>
+
+#include <stdio.h>
+
+#include <chrono>
+
+
+/* Textured quad in 3D with a 2D overlay on top, rendered on CPU only. */
+int main(int argc, char **argv)
+{
+	ATD::ErrWriter dbgStderr; /* Enable debug output stderr. */
+	ATD::Fs fs(ATD::Fs::Path(argv[0], ATD::Fs::Path::NATIVE)); /* FS. */
+
+	if (argc < 2) {
+		::fprintf(stderr, "Usage: %s <output.png>\n", argv[0]);
+		return 1;
+	}
+
+	try {
+		ATD::Image::Ptr imgPtr(new ATD::Image());
+		imgPtr->load(fs.binDir().joined(
+					ATD::Fs::Path("TestTexture-0001.png")));
+
+		ATD::SoftFrameBuffer frameBuffer(ATD::Vector2S(640, 480));
+
+		/* Quad, tiled 4x4 with the texture. */
+		std::vector<ATD::Vertex3D::GlVertex> quad;
+		const float corners[][2] = {
+			{-1.f, -1.f}, {1.f, -1.f}, {1.f, 1.f}, 
+			{-1.f, -1.f}, {1.f, 1.f}, {-1.f, 1.f}
+		};
+		for (auto &corner : corners) {
+			quad.push_back(ATD::Vertex3D::GlVertex(
+						ATD::Vector3F(corner[0], corner[1], 0.f), 
+						ATD::Vector2F((corner[0] + 1.f) * 2.f, 
+							(corner[1] + 1.f) * 2.f), 
+						ATD::Vector3F(0.f, 0.f, 1.f), 
+						ATD::Vector4F(1.f, 1.f, 1.f, 1.f)));
+		}
+
+		ATD::Transform3D quadTransform(ATD::Vector3D(3., 3., 3.), 
+				ATD::Quaternion::rotation(0.2, ATD::Vector3D(1., 0.3, 0.)), 
+				ATD::Vector3D(0., 0., 4.));
+
+		ATD::VertexBuffer2D::Builder overlay(imgPtr->size());
+		overlay.addRect(ATD::Vector2F(8.f, 8.f), 
+				ATD::RectL(0, 0, static_cast<long>(imgPtr->size().x), 
+					static_cast<long>(imgPtr->size().y)), 
+				ATD::Pixel(0xFF, 0xFF, 0xFF, 0x80));
+
+		auto start = std::chrono::steady_clock::now();
+
+		frameBuffer.clear(ATD::Pixel(0x20, 0x20, 0x40));
+		frameBuffer.draw(quad, imgPtr, quadTransform);
+		frameBuffer.setBlend(ATD::SoftFrameBuffer::ALPHA);
+		frameBuffer.draw(overlay, imgPtr);
+		const ATD::Image &result = frameBuffer.image();
+
+		::fprintf(stderr, "Rendered in %.3f ms\n", 
+				std::chrono::duration<double, std::milli>(
+					std::chrono::steady_clock::now() - start).count());
+
+		result.save(ATD::Fs::Path(argv[1], ATD::Fs::Path::NATIVE));
+	} catch (const std::exception &e_err) {
+		::fprintf(stderr, "%s\n", e_err.what());
+		return 1;
+	}
+	return 0;
+}
+
+
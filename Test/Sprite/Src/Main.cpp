@@ -2,14 +2,17 @@
 
 #include <ATD/Core/Debug.hpp>
 #include <ATD/Core/ErrWriter.hpp>
+#include <ATD/Core/FrameLoop.hpp>
 #include <ATD/Core/Fs.hpp>
 #include <ATD/Graphics/Gl.hpp>
 #include <ATD/Graphics/Sprite.hpp>
 #include <ATD/Window/Keyboard.hpp>
 #include <ATD/Window/Window.hpp>
 
-#include <chrono>
-#include <thread>
+#include <stdio.h>
+
+
+#define IGNORE_UNUSED(x) (void)(x)
 
 
 const double SHIFT_STEP = 1.;
@@ -32,60 +35,66 @@ int main(int argc, char **argv)
 
 		ATD::Sprite spr(ATD::Texture::CPtr(new ATD::Texture(img)));
 
-		while (1) {
-			std::chrono::time_point<std::chrono::steady_clock> timeStart = 
-				std::chrono::steady_clock::now();
-			win.poll();
-
-			{ /* Update the model. */
-				ATD::Vector2D deltaOffset;
-				if (kb[ATD::Key::UP].isPressed()) {
-					deltaOffset += ATD::Vector2D(0., -SHIFT_STEP);
-				}
-				if (kb[ATD::Key::DOWN].isPressed()) {
-					deltaOffset += ATD::Vector2D(0., SHIFT_STEP);
-				}
-				if (kb[ATD::Key::LEFT].isPressed()) {
-					deltaOffset += ATD::Vector2D(-SHIFT_STEP, 0.);
-				}
-				if (kb[ATD::Key::RIGHT].isPressed()) {
-					deltaOffset += ATD::Vector2D(SHIFT_STEP, 0.);
-				}
-
-				double deltaAngleFrc = 0.;
-				if (kb[ATD::Key::Q].isPressed()) {
-					deltaAngleFrc += ROTATE_STEP_FRC;
-				}
-				if (kb[ATD::Key::W].isPressed()) {
-					deltaAngleFrc -= ROTATE_STEP_FRC;
-				}
-
-				const ATD::Transform2D transform = spr.transform();
-				spr.setOffset(transform.offset() + deltaOffset);
-				spr.setAngleFrc(transform.angleFrc() + deltaAngleFrc);
-			}
-
-			win.clear();
-
-			win.draw(spr);
-
-			win.display();
-
-			std::chrono::time_point<std::chrono::steady_clock> timeEnd = 
-				std::chrono::steady_clock::now();
-
-			std::chrono::milliseconds frameDuration(
-					std::chrono::duration_cast<std::chrono::milliseconds>(
-						timeEnd.time_since_epoch()).count() - 
-					std::chrono::duration_cast<std::chrono::milliseconds>(
-						timeStart.time_since_epoch()).count()
-					);
-			const std::chrono::milliseconds frameDurationNorm(1000/60);
-			if (frameDuration < frameDurationNorm) {
-				std::this_thread::sleep_for(frameDurationNorm - 
-						frameDuration);
-			}
-		}
+		/* Vsync paces the frames, the model is updated at 60 Hz. */
+		win.setSwapInterval(1);
+		ATD::FrameLoop loop(60.);
+
+		loop.run(
+				[&](double step) -> bool {
+					IGNORE_UNUSED(step);
+					win.poll();
+
+					ATD::Vector2D deltaOffset;
+					if (kb[ATD::Key::UP].isPressed()) {
+						deltaOffset += ATD::Vector2D(0., -SHIFT_STEP);
+					}
+					if (kb[ATD::Key::DOWN].isPressed()) {
+						deltaOffset += ATD::Vector2D(0., SHIFT_STEP);
+					}
+					if (kb[ATD::Key::LEFT].isPressed()) {
+						deltaOffset += ATD::Vector2D(-SHIFT_STEP, 0.);
+					}
+					if (kb[ATD::Key::RIGHT].isPressed()) {
+						deltaOffset += ATD::Vector2D(SHIFT_STEP, 0.);
+					}
+
+					double deltaAngleFrc = 0.;
+					if (kb[ATD::Key::Q].isPressed()) {
+						deltaAngleFrc += ROTATE_STEP_FRC;
+					}
+					if (kb[ATD::Key::W].isPressed()) {
+						deltaAngleFrc -= ROTATE_STEP_FRC;
+					}
+
+					const ATD::Transform2D transform = spr.transform();
+					spr.setOffset(transform.offset() + deltaOffset);
+					spr.setAngleFrc(transform.angleFrc() + deltaAngleFrc);
+
+					return !win.isClosed();
+				}, 
+				[&](double alpha) {
+					IGNORE_UNUSED(alpha);
+					win.clear();
+
+					win.draw(spr);
+
+					win.display();
+
+					/* Report frame timing once in a while. */
+					ATD::FrameLoop::Stats stats = loop.stats();
+					if (stats.framesNum % 
+							ATD::FrameLoop::STATS_FRAMES_NUM == 0 && 
+							stats.framesNum > 0) {
+						::fprintf(stderr, 
+								"frame time, ms: min %.2f, avg %.2f, "
+								"p99 %.2f; missed %lu, dropped %lu\n", 
+								stats.minFrameTime * 1000., 
+								stats.avgFrameTime * 1000., 
+								stats.p99FrameTime * 1000., 
+								stats.missedDeadlinesNum, 
+								stats.droppedUpdatesNum);
+					}
+				});
 	} catch (const std::exception &e_err) {
 		::fprintf(stderr, "%s\n", e_err.what());
 	}